@@ -21,7 +21,8 @@ import { useState } from "react";
 import { ProgramSnippet, ProgramSnippets } from "../../../models/ProgramSnippets";
 import { SoCDP8 } from "../../../models/SoCDP8";
 import { DeviceID } from "../../../types/PeripheralTypes";
-import { downloadData, loadFile } from "../../../util";
+import { lampWord, parsePanelScript } from "../../../types/PanelMacro";
+import { downloadData, loadFile, numToOctal } from "../../../util";
 import { FrontPanel } from "./FrontPanel";
 
 export function FrontPanelBox(props: { pdp8: SoCDP8 }) {
@@ -38,9 +39,7 @@ export function FrontPanelBox(props: { pdp8: SoCDP8 }) {
     }
 
     async function loadSnippet(snippet: ProgramSnippet) {
-        for (const s of snippet.snippets) {
-            await props.pdp8.writeCore(s.start, s.data);
-        }
+        await props.pdp8.writeCore(snippet.snippets.map(s => ({ address: s.start, data: Uint16Array.from(s.data) })));
         setShowSnippets(false);
     }
 
@@ -58,6 +57,42 @@ export function FrontPanelBox(props: { pdp8: SoCDP8 }) {
         await props.pdp8.loadCoreDump(data);
     }
 
+    // Loads RIM and BIN tapes without going through the loader and the reader
+    async function loadTape(file: File) {
+        setBusy(true);
+        try {
+            const data = await loadFile(file);
+            const format = file.name.toLowerCase().endsWith(".rim") ? "rim" : "bin";
+            const res = await props.pdp8.loadTape({ format, data });
+            const start = `${res.startField.toString()}${numToOctal(res.startAddress, 4)}`;
+            if (res.checksum && res.checksum.expected != res.checksum.computed) {
+                alert(`Checksum error: Expected ${numToOctal(res.checksum.expected, 4)}, got ${numToOctal(res.checksum.computed, 4)}. Loaded ${res.wordCount.toString()} words, PC set to ${start}.`);
+            } else {
+                alert(`Loaded ${res.wordCount.toString()} words, PC set to ${start}.`);
+            }
+        } catch (e) {
+            alert(`Couldn't load tape: ${String(e)}`);
+        } finally {
+            setBusy(false);
+        }
+    }
+
+    // Runs a text file with switch settings and key presses, see parsePanelScript
+    async function runPanelScript(file: File) {
+        setBusy(true);
+        try {
+            const steps = parsePanelScript(await file.text());
+            const res = await props.pdp8.runPanelMacro(steps);
+            const pc = numToOctal(lampWord(res.lamps.pc), 4);
+            const ac = numToOctal(lampWord(res.lamps.ac), 4);
+            alert(`Pressed ${res.keyCount.toString()} keys, PC ${pc}, AC ${ac}.`);
+        } catch (e) {
+            alert(`Couldn't run panel script: ${String(e)}`);
+        } finally {
+            setBusy(false);
+        }
+    }
+
     async function downloadCore() {
         const dump = await props.pdp8.getCoreDump();
         await downloadData(dump, "core.dat");
@@ -79,6 +114,12 @@ export function FrontPanelBox(props: { pdp8: SoCDP8 }) {
                     <FileButton onChange={file => file ? void uploadCore(file) : undefined}>
                         { props => <Button size="compact-md" {...props}>Upload Dump</Button> }
                     </FileButton>
+                    <FileButton onChange={file => file ? void loadTape(file) : undefined}>
+                        { props => <Button size="compact-md" disabled={busy} {...props}>Load Tape</Button> }
+                    </FileButton>
+                    <FileButton onChange={file => file ? void runPanelScript(file) : undefined}>
+                        { props => <Button size="compact-md" disabled={busy} {...props}>Panel Script</Button> }
+                    </FileButton>
                     <Button size="compact-md" onClick={() => void downloadCore()}>
                         Download Dump
                     </Button>
@@ -0,0 +1,69 @@
+/*
+ *   SoCDP8 - A PDP-8/I implementation on a SoC
+ *   Copyright (C) 2019 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+import { Box, Button, Group, Table, Text } from "@mantine/core";
+import { LP08Model } from "../../../models/peripherals/LP08Model";
+import { PrinterJob } from "../../../types/PeripheralAction";
+import { downloadData } from "../../../util";
+
+export function LP08(props: { model: LP08Model }) {
+    const jobs = props.model.useState(state => state.jobs);
+
+    async function download(job: PrinterJob) {
+        const data = await props.model.downloadJob(job);
+        await downloadData(data, `lp08-job${job.id}.txt`);
+    }
+
+    return (
+        <Box>
+            { jobs.length == 0 &&
+                <Text>No print jobs</Text>
+            }
+            { jobs.length > 0 &&
+                <Table>
+                    <Table.Thead>
+                        <Table.Tr>
+                            <Table.Th>Job</Table.Th>
+                            <Table.Th>Pages</Table.Th>
+                            <Table.Th>Lines</Table.Th>
+                            <Table.Th>Size</Table.Th>
+                            <Table.Th></Table.Th>
+                        </Table.Tr>
+                    </Table.Thead>
+                    <Table.Tbody>
+                        { jobs.map(job =>
+                            <Table.Tr key={job.id}>
+                                <Table.Td>{job.id}</Table.Td>
+                                <Table.Td>{job.pages}</Table.Td>
+                                <Table.Td>{job.lines}</Table.Td>
+                                <Table.Td>{job.size}</Table.Td>
+                                <Table.Td>
+                                    <Button size="xs" disabled={!job.done} onClick={() => void download(job)}>
+                                        Download
+                                    </Button>
+                                </Table.Td>
+                            </Table.Tr>
+                        )}
+                    </Table.Tbody>
+                </Table>
+            }
+            <Group mt="xs">
+                <Button onClick={() => void props.model.clearJobs()}>Clear Finished Jobs</Button>
+            </Group>
+        </Box>
+    );
+}
@@ -21,6 +21,7 @@ import { IconMaximize } from "@tabler/icons-react";
 import { Link as RouterLink } from "react-router";
 import { DF32Model } from "../../../models/peripherals/DF32Model";
 import { KW8IModel } from "../../../models/peripherals/KW8IModel";
+import { LP08Model } from "../../../models/peripherals/LP08Model";
 import { PC04Model } from "../../../models/peripherals/PC04Model";
 import { PeripheralModel } from "../../../models/peripherals/PeripheralModel";
 import { PT08Model } from "../../../models/peripherals/PT08Model";
@@ -30,6 +31,7 @@ import { RK8EModel } from "../../../models/peripherals/RK8EModel";
 import { TC08Model } from "../../../models/peripherals/TC08Model";
 import { DF32 } from "./DF32";
 import { KW8I } from "./KW8I";
+import { LP08 } from "./LP08";
 import { PC04 } from "./PC04";
 import { PT08 } from "./PT08";
 import { RF08 } from "./RF08";
@@ -75,6 +77,10 @@ export function PeripheralBox(props: { model: PeripheralModel }) {
             caption = "KW8I Real Time Clock";
             component = <KW8I model={model} />;
             break;
+        case model instanceof LP08Model:
+            caption = "LP08 Line Printer";
+            component = <LP08 model={model} />;
+            break;
     }
 
     const titleStr = `${caption} @ Bus ${model.connections.map(x => x.toString(8)).join(", ")}`;
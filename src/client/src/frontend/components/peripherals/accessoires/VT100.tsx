@@ -59,12 +59,13 @@ export function VT100(props: { model: PT08Model }) {
     }, [termRef, style, props.model]);
 
     useEffect(() => model.useState.subscribe((state, prevState) => {
-        if (term && state.outBuf.length != prevState.outBuf.length) {
-            const byte = state.outBuf[state.outBuf.length - 1] & 0x7F;
-            if (byte == 0x07 && style == PT08Style.ASR33) {
+        if (term && state.outBuf.length > prevState.outBuf.length) {
+            // output arrives in batches
+            const bytes = state.outBuf.slice(prevState.outBuf.length).map(c => c & 0x7F);
+            if (bytes.includes(0x07) && style == PT08Style.ASR33) {
                 playBell();
             }
-            term.write(String.fromCharCode(byte));
+            term.write(String.fromCharCode(...bytes));
         }
     }), [model, term]);
 
@@ -58,6 +58,7 @@ export function SystemForm(props: SystemFormProps) {
 
                 <Fieldset legend="Unofficial CPU Changes">
                     <Switch name="bsw" label="BSW instruction for 8/E programs" defaultChecked={s.cpuExtensions.bsw} />
+                    <Switch name="fastEae" label="Fast MUY and DVI (FPGA only)" defaultChecked={s.cpuExtensions.fastEae} />
                 </Fieldset>
 
                 <Fieldset legend="Core Memory (kiW)">
@@ -111,6 +112,10 @@ export function SystemForm(props: SystemFormProps) {
                     <Switch name="kw8i" label="KW8/I" defaultChecked={peripherals.includes(DeviceID.DEV_ID_KW8I)} />
                 </Fieldset>
 
+                <Fieldset legend="Printer">
+                    <Switch name="lp08" label="LP08 Line Printer (FPGA only)" defaultChecked={peripherals.includes(DeviceID.DEV_ID_LP08)} />
+                </Fieldset>
+
                 <Button m={2} type="submit" disabled={!props.buttonEnabled}>
                     Create System
                 </Button>
@@ -129,6 +134,7 @@ function toSystemConf(ev: FormEvent<HTMLFormElement>): SystemConfiguration {
     s.cpuExtensions.eae = (form.elements.namedItem("eae") as HTMLInputElement).checked;
     s.cpuExtensions.kt8i = (form.elements.namedItem("kt8i") as HTMLInputElement).checked;
     s.cpuExtensions.bsw = (form.elements.namedItem("bsw") as HTMLInputElement).checked;
+    s.cpuExtensions.fastEae = (form.elements.namedItem("fastEae") as HTMLInputElement).checked;
     s.maxMemField = Number.parseInt((form.elements.namedItem("maxMemField") as HTMLInputElement).value);
 
     if ((form.elements.namedItem("serialLine") as HTMLInputElement).checked) {
@@ -149,6 +155,10 @@ function toSystemConf(ev: FormEvent<HTMLFormElement>): SystemConfiguration {
         s.peripherals.push({ id: DeviceID.DEV_ID_KW8I, use50Hz: false, useExternalClock: true });
     }
 
+    if ((form.elements.namedItem("lp08") as HTMLInputElement).checked) {
+        s.peripherals.push({ id: DeviceID.DEV_ID_LP08 });
+    }
+
     if ((form.elements.namedItem("tc08") as HTMLInputElement).checked) {
         s.peripherals.push({ id: DeviceID.DEV_ID_TC08, numTapes: 2 });
     }
@@ -20,44 +20,44 @@ import { indentLess, indentMore } from "@codemirror/commands";
 import { indentUnit } from "@codemirror/language";
 import { vscodeDarkInit } from "@uiw/codemirror-theme-vscode";
 import CodeMirror, { ReactCodeMirrorRef, StateCommand, keymap } from "@uiw/react-codemirror";
-import React, { ForwardedRef, forwardRef, useCallback, useRef, useState } from "react";
-import { BinTapeReader, CodeError, SymbolData, SymbolType, Yamas, YamasOutput } from "yamas";
+import React, { ForwardedRef, forwardRef, useCallback, useEffect, useRef, useState } from "react";
+import { SymbolType } from "yamas";
 import { yamasLanguage } from "../../editor/YamasLanguage";
+import { Assembler, AssemblyError, AssemblyResult, AssemblySymbol } from "../../models/Assembler";
 import { SoCDP8 } from "../../models/SoCDP8";
+import { toSegments } from "../../types/CoreSegments";
 import { downloadData, numToOctal } from "../../util";
 import { Button, Group, Table, Title } from "@mantine/core";
 
 export function CodePage(props: { pdp8: SoCDP8 }) {
-    const [output, setOutput] = useState<YamasOutput>();
-    const [memState, setMemState] = useState<(number | undefined)[]>([]);
+    const [output, setOutput] = useState<AssemblyResult>();
+    const [assembler, setAssembler] = useState<Assembler>();
     const editorRef = useRef<ReactCodeMirrorRef>(null);
+    const memState = output?.memory ?? [];
+
+    useEffect(() => {
+        const asm = new Assembler(setOutput);
+        setAssembler(asm);
+        return () => asm.terminate();
+    }, []);
 
     const assemble = useCallback(() => {
         const src = editorRef.current?.view?.state.doc.toString();
         if (!src) {
             return;
         }
+        assembler?.assemble(src);
+    }, [editorRef, assembler]);
 
-        const asm = new Yamas({ loadPrelude: true });
-        console.time("parse");
-        const ast = asm.addInput("input.pa", src);
-        console.timeEnd("parse");
-        console.time("assemble");
-        const out = asm.run();
-        console.timeEnd("assemble");
-        setOutput(out);
-
-        const mem = new BinTapeReader(out.binary).read();
-        setMemState(mem);
-    }, [editorRef]);
-
-    async function load() {
-        for (const [addr, val] of memState.entries()) {
-            if (val === undefined) {
-                continue;
-            }
-            await props.pdp8.writeCore(addr, [val]);
+    // Only the words that changed since the last load are sent
+    async function load(all: boolean) {
+        if (!assembler) {
+            return;
+        }
+        if (all) {
+            assembler.resetLoaded();
         }
+        await props.pdp8.writeCore(toSegments(assembler.takeChangedWords()));
     }
 
     async function downloadAntares() {
@@ -70,18 +70,24 @@ export function CodePage(props: { pdp8: SoCDP8 }) {
 
     return (<>
         <Title order={4}>Code Editor</Title>
-        <Editor ref={editorRef} />
+        <Editor ref={editorRef} onChange={src => assembler?.update(src)} />
         <Button.Group>
             <Button onClick={() => assemble()}>Assemble</Button>
             <Button
-                onClick={() => void load()}
-                disabled={!output || output.binary.length == 0}
+                onClick={() => void load(false)}
+                disabled={!output?.hasBinary}
+            >
+                Load Changes into Machine
+            </Button>
+            <Button
+                onClick={() => void load(true)}
+                disabled={!output?.hasBinary}
             >
-                Load into Machine
+                Load All
             </Button>
             <Button
                 onClick={() => void downloadAntares()}
-                disabled={!output || output.binary.length == 0}
+                disabled={!output?.hasBinary}
             >
                 Download Antares Dump
             </Button>
@@ -94,7 +100,7 @@ export function CodePage(props: { pdp8: SoCDP8 }) {
             { memState.length > 0 && false &&
                 <MemTable state={memState} />
             }
-            { output.symbols.size > 0 &&
+            { output.symbols.length > 0 &&
                 <SymbolTable symbols={output.symbols} />
             }
         </>}
@@ -124,11 +130,12 @@ $
 
 const theme = vscodeDarkInit();
 
-const Editor = forwardRef((props: unknown, ref: ForwardedRef<ReactCodeMirrorRef>) => {
+const Editor = forwardRef((props: { onChange: (src: string) => void }, ref: ForwardedRef<ReactCodeMirrorRef>) => {
     return (<>
         <CodeMirror
             ref={ref}
             value={initialSource}
+            onChange={props.onChange}
             height="75vh"
             indentWithTab={false}
             theme={ theme }
@@ -163,7 +170,7 @@ const indentOrInsertTab: StateCommand = ({ state, dispatch }) => {
     return true;
 };
 
-function ErrorTable(props: { errors: readonly CodeError[] }) {
+function ErrorTable(props: { errors: readonly AssemblyError[] }) {
     const errs = props.errors;
 
     return (<>
@@ -212,11 +219,8 @@ function MemTable(props: { state: (number | undefined)[] }) {
     </>);
 }
 
-function SymbolTable(props: { symbols: ReadonlyMap<string, SymbolData> }) {
-    const symbols = [...props.symbols.values()]
-        .filter(s => (s.type == SymbolType.Param && !s.fixed) ||
-                     (s.type == SymbolType.Label))
-        .sort((a, b) => a.name.localeCompare(b.name));
+function SymbolTable(props: { symbols: readonly AssemblySymbol[] }) {
+    const symbols = props.symbols;
 
     return (<>
         <Table>
@@ -89,6 +89,12 @@ function SystemEntry(props: { pdp8: SoCDP8, system: SystemConfiguration, active:
         setBusy(false);
     }
 
+    async function copy() {
+        setBusy(true);
+        await copySystem(props.pdp8, props.system);
+        setBusy(false);
+    }
+
     async function del() {
         setBusy(true);
         await deleteSystem(props.pdp8, props.system);
@@ -111,6 +117,7 @@ function SystemEntry(props: { pdp8: SoCDP8, system: SystemConfiguration, active:
                     { props.system.cpuExtensions.eae && <List.Item>KE8/I</List.Item> }
                     { props.system.cpuExtensions.kt8i && <List.Item>KT8/I</List.Item> }
                     { props.system.cpuExtensions.bsw && <List.Item>BSW</List.Item> }
+                    { props.system.cpuExtensions.fastEae && <List.Item>Fast EAE</List.Item> }
                 </List>
             </Table.Td>
             <Table.Td>
@@ -125,6 +132,11 @@ function SystemEntry(props: { pdp8: SoCDP8, system: SystemConfiguration, active:
                     <Button disabled={busy} onClick={() => void activate()}>
                         Activate
                     </Button>
+                    { props.pdp8.canCopySystems() &&
+                        <Button disabled={busy} onClick={() => void copy()}>
+                            Copy
+                        </Button>
+                    }
                     <Button disabled={busy} onClick={() => void del()}>
                         Delete
                     </Button>
@@ -149,6 +161,7 @@ function getPeripheralName(id: DeviceID): string {
         case DeviceID.DEV_ID_KW8I:  return "KW8I";
         case DeviceID.DEV_ID_RK08:  return "RK08";
         case DeviceID.DEV_ID_RK8E:  return "RK8E";
+        case DeviceID.DEV_ID_LP08:  return "LP08";
         default: return "Unknown";
     }
 }
@@ -177,6 +190,23 @@ async function activateSystem(pdp8: SoCDP8, state: SystemConfiguration) {
     }
 }
 
+async function copySystem(pdp8: SoCDP8, state: SystemConfiguration) {
+    const name = window.prompt("Name of the copy", `${state.name} Copy`);
+    if (!name) {
+        return;
+    }
+
+    try {
+        await pdp8.copySystem(state.id, name);
+    } catch(e) {
+        if (e instanceof Error) {
+            alert(`Copying system failed: ${e.message}`);
+        } else {
+            alert("Copying system failed");
+        }
+    }
+}
+
 async function deleteSystem(pdp8: SoCDP8, state: SystemConfiguration) {
     if (!window.confirm(`Delete system '${state.name}'?`)) {
         return;
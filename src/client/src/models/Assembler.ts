@@ -0,0 +1,133 @@
+/*
+ *   SoCDP8 - A PDP-8/I implementation on a SoC
+ *   Copyright (C) 2021 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+import { SymbolType } from "yamas";
+
+export interface AssemblyError {
+    line: number;
+    col: number;
+    message: string;
+}
+
+export interface AssemblySymbol {
+    name: string;
+    type: SymbolType;
+    value: number;
+}
+
+export interface AssemblyRequest {
+    seq: number;
+    src: string;
+}
+
+export interface AssemblyReply {
+    seq: number;
+    errors: AssemblyError[];
+
+    // user defined labels and parameters, sorted by name
+    symbols: AssemblySymbol[];
+
+    // words that changed since the previous reply, -1 for words that are no longer assembled
+    changedAddrs: Uint32Array;
+    changedValues: Int32Array;
+
+    hasBinary: boolean;
+}
+
+export interface AssemblyResult {
+    errors: AssemblyError[];
+    symbols: AssemblySymbol[];
+    hasBinary: boolean;
+
+    // sparse memory image
+    memory: (number | undefined)[];
+}
+
+/**
+ * Runs the assembler in a worker so that it can run while the user types without blocking the page.
+ * The worker only sends the words that changed, the complete image is kept here and the words
+ * that were loaded into the machine are tracked so that loading again only sends the differences.
+ */
+export class Assembler {
+    private readonly DEBOUNCE_MS = 300;
+    private worker: Worker;
+    private seq = 0;
+    private timer?: ReturnType<typeof setTimeout>;
+    private memory: (number | undefined)[] = [];
+    private loaded: (number | undefined)[] = [];
+
+    public constructor(private onResult: (res: AssemblyResult) => void) {
+        this.worker = new Worker(new URL("./AssemblerWorker.ts", import.meta.url), { type: "module" });
+        this.worker.onmessage = (ev: MessageEvent<AssemblyReply>) => {
+            this.onReply(ev.data);
+        };
+    }
+
+    // Assembles after the source didn't change for a moment
+    public update(src: string) {
+        clearTimeout(this.timer);
+        this.timer = setTimeout(() => { this.assemble(src); }, this.DEBOUNCE_MS);
+    }
+
+    public assemble(src: string) {
+        clearTimeout(this.timer);
+        this.worker.postMessage({ seq: ++this.seq, src } satisfies AssemblyRequest);
+    }
+
+    // Returns the words that differ from what was last loaded and marks them as loaded
+    public takeChangedWords(): (number | undefined)[] {
+        const changed: (number | undefined)[] = [];
+        for (let addr = 0; addr < this.memory.length; addr++) {
+            const value = this.memory[addr];
+            if (value !== undefined && value !== this.loaded[addr]) {
+                changed[addr] = value;
+                this.loaded[addr] = value;
+            }
+        }
+        return changed;
+    }
+
+    // Forgets what was loaded, e.g. after core was changed by other means
+    public resetLoaded() {
+        this.loaded = [];
+    }
+
+    public terminate() {
+        clearTimeout(this.timer);
+        this.worker.terminate();
+    }
+
+    private onReply(reply: AssemblyReply) {
+        for (let i = 0; i < reply.changedAddrs.length; i++) {
+            const value = reply.changedValues[i];
+            this.memory[reply.changedAddrs[i]] = value >= 0 ? value : undefined;
+        }
+
+        // replies for outdated sources still carry deltas, but only the latest one is shown
+        if (reply.seq != this.seq) {
+            return;
+        }
+
+        this.onResult({
+            errors: reply.errors,
+            symbols: reply.symbols,
+            hasBinary: reply.hasBinary,
+            memory: [...this.memory],
+        });
+    }
+}
@@ -0,0 +1,140 @@
+/*
+ *   SoCDP8 - A PDP-8/I implementation on a SoC
+ *   Copyright (C) 2021 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+import { BinTapeReader, SymbolType, Yamas } from "yamas";
+import { AssemblyReply, AssemblyRequest, AssemblySymbol } from "./Assembler";
+
+// memory image of the last run to compute the changes
+let lastMemory: (number | undefined)[] = [];
+let lastSrc: string | undefined;
+let lastReply: AssemblyReply | undefined;
+let pending: AssemblyRequest | undefined;
+
+function assemble(req: AssemblyRequest): AssemblyReply {
+    const asm = new Yamas({ loadPrelude: true });
+    asm.addInput("input.pa", req.src);
+    const out = asm.run();
+    const memory = out.binary.length > 0 ? new BinTapeReader(out.binary).read() : [];
+
+    const changedAddrs: number[] = [];
+    const changedValues: number[] = [];
+    const len = Math.max(memory.length, lastMemory.length);
+    for (let addr = 0; addr < len; addr++) {
+        if (memory[addr] !== lastMemory[addr]) {
+            changedAddrs.push(addr);
+            changedValues.push(memory[addr] ?? -1);
+        }
+    }
+    lastMemory = memory;
+
+    const symbols: AssemblySymbol[] = [...out.symbols.values()]
+        .filter(s => (s.type == SymbolType.Param && !s.fixed) || s.type == SymbolType.Label)
+        .map(s => ({ name: s.name, type: s.type, value: s.value }))
+        .sort((a, b) => a.name.localeCompare(b.name));
+
+    return {
+        seq: req.seq,
+        errors: out.errors.map(e => ({ line: e.line, col: e.col, message: e.message })),
+        symbols,
+        changedAddrs: Uint32Array.from(changedAddrs),
+        changedValues: Int32Array.from(changedValues),
+        hasBinary: out.binary.length > 0,
+    };
+}
+
+// Crashes of the assembler are shown like errors, the previous image is kept
+function failedReply(req: AssemblyRequest, e: unknown): AssemblyReply {
+    return {
+        seq: req.seq,
+        errors: [{ line: 0, col: 0, message: `Assembler failed: ${e instanceof Error ? e.message : String(e)}` }],
+        symbols: [],
+        changedAddrs: new Uint32Array(),
+        changedValues: new Int32Array(),
+        hasBinary: false,
+    };
+}
+
+// The part of a line that the assembler sees or undefined if a slash could also be a
+// character or a TEXT delimiter instead of the start of a comment
+function codePart(line: string): string | undefined {
+    const slash = line.indexOf("/");
+    const code = slash < 0 ? line : line.substring(0, slash);
+    if (code.includes("\"") || /TEXT/i.test(code)) {
+        return undefined;
+    }
+    return code;
+}
+
+// Yamas can't keep its prelude or symbol table between runs, but edits that only touch
+// comments can't change the result, which covers a good part of the typing
+function onlyCommentsChanged(oldSrc: string, newSrc: string): boolean {
+    const oldLines = oldSrc.split("\n");
+    const newLines = newSrc.split("\n");
+    if (oldLines.length != newLines.length) {
+        return false;
+    }
+
+    for (let i = 0; i < oldLines.length; i++) {
+        if (oldLines[i] != newLines[i]) {
+            const code = codePart(oldLines[i]);
+            if (code === undefined || code !== codePart(newLines[i])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Requests that queued up while assembling are skipped, only the latest source is assembled
+function runPending() {
+    const req = pending;
+    pending = undefined;
+    if (!req) {
+        return;
+    }
+
+    if (lastReply && lastSrc !== undefined && onlyCommentsChanged(lastSrc, req.src)) {
+        lastSrc = req.src;
+        self.postMessage({
+            ...lastReply,
+            seq: req.seq,
+            changedAddrs: new Uint32Array(),
+            changedValues: new Int32Array(),
+        } satisfies AssemblyReply);
+        return;
+    }
+
+    let reply: AssemblyReply;
+    try {
+        reply = assemble(req);
+    } catch (e) {
+        lastReply = undefined;
+        self.postMessage(failedReply(req, e));
+        return;
+    }
+    lastSrc = req.src;
+    lastReply = { ...reply, changedAddrs: new Uint32Array(), changedValues: new Int32Array() };
+    self.postMessage(reply, { transfer: [reply.changedAddrs.buffer, reply.changedValues.buffer] });
+}
+
+self.onmessage = (ev: MessageEvent<AssemblyRequest>) => {
+    if (!pending) {
+        setTimeout(runPending, 0);
+    }
+    pending = ev.data;
+};
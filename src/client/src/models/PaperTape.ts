@@ -30,6 +30,7 @@ interface PaperStore {
     setPaperState: (newState: PaperState) => void;
     setPos: (newPos: number) => void;
     pushChar: (c: number) => void;
+    pushChars: (chars: number[]) => void;
     clear: () => void;
 }
 
@@ -49,6 +50,9 @@ export class PaperTape {
         pushChar: (c: number) => set(draft => {
             draft.tapeState.buffer.push(c);
         }),
+        pushChars: (chars: number[]) => set(draft => {
+            draft.tapeState.buffer.push(...chars);
+        }),
         clear: () => set(draft => {
             draft.tapeState.buffer = [];
             draft.tapeState.pos = 0;
@@ -22,11 +22,17 @@ import { ConsoleState } from "../types/ConsoleTypes";
 import { PeripheralInAction } from "../types/PeripheralAction";
 import { DeviceID } from "../types/PeripheralTypes";
 import { SystemConfiguration } from "../types/SystemConfiguration";
+import { CoreRange, CoreSegment } from "../types/CoreSegments";
+import { TapeLoadRequest, TapeLoadResult } from "../types/TapeFormat";
+import { PanelMacroResult, PanelStep } from "../types/PanelMacro";
+import { Breakpoint, BreakpointState } from "../types/Breakpoint";
+import { DebugCommand, DebugReply } from "../types/DebugProtocol";
 import { Backend } from "./backends/Backend";
 import { BackendListener } from "./backends/BackendListener";
 import { DF32Model } from "./peripherals/DF32Model";
 import { DumpMixin } from "./peripherals/DumpMixin";
 import { KW8IModel } from "./peripherals/KW8IModel";
+import { LP08Model } from "./peripherals/LP08Model";
 import { PC04Model } from "./peripherals/PC04Model";
 import { PeripheralModel } from "./peripherals/PeripheralModel";
 import { PT08Model } from "./peripherals/PT08Model";
@@ -175,6 +181,9 @@ export class SoCDP8 {
                 case DeviceID.DEV_ID_KW8I:
                     peripheral = new KW8IModel(this.backend, conf);
                     break;
+                case DeviceID.DEV_ID_LP08:
+                    peripheral = new LP08Model(this.backend, conf);
+                    break;
             }
 
             this.store.getState().setPeripheral(conf.id, peripheral);
@@ -222,6 +231,18 @@ export class SoCDP8 {
         await this.backend.setActiveSystem(id);
     }
 
+    // Only the server keeps systems that can share images
+    public canCopySystems(): boolean {
+        return this.backend.copySystem !== undefined;
+    }
+
+    public async copySystem(id: string, name: string): Promise<void> {
+        if (!this.backend.copySystem) {
+            throw Error("Copying systems is not supported by this backend");
+        }
+        await this.backend.copySystem(id, name);
+    }
+
     public async deleteSystem(id: string): Promise<void> {
         await this.backend.deleteSystem(id);
     }
@@ -234,8 +255,50 @@ export class SoCDP8 {
         return await this.coreDumpHandler.downloadDump(0);
     }
 
-    public async writeCore(addr: number, fragment: number[]): Promise<void> {
-        await this.backend.writeCore(addr, fragment);
+    public async writeCore(segments: CoreSegment[]): Promise<void> {
+        await this.backend.writeCore(segments);
+    }
+
+    public async readCore(ranges: CoreRange[]): Promise<CoreSegment[]> {
+        return await this.backend.readCore(ranges);
+    }
+
+    public async loadTape(req: TapeLoadRequest): Promise<TapeLoadResult> {
+        return await this.backend.loadTape(req);
+    }
+
+    public async runPanelMacro(steps: PanelStep[]): Promise<PanelMacroResult> {
+        return await this.backend.runPanelMacro(steps);
+    }
+
+    public async runDebugCommands(cmds: DebugCommand[]): Promise<DebugReply> {
+        return await this.backend.runDebugCommands(cmds);
+    }
+
+    // Only the FPGA has hardware breakpoints
+    public hasBreakpoints(): boolean {
+        return this.backend.setBreakpoint !== undefined;
+    }
+
+    public async setBreakpoint(slot: number, bp: Breakpoint | null): Promise<BreakpointState> {
+        if (!this.backend.setBreakpoint) {
+            throw Error("Breakpoints are not supported by this backend");
+        }
+        return await this.backend.setBreakpoint(slot, bp);
+    }
+
+    public async readBreakpoints(): Promise<BreakpointState> {
+        if (!this.backend.readBreakpoints) {
+            throw Error("Breakpoints are not supported by this backend");
+        }
+        return await this.backend.readBreakpoints();
+    }
+
+    public async clearBreakpointHits(): Promise<BreakpointState> {
+        if (!this.backend.clearBreakpointHits) {
+            throw Error("Breakpoints are not supported by this backend");
+        }
+        return await this.backend.clearBreakpointHits();
     }
 
     public async loadCoreDump(dump: Uint8Array) {
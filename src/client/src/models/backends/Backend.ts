@@ -20,6 +20,11 @@ import { DeviceID, PeripheralConfiguration } from "../../types/PeripheralTypes";
 import { SystemConfiguration } from "../../types/SystemConfiguration";
 import { BackendListener } from "./BackendListener";
 import { PeripheralOutAction } from "../../types/PeripheralAction";
+import { CoreRange, CoreSegment } from "../../types/CoreSegments";
+import { TapeLoadRequest, TapeLoadResult } from "../../types/TapeFormat";
+import { PanelMacroResult, PanelStep } from "../../types/PanelMacro";
+import { Breakpoint, BreakpointState } from "../../types/Breakpoint";
+import { DebugCommand, DebugReply } from "../../types/DebugProtocol";
 
 export interface Backend {
     connect(listener: BackendListener): Promise<void>;
@@ -31,12 +36,35 @@ export interface Backend {
     deleteSystem(id: string): Promise<void>;
     createSystem(state: SystemConfiguration): Promise<void>;
 
+    // Copies the saved state of a system, the server shares the disk images between both
+    copySystem?(id: string, name: string): Promise<void>;
+
     setPanelSwitch(sw: string, state: boolean): Promise<void>;
+
+    // Sets switches and presses keys like an operator, resolves when the last key was released
+    runPanelMacro(steps: PanelStep[]): Promise<PanelMacroResult>;
     setThrottleControl(control: boolean): Promise<void>;
 
     clearCore(): Promise<void>;
-    writeCore(addr: number, fragment: number[]): Promise<void>;
+    writeCore(segments: CoreSegment[]): Promise<void>;
+    readCore(ranges: CoreRange[]): Promise<CoreSegment[]>;
+
+    // Loads a RIM or BIN tape directly into core, leaves the CPU halted at the start address
+    loadTape(req: TapeLoadRequest): Promise<TapeLoadResult>;
+
+    // Executes a batch of debugger commands, see DebugProtocol.ts
+    runDebugCommands(cmds: DebugCommand[]): Promise<DebugReply>;
 
     sendPeripheralAction(id: DeviceID, action: PeripheralOutAction): Promise<void>;
     changePeripheralConfig(id: DeviceID, config: PeripheralConfiguration): Promise<void>;
+
+    // Chunked image transfer for backends behind a network connection,
+    // the others exchange images through peripheral actions
+    uploadImage?(id: DeviceID, unit: number, data: Uint8Array): Promise<void>;
+    downloadImage?(id: DeviceID, unit: number): Promise<Uint8Array>;
+
+    // Hardware breakpoints of the FPGA CPU
+    setBreakpoint?(slot: number, bp: Breakpoint | null): Promise<BreakpointState>;
+    readBreakpoints?(): Promise<BreakpointState>;
+    clearBreakpointHits?(): Promise<BreakpointState>;
 }
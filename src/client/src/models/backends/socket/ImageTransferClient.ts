@@ -0,0 +1,151 @@
+/*
+ *   SoCDP8 - A PDP-8/I implementation on a SoC
+ *   Copyright (C) 2021 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+import { Socket } from "socket.io-client";
+import { DeviceID } from "../../../types/PeripheralTypes";
+import {
+    crc32, IMAGE_CHUNK_SIZE, IMAGE_TRANSFER_WINDOW, ImageChunk, ImageCompression,
+    ImageTransferInfo, ImageTransferRequest,
+} from "../../../types/ImageTransfer";
+import { RemoteReply } from "../../../types/RemoteReply";
+
+// Client side of the chunked image transfer, see types/ImageTransfer.ts
+export class ImageTransferClient {
+    private readonly REQUEST_TIMEOUT_MS = 15000;
+    private readonly MAX_RESUMES = 5;
+
+    public constructor(private socket: Socket, private compression: ImageCompression = "deflate") {
+    }
+
+    public async upload(id: DeviceID, unit: number, data: Uint8Array): Promise<void> {
+        const hash = await sha256(data);
+        const req: ImageTransferRequest = { id, unit, direction: "upload", compression: this.compression, size: data.length, hash };
+
+        let info = await this.request<ImageTransferInfo>("image-open", req);
+        for (let resume = 0; ; resume++) {
+            try {
+                await this.runWindow(info.missing, index => this.sendChunk(info.transferId, data, index));
+                break;
+            } catch (e) {
+                if (resume == this.MAX_RESUMES) {
+                    throw e;
+                }
+                // reopen the transfer to learn which chunks arrived
+                await this.waitConnected();
+                info = await this.request<ImageTransferInfo>("image-open", { ...req, transferId: info.transferId });
+            }
+        }
+
+        await this.request<undefined>("image-close", info.transferId);
+    }
+
+    public async download(id: DeviceID, unit: number): Promise<Uint8Array> {
+        const req: ImageTransferRequest = { id, unit, direction: "download", compression: this.compression };
+
+        let info = await this.request<ImageTransferInfo>("image-open", req);
+        const snapshotId = info.snapshotId;
+        const data = new Uint8Array(info.size);
+        const received: boolean[] = new Array<boolean>(info.chunkCount).fill(false);
+
+        for (let resume = 0; ; resume++) {
+            const missing = received.flatMap((ok, i) => ok ? [] : [i]);
+            try {
+                await this.runWindow(missing, async index => {
+                    await this.receiveChunk(info.transferId, data, index);
+                    received[index] = true;
+                });
+                break;
+            } catch (e) {
+                if (resume == this.MAX_RESUMES) {
+                    throw e;
+                }
+                // the chunks we have are only valid for the same snapshot, the server checks that
+                await this.waitConnected();
+                info = await this.request<ImageTransferInfo>("image-open", { ...req, transferId: info.transferId, snapshotId });
+            }
+        }
+
+        await this.request<undefined>("image-close", info.transferId);
+        return data;
+    }
+
+    private async sendChunk(transferId: string, data: Uint8Array, index: number) {
+        const raw = data.subarray(index * IMAGE_CHUNK_SIZE, (index + 1) * IMAGE_CHUNK_SIZE);
+        const payload = this.compression == "deflate" ? await transform(raw, new CompressionStream("deflate")) : raw;
+        const chunk: ImageChunk = { transferId, index, crc: crc32(raw), data: payload };
+        await this.request<undefined>("image-chunk", chunk);
+    }
+
+    private async receiveChunk(transferId: string, data: Uint8Array, index: number) {
+        const chunk = await this.request<ImageChunk>("image-read-chunk", transferId, index);
+        let raw = new Uint8Array(chunk.data);
+        if (this.compression == "deflate") {
+            raw = await transform(raw, new DecompressionStream("deflate"));
+        }
+
+        if (crc32(raw) != chunk.crc) {
+            throw Error(`Checksum error in chunk ${index.toString()}`);
+        }
+        data.set(raw, index * IMAGE_CHUNK_SIZE);
+    }
+
+    // Processes the chunks with up to IMAGE_TRANSFER_WINDOW requests in flight
+    private async runWindow(chunks: number[], op: (index: number) => Promise<void>) {
+        const queue = [...chunks];
+        const worker = async () => {
+            for (let index = queue.shift(); index !== undefined; index = queue.shift()) {
+                await op(index);
+            }
+        };
+
+        const workers: Promise<void>[] = [];
+        for (let i = 0; i < IMAGE_TRANSFER_WINDOW; i++) {
+            workers.push(worker());
+        }
+        await Promise.all(workers);
+    }
+
+    private async request<T>(event: string, ...args: unknown[]): Promise<T> {
+        const reply = await this.socket.timeout(this.REQUEST_TIMEOUT_MS).emitWithAck(event, ...args) as RemoteReply<T>;
+        if (!reply.ok) {
+            throw Error(reply.error ?? `${event} failed`);
+        }
+        return reply.result as T;
+    }
+
+    private async waitConnected() {
+        if (this.socket.connected) {
+            return;
+        }
+        await new Promise<void>(resolve => this.socket.once("connect", () => { resolve(); }));
+    }
+}
+
+// Only available in secure contexts, without it the image is always sent
+async function sha256(data: Uint8Array): Promise<string | undefined> {
+    if (!globalThis.crypto?.subtle) {
+        return undefined;
+    }
+    const digest = await crypto.subtle.digest("SHA-256", data as Uint8Array<ArrayBuffer>);
+    return Array.from(new Uint8Array(digest)).map(b => b.toString(16).padStart(2, "0")).join("");
+}
+
+async function transform(data: Uint8Array, stream: CompressionStream | DecompressionStream): Promise<Uint8Array> {
+    const output = new Blob([data as Uint8Array<ArrayBuffer>]).stream().pipeThrough(stream);
+    return new Uint8Array(await new Response(output).arrayBuffer());
+}
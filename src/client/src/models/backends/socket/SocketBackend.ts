@@ -23,9 +23,17 @@ import { SystemConfiguration } from "../../../types/SystemConfiguration";
 import { Backend } from "../Backend";
 import { BackendListener } from "../BackendListener";
 import { PeripheralInAction, PeripheralOutAction } from "../../../types/PeripheralAction";
+import { ImageTransferClient } from "./ImageTransferClient";
+import { RemoteReply } from "../../../types/RemoteReply";
+import { CoreRange, CoreSegment, toWords } from "../../../types/CoreSegments";
+import { TapeLoadRequest, TapeLoadResult } from "../../../types/TapeFormat";
+import { PanelMacroResult, PanelStep } from "../../../types/PanelMacro";
+import { Breakpoint, BreakpointState } from "../../../types/Breakpoint";
+import { DebugCommand, DebugReply } from "../../../types/DebugProtocol";
 
 export class SocketBackend implements Backend {
     private socket: Socket;
+    private imageTransfer: ImageTransferClient;
 
     public constructor(url: string) {
         if (url.length > 0) {
@@ -33,6 +41,7 @@ export class SocketBackend implements Backend {
         } else {
             this.socket = io({ autoConnect: false });
         }
+        this.imageTransfer = new ImageTransferClient(this.socket);
     }
 
     public async connect(listener: BackendListener) {
@@ -110,6 +119,18 @@ export class SocketBackend implements Backend {
         });
     }
 
+    public async copySystem(id: string, name: string) {
+        return new Promise<void>((accept, reject) => {
+            this.socket.emit("copy-system", id, name, (res: boolean) => {
+                if (res) {
+                    accept();
+                } else {
+                    reject(Error("Couldn't copy system"));
+                }
+            });
+        });
+    }
+
     public async deleteSystem(id: string) {
         return new Promise<void>((accept, reject) => {
             this.socket.emit("delete-system", id, (res: boolean) => {
@@ -134,12 +155,52 @@ export class SocketBackend implements Backend {
         this.socket.emit("core", { action: "clear" });
     }
 
-    public async writeCore(addr: number, fragment: number[]) {
-        this.socket.emit("core", {
-            action: "write",
-            addr: addr,
-            fragment: fragment
-        });
+    public async writeCore(segments: CoreSegment[]) {
+        const ok = await this.socket.emitWithAck("core-write", segments) as boolean;
+        if (!ok) {
+            throw Error("Writing core failed");
+        }
+    }
+
+    public async readCore(ranges: CoreRange[]): Promise<CoreSegment[]> {
+        const segments = await this.socket.emitWithAck("core-read", ranges) as { address: number, data: ArrayBuffer }[];
+        return segments.map(seg => ({ address: seg.address, data: toWords(seg.data) }));
+    }
+
+    public async loadTape(req: TapeLoadRequest): Promise<TapeLoadResult> {
+        const reply = await this.socket.emitWithAck("load-tape", req) as RemoteReply<TapeLoadResult>;
+        if (!reply.ok || !reply.result) {
+            throw Error(reply.error ?? "Loading the tape failed");
+        }
+        return reply.result;
+    }
+
+    public async runPanelMacro(steps: PanelStep[]): Promise<PanelMacroResult> {
+        const reply = await this.socket.emitWithAck("panel-macro", steps) as RemoteReply<PanelMacroResult>;
+        if (!reply.ok || !reply.result) {
+            throw Error(reply.error ?? "Running the panel macro failed");
+        }
+        return reply.result;
+    }
+
+    public async runDebugCommands(cmds: DebugCommand[]): Promise<DebugReply> {
+        return await this.socket.emitWithAck("debug", cmds) as DebugReply;
+    }
+
+    public async setBreakpoint(slot: number, bp: Breakpoint | null): Promise<BreakpointState> {
+        const reply = await this.socket.emitWithAck("breakpoint-set", slot, bp) as RemoteReply<BreakpointState>;
+        if (!reply.ok || !reply.result) {
+            throw Error(reply.error ?? "Setting the breakpoint failed");
+        }
+        return reply.result;
+    }
+
+    public async readBreakpoints(): Promise<BreakpointState> {
+        return await this.socket.emitWithAck("breakpoint-list") as BreakpointState;
+    }
+
+    public async clearBreakpointHits(): Promise<BreakpointState> {
+        return await this.socket.emitWithAck("breakpoint-clear-hits") as BreakpointState;
     }
 
     public async sendPeripheralAction(id: DeviceID, action: PeripheralOutAction): Promise<void> {
@@ -149,6 +210,14 @@ export class SocketBackend implements Backend {
         });
     }
 
+    public async uploadImage(id: DeviceID, unit: number, data: Uint8Array): Promise<void> {
+        await this.imageTransfer.upload(id, unit, data);
+    }
+
+    public async downloadImage(id: DeviceID, unit: number): Promise<Uint8Array> {
+        return await this.imageTransfer.download(id, unit);
+    }
+
     public async changePeripheralConfig(id: DeviceID, config: PeripheralConfiguration): Promise<void> {
         this.socket.emit("peripheral-change-conf", {
             id: id,
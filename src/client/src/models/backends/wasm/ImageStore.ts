@@ -0,0 +1,91 @@
+/*
+ *   SoCDP8 - A PDP-8/I implementation on a SoC
+ *   Copyright (C) 2021 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// One PDP-8 disk block of 256 words, two bytes per word
+export const IMAGE_BLOCK_SIZE = 512;
+
+export type ImageRequest =
+    { seq: number, type: "load", dir: string, name: string } |
+    { seq: number, type: "sync", dir: string, name: string, data: Uint8Array } |
+    { seq: number, type: "close", dir: string };
+
+export interface ImageReply {
+    seq: number;
+    data?: Uint8Array;
+    dirtyBlocks?: number;
+    error?: string;
+}
+
+/**
+ * Persists disk, tape and core images of a system in the origin private file system.
+ * The files are accessed through synchronous access handles inside a worker that also
+ * keeps the last synced content so that only changed blocks are written back.
+ */
+export class ImageStore {
+    private worker: Worker;
+    private seq = 0;
+    private pending = new Map<number, (reply: ImageReply) => void>();
+
+    public constructor() {
+        this.worker = new Worker(new URL("./ImageStoreWorker.ts", import.meta.url), { type: "module" });
+        this.worker.onmessage = (ev: MessageEvent<ImageReply>) => {
+            const resolve = this.pending.get(ev.data.seq);
+            if (resolve) {
+                this.pending.delete(ev.data.seq);
+                resolve(ev.data);
+            }
+        };
+
+        // an exception in the worker means that the outstanding requests will never be answered
+        this.worker.onerror = (ev: ErrorEvent) => {
+            const pending = this.pending;
+            this.pending = new Map();
+            for (const [seq, resolve] of pending) {
+                resolve({ seq, error: `Image store failed: ${ev.message}` });
+            }
+        };
+    }
+
+    public async load(dir: string, name: string): Promise<Uint8Array | undefined> {
+        const reply = await this.request({ seq: this.seq++, type: "load", dir, name });
+        return reply.data;
+    }
+
+    // Takes ownership of data, returns the number of blocks that were written
+    public async sync(dir: string, name: string, data: Uint8Array): Promise<number> {
+        const reply = await this.request({ seq: this.seq++, type: "sync", dir, name, data }, [data.buffer as ArrayBuffer]);
+        return reply.dirtyBlocks ?? 0;
+    }
+
+    public async close(dir: string): Promise<void> {
+        await this.request({ seq: this.seq++, type: "close", dir });
+    }
+
+    private async request(req: ImageRequest, transfer: Transferable[] = []): Promise<ImageReply> {
+        const reply = await new Promise<ImageReply>(resolve => {
+            this.pending.set(req.seq, resolve);
+            this.worker.postMessage(req, transfer);
+        });
+
+        if (reply.error) {
+            throw Error(reply.error);
+        }
+
+        return reply;
+    }
+}
@@ -0,0 +1,132 @@
+/*
+ *   SoCDP8 - A PDP-8/I implementation on a SoC
+ *   Copyright (C) 2021 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+import { ImageReply, ImageRequest, IMAGE_BLOCK_SIZE } from "./ImageStore";
+
+// An image that is open for synchronous access, together with the content last written to it
+interface OpenImage {
+    handle: FileSystemSyncAccessHandle;
+    synced: Uint8Array;
+}
+
+const images = new Map<string, OpenImage>();
+
+async function openImage(dir: string, name: string, create: boolean): Promise<OpenImage | undefined> {
+    const path = `${dir}/${name}`;
+    const existing = images.get(path);
+    if (existing) {
+        return existing;
+    }
+
+    const root = await navigator.storage.getDirectory();
+    const systemsDir = await root.getDirectoryHandle("systems", { create: true });
+    const sysDir = await systemsDir.getDirectoryHandle(dir, { create: true });
+
+    let fileHandle: FileSystemFileHandle;
+    try {
+        fileHandle = await sysDir.getFileHandle(name, { create });
+    } catch (e) {
+        if (e instanceof DOMException && e.name == "NotFoundError") {
+            return undefined;
+        }
+        throw e;
+    }
+
+    const handle = await fileHandle.createSyncAccessHandle();
+    const synced = new Uint8Array(handle.getSize());
+    handle.read(synced, { at: 0 });
+
+    const image: OpenImage = { handle, synced };
+    images.set(path, image);
+    return image;
+}
+
+function syncImage(image: OpenImage, data: Uint8Array): number {
+    let dirtyBlocks = 0;
+
+    for (let pos = 0; pos < data.length; pos += IMAGE_BLOCK_SIZE) {
+        const end = Math.min(pos + IMAGE_BLOCK_SIZE, data.length);
+        let dirty = end > image.synced.length;
+        for (let i = pos; i < end && !dirty; i++) {
+            if (data[i] != image.synced[i]) {
+                dirty = true;
+            }
+        }
+
+        if (dirty) {
+            image.handle.write(data.subarray(pos, end), { at: pos });
+            dirtyBlocks++;
+        }
+    }
+
+    if (data.length != image.synced.length) {
+        image.handle.truncate(data.length);
+    }
+
+    if (dirtyBlocks > 0) {
+        image.handle.flush();
+    }
+    image.synced = data;
+
+    return dirtyBlocks;
+}
+
+function closeImages(dir: string) {
+    for (const [path, image] of images) {
+        if (path.startsWith(`${dir}/`)) {
+            image.handle.close();
+            images.delete(path);
+        }
+    }
+}
+
+async function handleRequest(req: ImageRequest): Promise<ImageReply> {
+    switch (req.type) {
+        case "load": {
+            const image = await openImage(req.dir, req.name, false);
+            if (!image || image.synced.length == 0) {
+                return { seq: req.seq };
+            }
+            return { seq: req.seq, data: image.synced.slice() };
+        }
+        case "sync": {
+            const image = await openImage(req.dir, req.name, true);
+            if (!image) {
+                throw Error(`Couldn't create ${req.name}`);
+            }
+            return { seq: req.seq, dirtyBlocks: syncImage(image, req.data) };
+        }
+        case "close":
+            closeImages(req.dir);
+            return { seq: req.seq };
+    }
+}
+
+self.onmessage = (ev: MessageEvent<ImageRequest>) => {
+    const req = ev.data;
+    handleRequest(req).then(reply => {
+        if (reply.data) {
+            self.postMessage(reply, { transfer: [reply.data.buffer] });
+        } else {
+            self.postMessage(reply);
+        }
+    }).catch((e: unknown) => {
+        const msg = e instanceof Error ? e.message : String(e);
+        self.postMessage({ seq: req.seq, error: msg } satisfies ImageReply);
+    });
+};
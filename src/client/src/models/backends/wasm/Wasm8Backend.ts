@@ -19,12 +19,17 @@
 import { create } from "zustand";
 import { immer } from "zustand/middleware/immer";
 import { PeripheralOutAction } from "../../../types/PeripheralAction";
+import { CoreRange, CoreSegment, toWords } from "../../../types/CoreSegments";
+import { parseTape, TapeLoadRequest, TapeLoadResult } from "../../../types/TapeFormat";
+import { checkPanelSteps, lampWord, PanelMacroResult, PanelStep } from "../../../types/PanelMacro";
+import { checkDebugCommands, DEBUG_DEFAULT_TIMEOUT_MS, DebugCommand, DebugRegisters, DebugReply, DebugResult, disassemble } from "../../../types/DebugProtocol";
 import { DeviceID, PeripheralConfiguration } from "../../../types/PeripheralTypes";
 import { getDefaultSysConf, SystemConfiguration } from "../../../types/SystemConfiguration";
-import { downloadData, generateUUID } from "../../../util";
+import { generateUUID } from "../../../util";
 import { TapeState } from "../../DECTape";
 import { Backend } from "../Backend";
 import { BackendListener } from "../BackendListener";
+import { ImageStore } from "./ImageStore";
 import { ThrottleController } from "./ThrottleController";
 import { Wasm8Context } from "./Wasm8Context";
 
@@ -41,7 +46,11 @@ export class Wasm8Backend implements Backend {
     private listener?: BackendListener;
     private pdp8: Wasm8Context;
     private throttler?: ThrottleController;
-    private dumpAcceptor?: (dump: Uint8Array) => void;
+    private images = new ImageStore();
+    private dumpAcceptors = new Map<DeviceID, (dump: Uint8Array) => void>();
+
+    // the dump is sent from the emulator's event loop, so it only stays away if the emulator died
+    private readonly DOWNLOAD_TIMEOUT_MS = 10000;
 
     private store = create<BackendStore>()(immer(set => ({
         systems: [],
@@ -136,6 +145,7 @@ export class Wasm8Backend implements Backend {
             throw Error("Can't delete active system");
         }
 
+        await this.images.close(id);
         const root = await navigator.storage.getDirectory();
         const systemsDir = await root.getDirectoryHandle("systems");
         await systemsDir.removeEntry(id, { recursive: true });
@@ -150,19 +160,51 @@ export class Wasm8Backend implements Backend {
             throw Error("No active system");
         }
 
-        const sysDir = await this.getSystemDirectory(sys);
-        const dumpPromise = new Promise<Uint8Array>((resolve, _reject) => {
-            this.dumpAcceptor = resolve;
-            void this.sendPeripheralAction(DeviceID.DEV_ID_CPU, { type: "download-disk", unit: 0 });
-        });
-        const coreDump = await dumpPromise;
-        this.dumpAcceptor = undefined;
+        const coreDump = await this.downloadImage(DeviceID.DEV_ID_CPU, 0);
+        await this.images.sync(sys.id, "core.dat", coreDump);
 
-        await downloadData(coreDump, "core.dat");
+        for (const peripheral of sys.peripherals) {
+            const units = getImageUnits(peripheral);
+            for (let unit = 0; unit < units; unit++) {
+                const dump = await this.downloadImage(peripheral.id, unit);
+                await this.images.sync(sys.id, getImageName(peripheral.id, unit), dump);
+            }
+        }
 
         return true;
     }
 
+    private async downloadImage(id: DeviceID, unit: number): Promise<Uint8Array> {
+        let timer: ReturnType<typeof setTimeout> | undefined;
+        try {
+            return await new Promise<Uint8Array>((resolve, reject) => {
+                timer = setTimeout(() => reject(Error(`No image from ${DeviceID[id]} unit ${unit}`)), this.DOWNLOAD_TIMEOUT_MS);
+                this.dumpAcceptors.set(id, resolve);
+                void this.sendPeripheralAction(id, { type: "download-disk", unit });
+            });
+        } finally {
+            clearTimeout(timer);
+            this.dumpAcceptors.delete(id);
+        }
+    }
+
+    private async loadImages(sys: SystemConfiguration) {
+        const core = await this.images.load(sys.id, "core.dat");
+        if (core) {
+            await this.sendPeripheralAction(DeviceID.DEV_ID_CPU, { type: "upload-disk", unit: 0, data: core });
+        }
+
+        for (const peripheral of sys.peripherals) {
+            const units = getImageUnits(peripheral);
+            for (let unit = 0; unit < units; unit++) {
+                const data = await this.images.load(sys.id, getImageName(peripheral.id, unit));
+                if (data) {
+                    await this.sendPeripheralAction(peripheral.id, { type: "upload-disk", unit, data });
+                }
+            }
+        }
+    }
+
     private async getSystemDirectory(system: SystemConfiguration): Promise<FileSystemDirectoryHandle> {
         const root = await navigator.storage.getDirectory();
         const systemsDir = await root.getDirectoryHandle("systems", { create: true });
@@ -188,6 +230,11 @@ export class Wasm8Backend implements Backend {
             throw Error(`Unknown system ${id}`);
         }
 
+        const prevSys = this.store.getState().activeSystem;
+        if (prevSys && prevSys.id != sys.id) {
+            await this.images.close(prevSys.id);
+        }
+
         this.pdp8.setSwitch("stop", true);
         this.pdp8.clearPeripherals();
         this.pdp8.clearCore();
@@ -199,9 +246,14 @@ export class Wasm8Backend implements Backend {
         );
 
         for (const peripheral of sys.peripherals) {
+            if (peripheral.id == DeviceID.DEV_ID_LP08) {
+                // only implemented in the FPGA
+                continue;
+            }
             this.pdp8.addPeripheral(peripheral.id);
             await this.changePeripheralConfig(peripheral.id, peripheral);
         }
+        await this.loadImages(sys);
         this.store.getState().setActiveSystem(sys);
         this.listener?.onStateChange({ type: "active-state-changed" });
     }
@@ -219,12 +271,161 @@ export class Wasm8Backend implements Backend {
         this.pdp8.clearCore();
     }
 
-    public async writeCore(addr: number, fragment: number[]) {
-        for (let i = 0; i < fragment.length; i++) {
-            this.pdp8.writeCore(addr + i, fragment[i]);
+    public async writeCore(segments: CoreSegment[]) {
+        for (const seg of segments) {
+            this.pdp8.writeCoreRun(seg.address, seg.data);
+        }
+    }
+
+    // The emulator can only dump the whole core, which is still cheaper than a call per word
+    public async readCore(ranges: CoreRange[]): Promise<CoreSegment[]> {
+        const core = toWords(await this.downloadImage(DeviceID.DEV_ID_CPU, 0));
+        return ranges.map(range => ({ address: range.address, data: core.slice(range.address, range.address + range.length) }));
+    }
+
+    public async loadTape(req: TapeLoadRequest): Promise<TapeLoadResult> {
+        const image = parseTape(req.data, req.format);
+        const startField = req.startField ?? 0;
+        const startAddress = req.startAddress ?? 0o200;
+
+        for (const seg of image.segments) {
+            this.pdp8.writeCoreRun(seg.field * 4096 + seg.address, seg.data);
+        }
+
+        // the emulator can't set registers directly, so do what an operator would do
+        await this.pressKey("stop");
+        for (let i = 0; i < 3; i++) {
+            this.pdp8.setSwitch(`if${i.toString()}`, (startField & (4 >> i)) != 0);
+        }
+        for (let i = 0; i < 12; i++) {
+            this.pdp8.setSwitch(`swr${i.toString()}`, (startAddress & (0o4000 >> i)) != 0);
+        }
+        await this.pressKey("load");
+
+        return {
+            wordCount: image.wordCount,
+            checksum: image.checksum,
+            startField: startField,
+            startAddress: startAddress,
+        };
+    }
+
+    // The emulator has no key sequencer, so the switches are set and the keys pressed one by one
+    public async runPanelMacro(steps: PanelStep[]): Promise<PanelMacroResult> {
+        checkPanelSteps(steps);
+
+        let keyCount = 0;
+        for (const step of steps) {
+            switch (step.op) {
+                case "swr":
+                    for (let i = 0; i < 12; i++) {
+                        this.pdp8.setSwitch(`swr${i.toString()}`, (step.value & (0o4000 >> i)) != 0);
+                    }
+                    break;
+                case "df":
+                case "if":
+                    for (let i = 0; i < 3; i++) {
+                        this.pdp8.setSwitch(`${step.op}${i.toString()}`, (step.value & (4 >> i)) != 0);
+                    }
+                    break;
+                case "key":
+                    await this.pressKey(step.key);
+                    keyCount++;
+                    break;
+            }
+        }
+
+        return { keyCount, lamps: this.pdp8.getConsoleState().lamps };
+    }
+
+    // The emulator is only controlled through the console, so the registers are read from the lamps
+    // and each step is a CONT with SING INST. This is limited by the key timing to a few steps per second.
+    public async runDebugCommands(cmds: DebugCommand[]): Promise<DebugReply> {
+        checkDebugCommands(cmds);
+
+        const results: DebugResult[] = [];
+        try {
+            for (const cmd of cmds) {
+                results.push(await this.runDebugCommand(cmd));
+            }
+        } catch (e) {
+            return { results, error: e instanceof Error ? e.message : String(e) };
+        }
+        return { results };
+    }
+
+    private async runDebugCommand(cmd: DebugCommand): Promise<DebugResult> {
+        switch (cmd.op) {
+            case "regs":
+                return { op: "regs", regs: this.readDebugRegisters() };
+            case "halt":
+                await this.haltForDebug();
+                return { op: "halt", regs: this.readDebugRegisters() };
+            case "step":
+                await this.haltForDebug();
+                for (let i = 0; i < cmd.count; i++) {
+                    await this.stepInstruction();
+                }
+                return { op: "step", regs: this.readDebugRegisters() };
+            case "run-until": {
+                await this.haltForDebug();
+                const deadline = Date.now() + (cmd.timeoutMs ?? DEBUG_DEFAULT_TIMEOUT_MS);
+                let regs = this.readDebugRegisters();
+                while (regs.instField * 4096 + regs.pc != cmd.address && Date.now() < deadline) {
+                    await this.stepInstruction();
+                    regs = this.readDebugRegisters();
+                }
+                return { op: "run-until", reached: regs.instField * 4096 + regs.pc == cmd.address, regs };
+            }
+            case "read": {
+                const [seg] = await this.readCore([{ address: cmd.address, length: cmd.length }]);
+                return { op: "read", address: cmd.address, data: Array.from(seg.data) };
+            }
+            case "write":
+                await this.writeCore([{ address: cmd.address, data: Uint16Array.from(cmd.data) }]);
+                return { op: "write", address: cmd.address, length: cmd.data.length };
+            case "disasm": {
+                const [seg] = await this.readCore([{ address: cmd.address, length: cmd.length }]);
+                return { op: "disasm", lines: disassemble(cmd.address, seg.data) };
+            }
+        }
+    }
+
+    private async haltForDebug() {
+        if (this.readDebugRegisters().run) {
+            await this.pressKey("stop");
         }
     }
 
+    private async stepInstruction() {
+        const singInst = this.pdp8.getConsoleState().switches.singInst != 0;
+        this.pdp8.setSwitch("sing_inst", true);
+        await this.pressKey("cont");
+        this.pdp8.setSwitch("sing_inst", singInst);
+    }
+
+    private readDebugRegisters(): DebugRegisters {
+        const lamps = this.pdp8.getConsoleState().lamps;
+        return {
+            pc: lampWord(lamps.pc),
+            instField: lampWord(lamps.instField),
+            dataField: lampWord(lamps.dataField),
+            ac: lampWord(lamps.ac),
+            link: lamps.link > 7,
+            mq: lampWord(lamps.mqr),
+            ma: lampWord(lamps.memAddr),
+            mb: lampWord(lamps.memBuf),
+            ion: lamps.ion > 7,
+            run: lamps.run > 7,
+        };
+    }
+
+    // Momentary keys are released by the context after 100 ms
+    private async pressKey(key: string) {
+        this.pdp8.setSwitch(key, true);
+        await new Promise(resolve => setTimeout(resolve, 150));
+    }
+
     public async sendPeripheralAction(id: DeviceID, action: PeripheralOutAction): Promise<void> {
         switch (id) {
             case DeviceID.DEV_ID_CPU:
@@ -281,12 +482,7 @@ export class Wasm8Backend implements Backend {
                     this.throttler?.onPerformanceReport(simSpeed);
                     this.listener.onPerformanceReport(simSpeed);
                 } else if (action == 6) {
-                    const dump = this.pdp8.fetchBuffer(p1, p2);
-                    if (this.dumpAcceptor) {
-                        this.dumpAcceptor(dump);
-                    } else {
-                        this.listener.onPeripheralEvent(DeviceID.DEV_ID_CPU, { type: "dump-data", dump });
-                    }
+                    this.onDump(dev, this.pdp8.fetchBuffer(p1, p2));
                 }
                 break;
             case DeviceID.DEV_ID_DF32:
@@ -294,8 +490,7 @@ export class Wasm8Backend implements Backend {
             case DeviceID.DEV_ID_RK08:
             case DeviceID.DEV_ID_RK8E:
                 if (action >= 20 && action < 30) {
-                    const dump = this.pdp8.fetchBuffer(p1, p2);
-                    this.listener.onPeripheralEvent(dev, { type: "dump-data", dump });
+                    this.onDump(dev, this.pdp8.fetchBuffer(p1, p2));
                 }
                 break;
             case DeviceID.DEV_ID_PT08:
@@ -311,7 +506,7 @@ export class Wasm8Backend implements Backend {
                 } else if (action == 2) {
                     this.listener.onPeripheralEvent(dev, {
                         type: "punch",
-                        char: p1,
+                        chars: [p1],
                     });
                 }
                 break;
@@ -324,7 +519,7 @@ export class Wasm8Backend implements Backend {
                 } else if (action == 2) {
                     this.listener.onPeripheralEvent(DeviceID.DEV_ID_PC04, {
                         type: "punch",
-                        char: p1,
+                        chars: [p1],
                     });
                 }
                 break;
@@ -347,13 +542,21 @@ export class Wasm8Backend implements Backend {
                         });
                     }
                 } else if (action >= 20 && action < 30) {
-                    const dump = this.pdp8.fetchBuffer(p1, p2);
-                    this.listener.onPeripheralEvent(dev, { type: "dump-data", dump });
+                    this.onDump(dev, this.pdp8.fetchBuffer(p1, p2));
                 }
                 break;
         }
     }
 
+    private onDump(dev: DeviceID, dump: Uint8Array) {
+        const acceptor = this.dumpAcceptors.get(dev);
+        if (acceptor) {
+            acceptor(dump);
+        } else {
+            this.listener?.onPeripheralEvent(dev, { type: "dump-data", dump });
+        }
+    }
+
     public async changePeripheralConfig(id: DeviceID, config: PeripheralConfiguration): Promise<void> {
         switch (config.id) {
             case DeviceID.DEV_ID_PT08:
@@ -372,3 +575,29 @@ export class Wasm8Backend implements Backend {
         }
     }
 }
+
+// Number of disk or tape images a peripheral keeps in the system directory
+function getImageUnits(conf: PeripheralConfiguration): number {
+    switch (conf.id) {
+        case DeviceID.DEV_ID_TC08:
+            return conf.numTapes;
+        case DeviceID.DEV_ID_DF32:
+        case DeviceID.DEV_ID_RF08:
+        case DeviceID.DEV_ID_RK08:
+        case DeviceID.DEV_ID_RK8E:
+            return 4;
+        default:
+            return 0;
+    }
+}
+
+function getImageName(id: DeviceID, unit: number): string {
+    switch (id) {
+        case DeviceID.DEV_ID_TC08:  return `tc08-${unit}.dat`;
+        case DeviceID.DEV_ID_DF32:  return `df32-${unit}.dat`;
+        case DeviceID.DEV_ID_RF08:  return `rf08-${unit}.dat`;
+        case DeviceID.DEV_ID_RK08:  return `rk08-${unit}.dat`;
+        case DeviceID.DEV_ID_RK8E:  return `rk8e-${unit}.dat`;
+        default:                    return `dev${id}-${unit}.dat`;
+    }
+}
@@ -253,6 +253,18 @@ export class Wasm8Context {
         this.sendPeripheralAction(0, this.EventWriteWord, addr, value);
     }
 
+    public writeCoreRun(addr: number, data: ArrayLike<number>) {
+        if (!this.ctx || !this.calls) {
+            throw Error("Not connected");
+        }
+
+        const ctx = this.ctx;
+        const call = this.calls.peripheralAction;
+        for (let i = 0; i < data.length; i++) {
+            call(ctx, 0, this.EventWriteWord, addr + i, data[i]);
+        }
+    }
+
     public sendPeripheralAction(dev: number, action: number, p1: number, p2: number) {
         if (!this.ctx || !this.calls) {
             throw Error("Not connected");
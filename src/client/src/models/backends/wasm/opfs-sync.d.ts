@@ -0,0 +1,17 @@
+// Synchronous OPFS access is only available in dedicated workers and not part of the DOM lib
+interface FileSystemReadWriteOptions {
+    at?: number;
+}
+
+interface FileSystemSyncAccessHandle {
+    read(buffer: AllowSharedBufferSource, options?: FileSystemReadWriteOptions): number;
+    write(buffer: AllowSharedBufferSource, options?: FileSystemReadWriteOptions): number;
+    truncate(newSize: number): void;
+    getSize(): number;
+    flush(): void;
+    close(): void;
+}
+
+interface FileSystemFileHandle {
+    createSyncAccessHandle(): Promise<FileSystemSyncAccessHandle>;
+}
@@ -37,6 +37,10 @@ export class DumpMixin {
     }
 
     public async downloadDump(unit: number): Promise<Uint8Array> {
+        if (this.backend.downloadImage) {
+            return await this.backend.downloadImage(this.devId, unit);
+        }
+
         return new Promise<Uint8Array>(accept => {
             this.dumpAcceptor = accept;
             void this.backend.sendPeripheralAction(this.devId, { type: "download-disk", unit });
@@ -44,6 +48,11 @@ export class DumpMixin {
     }
 
     public async uploadDump(unit: number, data: Uint8Array) {
+        if (this.backend.uploadImage) {
+            await this.backend.uploadImage(this.devId, unit, data);
+            return;
+        }
+
         await this.backend.sendPeripheralAction(this.devId, {
             type: "upload-disk",
             data,
@@ -53,7 +62,7 @@ export class DumpMixin {
 
     public async saveState(model: DiskModel): Promise<Map<string, Uint8Array>> {
         const dumps = new Map<string, Uint8Array>();
-        for (let i = 0; i < model.getDiskSize(); i++) {
+        for (let i = 0; i < model.getDiskCount(); i++) {
             const name = `dump${i + 1}.${model.getDumpExtension()}`;
             const dump = await model.downloadDump(i);
             dumps.set(name, dump);
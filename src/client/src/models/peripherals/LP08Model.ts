@@ -0,0 +1,77 @@
+/*
+ *   SoCDP8 - A PDP-8/I implementation on a SoC
+ *   Copyright (C) 2019 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+import { PeripheralModel } from "./PeripheralModel";
+import { DeviceID, LP08Configuration, PeripheralConfiguration } from "../../types/PeripheralTypes";
+import { Backend } from "../backends/Backend";
+import { PeripheralInAction, PrinterJob } from "../../types/PeripheralAction";
+import { create } from "zustand";
+import { immer } from "zustand/middleware/immer";
+
+interface LP08Store {
+    jobs: PrinterJob[];
+
+    setJobs: (jobs: PrinterJob[]) => void;
+}
+
+export class LP08Model extends PeripheralModel {
+    private store = create<LP08Store>()(immer(set => ({
+        jobs: [],
+        setJobs: (jobs: PrinterJob[]) => set(draft => {
+            draft.jobs = jobs;
+        }),
+    })));
+
+    constructor(backend: Backend, private conf: LP08Configuration) {
+        super(backend);
+        void this.backend.sendPeripheralAction(this.conf.id, { type: "printer-list" });
+    }
+
+    public get connections(): number[] {
+        return [0o65, 0o66];
+    }
+
+    public get id() {
+        return this.conf.id;
+    }
+
+    public get useState() {
+        return this.store;
+    }
+
+    public onPeripheralAction(id: DeviceID, action: PeripheralInAction) {
+        if (action.type == "printer-jobs") {
+            this.store.getState().setJobs(action.jobs);
+        }
+    }
+
+    // The spool of a job is transferred like a disk image with the job ID as unit
+    public async downloadJob(job: PrinterJob): Promise<Uint8Array> {
+        if (!this.backend.downloadImage) {
+            throw Error("Backend can't download print jobs");
+        }
+        return await this.backend.downloadImage(this.conf.id, job.id);
+    }
+
+    public async clearJobs(): Promise<void> {
+        await this.backend.sendPeripheralAction(this.conf.id, { type: "printer-clear" });
+    }
+
+    public async saveState(): Promise<{ config: PeripheralConfiguration, data: Map<string, Uint8Array> }> {
+        return { config: this.conf, data: new Map() };
+    }
+}
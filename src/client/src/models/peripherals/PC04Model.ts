@@ -78,7 +78,7 @@ export class PC04Model extends PeripheralModel {
     public onPeripheralAction(id: DeviceID, action: PeripheralInAction) {
         switch (action.type) {
             case "punch":
-                this.onPunch(action.char);
+                this.onPunch(action.chars);
                 break;
             case "readerPos":
                 this.setReaderPos(action.pos);
@@ -86,9 +86,9 @@ export class PC04Model extends PeripheralModel {
         }
     }
 
-    public onPunch(data: number) {
+    public onPunch(data: number[]) {
         if (this.store.getState().punchActive) {
-            this.punchTape.useTape().pushChar(data);
+            this.punchTape.useTape.getState().pushChars(data);
         }
     }
 
@@ -32,7 +32,7 @@ interface PT08Store {
     setConf: (conf: PT08Configuration) => void;
     setReader: (active: boolean) => void;
     setPunch: (active: boolean) => void;
-    addOutput: (chr: number) => void;
+    addOutput: (chars: number[]) => void;
     clearOutput: () => void;
 }
 
@@ -53,8 +53,8 @@ export class PT08Model extends PeripheralModel {
         setPunch: (active: boolean) => set(draft => {
             draft.punchActive = active;
         }),
-        addOutput: (chr: number) => set(draft => {
-            draft.outBuf.push(chr);
+        addOutput: (chars: number[]) => set(draft => {
+            draft.outBuf.push(...chars);
         }),
         clearOutput: () => set(draft => {
             draft.outBuf = [];
@@ -113,7 +113,7 @@ export class PT08Model extends PeripheralModel {
     public onPeripheralAction(id: DeviceID, action: PeripheralInAction) {
         switch (action.type) {
             case "punch":
-                this.onPunch(action.char);
+                this.onPunch(action.chars);
                 break;
             case "readerPos":
                 this.setReaderPos(action.pos);
@@ -121,10 +121,10 @@ export class PT08Model extends PeripheralModel {
         }
     }
 
-    public onPunch(data: number) {
+    public onPunch(data: number[]) {
         this.store.getState().addOutput(data);
         if (this.store.getState().punchActive) {
-            this.punchTape.useTape.getState().pushChar(data);
+            this.punchTape.useTape.getState().pushChars(data);
         }
     }
 
@@ -0,0 +1,78 @@
+/*
+ *   SoCDP8 - A PDP-8/I implementation on a SoC
+ *   Copyright (C) 2021 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Hardware breakpoints of the CPU, keep in sync with the client.
+//
+// PC and AC breakpoints are checked before the next instruction is fetched. If they halt,
+// the CPU stops with PC at the breakpoint so CONT executes the instruction at that address.
+// Memory and IOT breakpoints halt the CPU at the end of the instruction that caused the hit.
+
+export const BREAKPOINT_COUNT = 4;
+
+export type BreakpointType =
+    "pc" |      // fetch from field:value
+    "read" |    // data read from field:value, including indirect addresses and data breaks
+    "write" |   // data write to field:value, including auto-index increments and data breaks
+    "access" |  // read or write
+    "ac" |      // AC equals value at the end of an instruction
+    "iot";      // IOT for device value
+
+export const BREAKPOINT_TYPES: BreakpointType[] = ["pc", "read", "write", "access", "ac", "iot"];
+
+export interface Breakpoint {
+    type: BreakpointType;
+    field: number;
+    value: number;
+
+    // halt the CPU on a hit
+    halt: boolean;
+
+    // report the hit to the clients
+    notify: boolean;
+}
+
+export interface BreakpointState {
+    // null for unused slots
+    breakpoints: (Breakpoint | null)[];
+
+    // sticky, stay set until cleared
+    hits: boolean[];
+}
+
+export function checkBreakpoint(slot: number, bp: Breakpoint | null) {
+    if (!Number.isInteger(slot) || slot < 0 || slot >= BREAKPOINT_COUNT) {
+        throw Error(`Invalid breakpoint slot ${String(slot)}`);
+    }
+
+    if (!bp) {
+        return;
+    }
+
+    if (!BREAKPOINT_TYPES.includes(bp.type)) {
+        throw Error(`Invalid breakpoint type ${bp.type}`);
+    }
+
+    const maxValue = bp.type == "iot" ? 0o77 : 0o7777;
+    if (!Number.isInteger(bp.value) || bp.value < 0 || bp.value > maxValue) {
+        throw Error(`Invalid breakpoint value ${String(bp.value)}`);
+    }
+
+    if (!Number.isInteger(bp.field) || bp.field < 0 || bp.field > 7) {
+        throw Error(`Invalid breakpoint field ${String(bp.field)}`);
+    }
+}
@@ -0,0 +1,61 @@
+/*
+ *   SoCDP8 - A PDP-8/I implementation on a SoC
+ *   Copyright (C) 2021 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Bulk core access over the socket API, keep in sync with the client.
+// Addresses are 15 bit (field * 4096 + address), the words are sent as binary payload
+// with "core-write" and "core-read".
+
+export interface CoreSegment {
+    address: number;
+    data: Uint16Array;
+}
+
+export interface CoreRange {
+    address: number;
+    length: number;
+}
+
+// Binary payloads arrive as Buffer or ArrayBuffer that might not be aligned for a word view
+export function toWords(data: ArrayBuffer | ArrayBufferView): Uint16Array {
+    if (data instanceof Uint16Array) {
+        return data;
+    }
+
+    const bytes = data instanceof ArrayBuffer ? new Uint8Array(data) : new Uint8Array(data.buffer, data.byteOffset, data.byteLength);
+    const words = new Uint16Array(bytes.length >> 1);
+    new Uint8Array(words.buffer).set(bytes.subarray(0, words.byteLength));
+    return words;
+}
+
+// Collects runs of defined words from a sparse memory image
+export function toSegments(mem: (number | undefined)[], base = 0): CoreSegment[] {
+    const segments: CoreSegment[] = [];
+    let start = -1;
+
+    for (let i = 0; i <= mem.length; i++) {
+        const defined = i < mem.length && mem[i] !== undefined;
+        if (defined && start < 0) {
+            start = i;
+        } else if (!defined && start >= 0) {
+            segments.push({ address: base + start, data: Uint16Array.from(mem.slice(start, i) as number[]) });
+            start = -1;
+        }
+    }
+
+    return segments;
+}
@@ -0,0 +1,206 @@
+/*
+ *   SoCDP8 - A PDP-8/I implementation on a SoC
+ *   Copyright (C) 2021 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Batched debugger requests, keep in sync with the client.
+// A request is a list of commands that are executed in order with one result per command.
+// If a command fails, the reply has the results up to that command and the error.
+// Addresses are 15 bit (field * 4096 + address) as for the core access.
+
+export type DebugCommand =
+    { op: "regs" } |
+    { op: "halt" } |
+    { op: "step", count: number } |
+    { op: "run-until", address: number, timeoutMs?: number } |
+    { op: "read", address: number, length: number } |
+    { op: "write", address: number, data: number[] } |
+    { op: "disasm", address: number, length: number };
+
+export interface DebugRegisters {
+    // address of the next instruction, i.e. including a pending skip
+    pc: number;
+    instField: number;
+    dataField: number;
+    ac: number;
+    link: boolean;
+    mq: number;
+    ma: number;
+    mb: number;
+    ion: boolean;
+    run: boolean;
+}
+
+export interface DisassembledWord {
+    address: number;
+    word: number;
+    text: string;
+}
+
+export type DebugResult =
+    { op: "regs", regs: DebugRegisters } |
+    { op: "halt", regs: DebugRegisters } |
+    { op: "step", regs: DebugRegisters } |
+    { op: "run-until", reached: boolean, regs: DebugRegisters } |
+    { op: "read", address: number, data: number[] } |
+    { op: "write", address: number, length: number } |
+    { op: "disasm", lines: DisassembledWord[] };
+
+export interface DebugReply {
+    results: DebugResult[];
+    error?: string;
+}
+
+export const DEBUG_MAX_COMMANDS = 1024;
+export const DEBUG_MAX_STEPS = 1000000;
+export const DEBUG_MAX_WORDS = 32768;
+export const DEBUG_DEFAULT_TIMEOUT_MS = 1000;
+export const DEBUG_MAX_TIMEOUT_MS = 60000;
+
+export function checkDebugCommands(cmds: DebugCommand[]) {
+    if (cmds.length > DEBUG_MAX_COMMANDS) {
+        throw Error(`Debug requests are limited to ${DEBUG_MAX_COMMANDS.toString()} commands`);
+    }
+
+    for (const cmd of cmds) {
+        switch (cmd.op) {
+            case "regs":
+            case "halt":
+                break;
+            case "step":
+                checkRange("step count", cmd.count, 1, DEBUG_MAX_STEPS);
+                break;
+            case "run-until":
+                checkRange("address", cmd.address, 0, 0o77777);
+                if (cmd.timeoutMs !== undefined) {
+                    checkRange("timeout", cmd.timeoutMs, 1, DEBUG_MAX_TIMEOUT_MS);
+                }
+                break;
+            case "read":
+            case "disasm":
+                checkRange("address", cmd.address, 0, 0o77777);
+                checkRange("length", cmd.length, 1, DEBUG_MAX_WORDS);
+                break;
+            case "write":
+                checkRange("address", cmd.address, 0, 0o77777);
+                checkRange("length", cmd.data.length, 1, DEBUG_MAX_WORDS);
+                for (const word of cmd.data) {
+                    checkRange("word", word, 0, 0o7777);
+                }
+                break;
+            default:
+                throw Error(`Unknown debug command ${JSON.stringify(cmd)}`);
+        }
+    }
+}
+
+function checkRange(name: string, value: number, min: number, max: number) {
+    if (!Number.isInteger(value) || value < min || value > max) {
+        throw Error(`Invalid ${name} ${String(value)}`);
+    }
+}
+
+const MRI_NAMES = ["AND", "TAD", "ISZ", "DCA", "JMS", "JMP"];
+
+const IOT_NAMES = new Map<number, string>([
+    [0o6001, "ION"], [0o6002, "IOF"],
+    [0o6031, "KSF"], [0o6032, "KCC"], [0o6034, "KRS"], [0o6036, "KRB"],
+    [0o6041, "TSF"], [0o6042, "TCF"], [0o6044, "TPC"], [0o6046, "TLS"],
+    [0o6011, "RSF"], [0o6012, "RRB"], [0o6014, "RFC"],
+    [0o6021, "PSF"], [0o6022, "PCF"], [0o6024, "PPC"], [0o6026, "PLS"],
+    [0o6214, "RDF"], [0o6224, "RIF"], [0o6234, "RIB"], [0o6244, "RMF"],
+]);
+
+// operate microinstructions in the order in which they are usually written
+const GROUP1_OPS: [number, string][] = [[0o200, "CLA"], [0o100, "CLL"], [0o040, "CMA"], [0o020, "CML"], [0o001, "IAC"]];
+const GROUP2_OPS: [number, string][] = [[0o100, "SMA"], [0o040, "SZA"], [0o020, "SNL"], [0o200, "CLA"], [0o004, "OSR"], [0o002, "HLT"]];
+const GROUP2_OPS_REV: [number, string][] = [[0o100, "SPA"], [0o040, "SNA"], [0o020, "SZL"], [0o200, "CLA"], [0o004, "OSR"], [0o002, "HLT"]];
+const GROUP3_OPS: [number, string][] = [[0o200, "CLA"], [0o100, "MQA"], [0o040, "SCA"], [0o020, "MQL"]];
+const ROTATE_NAMES = new Map<number, string>([[0o002, "BSW"], [0o004, "RAL"], [0o006, "RTL"], [0o010, "RAR"], [0o012, "RTR"]]);
+const EAE_NAMES = ["", "SCL", "MUY", "DVI", "NMI", "SHL", "ASR", "LSR"];
+
+function octal(value: number, digits: number): string {
+    return value.toString(8).padStart(digits, "0");
+}
+
+// Disassembles a single word at a 15 bit address, memory references show the effective 12 bit address
+export function disassembleWord(address: number, word: number): string {
+    const op = word >> 9;
+
+    if (op < 6) {
+        const offset = word & 0o177;
+        const target = (word & 0o200) ? ((address & 0o7600) | offset) : offset;
+        const indirect = (word & 0o400) ? " I" : "";
+        return `${MRI_NAMES[op]}${indirect} ${octal(target, 4)}`;
+    }
+
+    if (op == 6) {
+        const name = IOT_NAMES.get(word);
+        if (name) {
+            return name;
+        }
+
+        if ((word & 0o7700) == 0o6200 && (word & 0o3) != 0 && (word & 0o4) == 0) {
+            const field = (word >> 3) & 0o7;
+            const parts: string[] = [];
+            if (word & 0o1) {
+                parts.push(`CDF ${octal(field, 1)}0`);
+            }
+            if (word & 0o2) {
+                parts.push(`CIF ${octal(field, 1)}0`);
+            }
+            return parts.join(" ");
+        }
+
+        return `IOT ${octal(word, 4)}`;
+    }
+
+    if ((word & 0o400) == 0) {
+        const parts = microOps(word, GROUP1_OPS);
+        const rotate = word & 0o016;
+        if (rotate != 0) {
+            parts.push(ROTATE_NAMES.get(rotate) ?? octal(rotate, 2));
+        }
+        return parts.length > 0 ? parts.join(" ") : "NOP";
+    } else if ((word & 0o001) == 0) {
+        const reverse = (word & 0o010) != 0;
+        const parts = microOps(word, reverse ? GROUP2_OPS_REV : GROUP2_OPS);
+        if (reverse && (word & 0o160) == 0) {
+            parts.unshift("SKP");
+        }
+        return parts.length > 0 ? parts.join(" ") : "NOP";
+    } else {
+        // the operand of two word EAE instructions is shown as separate word
+        const parts = microOps(word, GROUP3_OPS);
+        const eae = EAE_NAMES[(word >> 1) & 0o7];
+        if (eae) {
+            parts.push(eae);
+        }
+        return parts.length > 0 ? parts.join(" ") : "NOP";
+    }
+}
+
+function microOps(word: number, ops: [number, string][]): string[] {
+    return ops.filter(([bit]) => (word & bit) != 0).map(([, name]) => name);
+}
+
+export function disassemble(address: number, words: ArrayLike<number>): DisassembledWord[] {
+    const res: DisassembledWord[] = [];
+    for (let i = 0; i < words.length; i++) {
+        res.push({ address: address + i, word: words[i], text: disassembleWord(address + i, words[i]) });
+    }
+    return res;
+}
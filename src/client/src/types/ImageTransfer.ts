@@ -0,0 +1,93 @@
+/*
+ *   SoCDP8 - A PDP-8/I implementation on a SoC
+ *   Copyright (C) 2021 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+import { DeviceID } from "./PeripheralTypes";
+
+// Chunked image transfer over the socket API, keep in sync with the server.
+// The client opens a transfer with 'image-open', then sends or requests chunks with
+// 'image-chunk' and 'image-read-chunk' while keeping a window of requests in flight
+// and finally commits it with 'image-close'. Transfers survive a disconnect: opening
+// again with the transfer id returns the chunks that are still missing.
+
+export const IMAGE_CHUNK_SIZE = 64 * 1024;
+export const IMAGE_TRANSFER_WINDOW = 4;
+
+export type ImageCompression = "none" | "deflate";
+
+export interface ImageTransferRequest {
+    id: DeviceID;
+    unit: number;
+    direction: "upload" | "download";
+    compression: ImageCompression;
+
+    // required for uploads
+    size?: number;
+
+    // SHA-256 of the image as hex string, optional for uploads. If the server already
+    // has an image with this hash, the transfer opens with no missing chunks.
+    hash?: string;
+
+    // set to resume an interrupted transfer
+    transferId?: string;
+
+    // set with transferId to resume a download, opening fails if the image changed
+    snapshotId?: string;
+}
+
+export interface ImageTransferInfo {
+    transferId: string;
+    size: number;
+    chunkCount: number;
+
+    // chunks that the server didn't receive yet, empty for downloads
+    missing: number[];
+
+    // SHA-256 of the image that is downloaded as hex string
+    snapshotId?: string;
+}
+
+export interface ImageChunk {
+    transferId: string;
+    index: number;
+
+    // CRC-32 of the uncompressed chunk
+    crc: number;
+
+    // compressed if the transfer uses compression
+    data: Uint8Array;
+}
+
+const CRC_TABLE = (() => {
+    const table = new Uint32Array(256);
+    for (let n = 0; n < 256; n++) {
+        let c = n;
+        for (let k = 0; k < 8; k++) {
+            c = (c & 1) ? (0xEDB88320 ^ (c >>> 1)) : (c >>> 1);
+        }
+        table[n] = c >>> 0;
+    }
+    return table;
+})();
+
+export function crc32(data: Uint8Array): number {
+    let crc = 0xFFFFFFFF;
+    for (let i = 0; i < data.length; i++) {
+        crc = CRC_TABLE[(crc ^ data[i]) & 0xFF] ^ (crc >>> 8);
+    }
+    return (crc ^ 0xFFFFFFFF) >>> 0;
+}
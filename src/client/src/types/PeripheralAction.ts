@@ -20,7 +20,8 @@ import { TapeState } from "../models/DECTape";
 
 export type PeripheralOutAction =
     KeyPressAction | TapeSetAction | ReaderStateAction |
-    DownloadDiskAction | UploadDiskAction;
+    DownloadDiskAction | UploadDiskAction |
+    PrinterListAction | PrinterClearAction;
 
 export interface KeyPressAction {
     type: "key-press";
@@ -48,11 +49,21 @@ export interface DownloadDiskAction {
     unit: number;
 }
 
+// Requests a printer-jobs event with the current jobs
+export interface PrinterListAction {
+    type: "printer-list";
+}
+
+// Deletes the spool of all finished print jobs
+export interface PrinterClearAction {
+    type: "printer-clear";
+}
+
 export type PeripheralInAction =
 DumpResultAction |
 ActiveStateChangeAction | StateListChangeAction |
 ReaderPosAction | PunchAction |
-TapeStatusAction;
+TapeStatusAction | PrinterJobsAction;
 
 export interface DumpResultAction {
     type: "dump-data";
@@ -66,7 +77,8 @@ export interface ReaderPosAction {
 
 export interface PunchAction {
     type: "punch";
-    char: number;
+    // punched characters since the last event
+    chars: number[];
 }
 
 export interface TapeStatusAction {
@@ -74,6 +86,21 @@ export interface TapeStatusAction {
     states: TapeState[];
 }
 
+// A print job of the line printer, the spool can be downloaded as image with the job ID as unit
+export interface PrinterJob {
+    id: number;
+    pages: number;
+    lines: number;
+    size: number;
+    done: boolean;
+}
+
+// Sent when a page or a job is finished
+export interface PrinterJobsAction {
+    type: "printer-jobs";
+    jobs: PrinterJob[];
+}
+
 export interface ActiveStateChangeAction {
     type: "active-state-changed";
 }
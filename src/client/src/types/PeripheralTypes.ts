@@ -30,6 +30,7 @@ export enum DeviceID {
     DEV_ID_KW8I     = 10,
     DEV_ID_RK08     = 11,
     DEV_ID_RK8E     = 12,
+    DEV_ID_LP08     = 13,
 
     _COUNT
 }
@@ -94,8 +95,13 @@ export interface KW8IConfiguration {
     use50Hz: boolean;
 }
 
+export interface LP08Configuration {
+    id: DeviceID.DEV_ID_LP08;
+}
+
 export type PeripheralConfiguration =
     PT08Configuration | PC04Configuration |
     TC08Configuration |
     DF32Configuration | RF08Configuration | RK08Configuration | RK8EConfiguration |
-    KW8IConfiguration;
+    KW8IConfiguration |
+    LP08Configuration;
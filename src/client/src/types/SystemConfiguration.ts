@@ -27,6 +27,7 @@ export interface SystemConfiguration {
         eae: boolean;
         kt8i: boolean;
         bsw: boolean;
+        fastEae: boolean;
     };
 
     maxMemField: number;
@@ -44,6 +45,7 @@ export function getDefaultSysConf(): SystemConfiguration {
             eae: true,
             kt8i: false,
             bsw: false,
+            fastEae: false,
         },
         peripherals: [
             {
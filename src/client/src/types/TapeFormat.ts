@@ -0,0 +1,161 @@
+/*
+ *   SoCDP8 - A PDP-8/I implementation on a SoC
+ *   Copyright (C) 2021 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Parser for paper tapes in RIM and BIN format so that they can be loaded into
+// core directly instead of through the RIM or BIN loader, keep in sync with the client.
+
+export type TapeFormat = "rim" | "bin";
+
+export interface TapeLoadRequest {
+    format: TapeFormat;
+    data: Uint8Array;
+
+    // where to set PC and IF after loading, defaults to 0200 in field 0
+    startField?: number;
+    startAddress?: number;
+}
+
+export interface TapeLoadResult {
+    wordCount: number;
+
+    // only for BIN tapes
+    checksum?: {
+        expected: number;
+        computed: number;
+    };
+
+    startField: number;
+    startAddress: number;
+}
+
+// A run of words that go to consecutive addresses
+export interface TapeSegment {
+    field: number;
+    address: number;
+    data: number[];
+}
+
+export interface TapeImage {
+    segments: TapeSegment[];
+    wordCount: number;
+    checksum?: {
+        expected: number;
+        computed: number;
+    };
+}
+
+const LEADER = 0o200;
+const RUBOUT = 0o377;
+const ORIGIN = 0o100;
+
+export function parseTape(tape: Uint8Array, format: TapeFormat): TapeImage {
+    const segments: TapeSegment[] = [];
+    let wordCount = 0;
+
+    const store = (field: number, address: number, value: number) => {
+        const last = segments[segments.length - 1];
+        if (last && last.field == field && last.address + last.data.length == address) {
+            last.data.push(value);
+        } else {
+            segments.push({ field, address, data: [value] });
+        }
+        wordCount++;
+    };
+
+    let field = 0;
+    let origin = 0;
+    let sum = 0;
+    let ignore = false;
+    let seenData = false;
+
+    // BIN tapes end with the checksum, so a data word is only stored when the next one arrives
+    let pending: { field: number, address: number, value: number, frameSum: number } | undefined;
+
+    for (let i = 0; i < tape.length; i++) {
+        const c = tape[i];
+
+        if (format == "bin" && c == RUBOUT) {
+            // rubouts enclose comments
+            ignore = !ignore;
+            continue;
+        }
+
+        if (ignore) {
+            continue;
+        }
+
+        if (c == LEADER) {
+            if (seenData) {
+                // trailer
+                break;
+            }
+            continue;
+        }
+
+        if ((c & 0o300) == 0o300) {
+            if (format == "bin") {
+                field = (c >> 3) & 0o7;
+            }
+            continue;
+        }
+
+        if (c & 0o200) {
+            continue;
+        }
+
+        if (i + 1 >= tape.length) {
+            throw Error("Tape ends within a word");
+        }
+        const c2 = tape[++i];
+        const word = ((c & 0o77) << 6) | (c2 & 0o77);
+        seenData = true;
+
+        if (c & ORIGIN) {
+            origin = word;
+            sum += c + c2;
+            continue;
+        }
+
+        if (format == "rim") {
+            store(field, origin, word);
+        } else {
+            if (pending) {
+                store(pending.field, pending.address, pending.value);
+            }
+            pending = { field, address: origin, value: word, frameSum: c + c2 };
+            sum += c + c2;
+        }
+        origin = (origin + 1) & 0o7777;
+    }
+
+    if (format == "bin") {
+        if (!pending) {
+            throw Error("No checksum on tape");
+        }
+        return {
+            segments,
+            wordCount,
+            checksum: {
+                expected: pending.value,
+                computed: (sum - pending.frameSum) & 0o7777,
+            },
+        };
+    }
+
+    return { segments, wordCount };
+}
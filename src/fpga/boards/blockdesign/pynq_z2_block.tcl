@@ -130,6 +130,7 @@ if { $bCheckIPs == 1 } {
    set list_check_ips "\ 
 xilinx.com:ip:processing_system7:5.5\
 xilinx.com:ip:proc_sys_reset:5.0\
+xilinx.com:ip:xlconcat:2.1\
 xilinx.com:ip:xlslice:1.0\
 "
 
@@ -241,6 +242,7 @@ proc create_hier_cell_pdp8i { parentCell nameHier } {
   create_bd_pin -dir O -from 7 -to 0 led_row_out
   create_bd_pin -dir I -type rst rstn_0
   create_bd_pin -dir I -type rst rstn_1
+  create_bd_pin -dir O -type intr cons_irq
   create_bd_pin -dir O -type intr soc_irq
   create_bd_pin -dir O -from 2 -to 0 switch_row_out
   create_bd_pin -dir O -from 1 -to 0 uart_cts
@@ -337,6 +339,7 @@ proc create_hier_cell_pdp8i { parentCell nameHier } {
   connect_bd_net -net console_mux_0_switch_start [get_bd_pins console_mux/switch_start_pdp] [get_bd_pins pdp8/switch_start]
   connect_bd_net -net console_mux_0_switch_stop [get_bd_pins console_mux/switch_stop_pdp] [get_bd_pins pdp8/switch_stop]
   connect_bd_net -net console_mux_0_switch_swr [get_bd_pins console_mux/switch_swr_pdp] [get_bd_pins pdp8/switch_swr]
+  connect_bd_net -net console_mux_irq [get_bd_pins cons_irq] [get_bd_pins console_mux/irq]
   connect_bd_net -net console_mux_lamp_brightness_cons [get_bd_pins console_mux/lamp_brightness_cons] [get_bd_pins pidp8_console/lamp_brightness]
   connect_bd_net -net io_controller_brk_ca_inc [get_bd_pins io_controller/brk_ca_inc] [get_bd_pins pdp8/brk_ca_inc]
   connect_bd_net -net io_controller_brk_data [get_bd_pins io_controller/brk_data] [get_bd_pins pdp8/brk_data]
@@ -347,6 +350,7 @@ proc create_hier_cell_pdp8i { parentCell nameHier } {
   connect_bd_net -net io_controller_brk_rqst [get_bd_pins io_controller/brk_rqst] [get_bd_pins pdp8/brk_rqst]
   connect_bd_net -net io_controller_brk_three_cycle [get_bd_pins io_controller/brk_three_cycle] [get_bd_pins pdp8/brk_three_cycle]
   connect_bd_net -net io_controller_conf_enable_eae [get_bd_pins io_controller/conf_enable_eae] [get_bd_pins pdp8/enable_ext_eae]
+  connect_bd_net -net io_controller_conf_enable_fast_eae [get_bd_pins io_controller/conf_enable_fast_eae] [get_bd_pins pdp8/enable_ext_fast_eae]
   connect_bd_net -net io_controller_conf_enable_kt8i [get_bd_pins io_controller/conf_enable_kt8i] [get_bd_pins pdp8/enable_ext_kt8i]
   connect_bd_net -net io_controller_conf_max_field [get_bd_pins io_controller/conf_max_field] [get_bd_pins pdp8/enable_ext_mem_fields]
   connect_bd_net -net io_controller_io_ac_clear [get_bd_pins io_controller/io_ac_clear] [get_bd_pins pdp8/io_ac_clear]
@@ -365,6 +369,15 @@ proc create_hier_cell_pdp8i { parentCell nameHier } {
   connect_bd_net -net pdp8_brk_ack [get_bd_pins io_controller/brk_ack] [get_bd_pins pdp8/brk_ack]
   connect_bd_net -net pdp8_brk_done [get_bd_pins io_controller/brk_done] [get_bd_pins pdp8/brk_done]
   connect_bd_net -net pdp8_brk_wc_overflow [get_bd_pins io_controller/brk_wc_overflow] [get_bd_pins pdp8/brk_wc_overflow]
+  connect_bd_net -net io_controller_cpu_bp_clear [get_bd_pins io_controller/cpu_bp_clear] [get_bd_pins pdp8/bp_clear]
+  connect_bd_net -net io_controller_cpu_bp_config [get_bd_pins io_controller/cpu_bp_config] [get_bd_pins pdp8/bp_config]
+  connect_bd_net -net io_controller_cpu_cont_rqst [get_bd_pins io_controller/cpu_cont_rqst] [get_bd_pins pdp8/cont_rqst]
+  connect_bd_net -net io_controller_cpu_halt_rqst [get_bd_pins io_controller/cpu_halt_rqst] [get_bd_pins pdp8/halt_rqst]
+  connect_bd_net -net io_controller_cpu_snap_load [get_bd_pins io_controller/cpu_snap_load] [get_bd_pins pdp8/snap_load]
+  connect_bd_net -net pdp8_bp_hits [get_bd_pins io_controller/cpu_bp_hits] [get_bd_pins pdp8/bp_hits]
+  connect_bd_net -net pdp8_cycle_count [get_bd_pins io_controller/cpu_cycles] [get_bd_pins pdp8/cycle_count]
+  connect_bd_net -net io_controller_cpu_snap_preload [get_bd_pins io_controller/cpu_snap_preload] [get_bd_pins pdp8/snap_preload]
+  connect_bd_net -net pdp8_snap_state [get_bd_pins io_controller/cpu_snap_state] [get_bd_pins pdp8/snap_state]
   connect_bd_net -net pdp8_led_accu [get_bd_pins console_mux/led_accu_pdp] [get_bd_pins pdp8/led_accu]
   connect_bd_net -net pdp8_led_data_field [get_bd_pins console_mux/led_data_field_pdp] [get_bd_pins pdp8/led_data_field]
   connect_bd_net -net pdp8_led_inst_field [get_bd_pins console_mux/led_inst_field_pdp] [get_bd_pins pdp8/led_inst_field]
@@ -1276,6 +1289,12 @@ proc create_root_design { parentCell } {
    CONFIG.C_NUM_PERP_ARESETN {6} \
  ] $reset_controller
 
+  # Create instance: irq_concat, and set properties
+  set irq_concat [ create_bd_cell -type ip -vlnv xilinx.com:ip:xlconcat:2.1 irq_concat ]
+  set_property -dict [ list \
+   CONFIG.NUM_PORTS {2} \
+ ] $irq_concat
+
   # Create instance: xlslice_0, and set properties
   set xlslice_0 [ create_bd_cell -type ip -vlnv xilinx.com:ip:xlslice:1.0 xlslice_0 ]
   set_property -dict [ list \
@@ -1347,7 +1366,9 @@ proc create_root_design { parentCell } {
   connect_bd_net -net processing_system7_0_FCLK_CLK0 [get_bd_pins pdp8i/S_AXI_ACLK] [get_bd_pins processing_system7_0/FCLK_CLK0] [get_bd_pins processing_system7_0/M_AXI_GP0_ACLK] [get_bd_pins ps7_0_axi_periph/ACLK] [get_bd_pins ps7_0_axi_periph/M00_ACLK] [get_bd_pins ps7_0_axi_periph/M01_ACLK] [get_bd_pins ps7_0_axi_periph/M02_ACLK] [get_bd_pins ps7_0_axi_periph/S00_ACLK] [get_bd_pins reset_controller/slowest_sync_clk]
   connect_bd_net -net processing_system7_0_FCLK_RESET0_N [get_bd_pins processing_system7_0/FCLK_RESET0_N] [get_bd_pins reset_controller/ext_reset_in]
   connect_bd_net -net reset_controller_peripheral_aresetn [get_bd_pins reset_controller/peripheral_aresetn] [get_bd_pins xlslice_0/Din] [get_bd_pins xlslice_1/Din] [get_bd_pins xlslice_2/Din] [get_bd_pins xlslice_3/Din] [get_bd_pins xlslice_4/Din] [get_bd_pins xlslice_5/Din]
-  connect_bd_net -net socdp8_soc_irq [get_bd_pins pdp8i/soc_irq] [get_bd_pins processing_system7_0/IRQ_F2P]
+  connect_bd_net -net irq_concat_dout [get_bd_pins irq_concat/dout] [get_bd_pins processing_system7_0/IRQ_F2P]
+  connect_bd_net -net pdp8i_cons_irq [get_bd_pins irq_concat/In1] [get_bd_pins pdp8i/cons_irq]
+  connect_bd_net -net socdp8_soc_irq [get_bd_pins irq_concat/In0] [get_bd_pins pdp8i/soc_irq]
   connect_bd_net -net uart_rts_0_1 [get_bd_ports uart_rts] [get_bd_pins pdp8i/uart_rts]
   connect_bd_net -net uart_rx_0_1 [get_bd_ports uart_rx] [get_bd_pins pdp8i/uart_rx]
   connect_bd_net -net xlslice_0_Dout [get_bd_pins ps7_0_axi_periph/ARESETN] [get_bd_pins ps7_0_axi_periph/S00_ARESETN] [get_bd_pins xlslice_0/Dout]
@@ -131,6 +131,7 @@ if { $bCheckIPs == 1 } {
    set list_check_ips "\ 
 xilinx.com:ip:processing_system7:5.5\
 xilinx.com:ip:proc_sys_reset:5.0\
+xilinx.com:ip:xlconcat:2.1\
 xilinx.com:ip:xlslice:1.0\
 "
 
@@ -239,6 +240,7 @@ proc create_hier_cell_pdp8i { parentCell nameHier } {
   create_bd_pin -dir I -type rst S_AXI_ARESETN_1
   create_bd_pin -dir I -type rst S_AXI_ARESETN_2
   create_bd_pin -dir IO -from 11 -to 0 column_io_0
+  create_bd_pin -dir O -type intr cons_irq
   create_bd_pin -dir O -type intr io_irq
   create_bd_pin -dir O -from 7 -to 0 led_row_out_0
   create_bd_pin -dir I -type rst rstn_0
@@ -323,6 +325,7 @@ proc create_hier_cell_pdp8i { parentCell nameHier } {
   connect_bd_net -net S_AXI_ARESETN_1_1 [get_bd_pins S_AXI_ARESETN_1] [get_bd_pins axi_bram/S_AXI_ARESETN]
   connect_bd_net -net S_AXI_ARESETN_2_1 [get_bd_pins S_AXI_ARESETN_2] [get_bd_pins io_controller/S_AXI_ARESETN]
   connect_bd_net -net axi_bram_data_out [get_bd_pins axi_bram/data_out] [get_bd_pins pdp8/mem_in_data]
+  connect_bd_net -net console_mux_irq [get_bd_pins cons_irq] [get_bd_pins console_mux/irq]
   connect_bd_net -net console_mux_lamp_brightness_cons [get_bd_pins console_mux/lamp_brightness_cons] [get_bd_pins pidp8_console/lamp_brightness]
   connect_bd_net -net console_mux_switch_cont_pdp [get_bd_pins console_mux/switch_cont_pdp] [get_bd_pins pdp8/switch_cont]
   connect_bd_net -net console_mux_switch_data_field_pdp [get_bd_pins console_mux/switch_data_field_pdp] [get_bd_pins pdp8/switch_data_field]
@@ -351,6 +354,15 @@ proc create_hier_cell_pdp8i { parentCell nameHier } {
   connect_bd_net -net pdp8_brk_ack [get_bd_pins io_controller/brk_ack] [get_bd_pins pdp8/brk_ack]
   connect_bd_net -net pdp8_brk_done [get_bd_pins io_controller/brk_done] [get_bd_pins pdp8/brk_done]
   connect_bd_net -net pdp8_brk_wc_overflow [get_bd_pins io_controller/brk_wc_overflow] [get_bd_pins pdp8/brk_wc_overflow]
+  connect_bd_net -net io_controller_cpu_bp_clear [get_bd_pins io_controller/cpu_bp_clear] [get_bd_pins pdp8/bp_clear]
+  connect_bd_net -net io_controller_cpu_bp_config [get_bd_pins io_controller/cpu_bp_config] [get_bd_pins pdp8/bp_config]
+  connect_bd_net -net io_controller_cpu_cont_rqst [get_bd_pins io_controller/cpu_cont_rqst] [get_bd_pins pdp8/cont_rqst]
+  connect_bd_net -net io_controller_cpu_halt_rqst [get_bd_pins io_controller/cpu_halt_rqst] [get_bd_pins pdp8/halt_rqst]
+  connect_bd_net -net io_controller_cpu_snap_load [get_bd_pins io_controller/cpu_snap_load] [get_bd_pins pdp8/snap_load]
+  connect_bd_net -net pdp8_bp_hits [get_bd_pins io_controller/cpu_bp_hits] [get_bd_pins pdp8/bp_hits]
+  connect_bd_net -net pdp8_cycle_count [get_bd_pins io_controller/cpu_cycles] [get_bd_pins pdp8/cycle_count]
+  connect_bd_net -net io_controller_cpu_snap_preload [get_bd_pins io_controller/cpu_snap_preload] [get_bd_pins pdp8/snap_preload]
+  connect_bd_net -net pdp8_snap_state [get_bd_pins io_controller/cpu_snap_state] [get_bd_pins pdp8/snap_state]
   connect_bd_net -net pdp8_io_ac [get_bd_pins io_controller/io_ac] [get_bd_pins pdp8/io_ac]
   connect_bd_net -net pdp8_io_iop [get_bd_pins io_controller/iop] [get_bd_pins pdp8/io_iop]
   connect_bd_net -net pdp8_io_mb [get_bd_pins io_controller/io_mb] [get_bd_pins pdp8/io_mb]
@@ -755,6 +767,12 @@ proc create_root_design { parentCell } {
    CONFIG.C_NUM_PERP_ARESETN {6} \
  ] $rst_ps7
 
+  # Create instance: irq_concat, and set properties
+  set irq_concat [ create_bd_cell -type ip -vlnv xilinx.com:ip:xlconcat:2.1 irq_concat ]
+  set_property -dict [ list \
+   CONFIG.NUM_PORTS {2} \
+ ] $irq_concat
+
   # Create instance: xlslice_0, and set properties
   set xlslice_0 [ create_bd_cell -type ip -vlnv xilinx.com:ip:xlslice:1.0 xlslice_0 ]
   set_property -dict [ list \
@@ -823,7 +841,9 @@ proc create_root_design { parentCell } {
   connect_bd_net -net processing_system7_0_FCLK_RESET0_N [get_bd_pins processing_system7/FCLK_RESET0_N] [get_bd_pins rst_ps7/ext_reset_in]
   connect_bd_net -net rst_ps7_peripheral_aresetn [get_bd_pins rst_ps7/peripheral_aresetn] [get_bd_pins xlslice_0/Din] [get_bd_pins xlslice_1/Din] [get_bd_pins xlslice_2/Din] [get_bd_pins xlslice_3/Din] [get_bd_pins xlslice_4/Din] [get_bd_pins xlslice_5/Din]
   connect_bd_net -net socdp8_led_row_out_0 [get_bd_ports led_row] [get_bd_pins pdp8i/led_row_out_0]
-  connect_bd_net -net socdp8_soc_irq_0 [get_bd_pins pdp8i/io_irq] [get_bd_pins processing_system7/IRQ_F2P]
+  connect_bd_net -net irq_concat_dout [get_bd_pins irq_concat/dout] [get_bd_pins processing_system7/IRQ_F2P]
+  connect_bd_net -net pdp8i_cons_irq [get_bd_pins irq_concat/In1] [get_bd_pins pdp8i/cons_irq]
+  connect_bd_net -net socdp8_soc_irq_0 [get_bd_pins irq_concat/In0] [get_bd_pins pdp8i/io_irq]
   connect_bd_net -net socdp8_switch_row_out_0 [get_bd_ports switch_row] [get_bd_pins pdp8i/switch_row_out_0]
   connect_bd_net -net xlslice_0_Dout [get_bd_pins ps7_0_axi_periph/ARESETN] [get_bd_pins ps7_0_axi_periph/S00_ARESETN] [get_bd_pins xlslice_0/Dout]
   connect_bd_net -net xlslice_1_Dout [get_bd_pins pdp8i/S_AXI_ARESETN_0] [get_bd_pins ps7_0_axi_periph/M00_ARESETN] [get_bd_pins xlslice_1/Dout]
@@ -835,7 +855,7 @@ proc create_root_design { parentCell } {
   # Create address segments
   create_bd_addr_seg -range 0x00020000 -offset 0x43C20000 [get_bd_addr_spaces processing_system7/Data] [get_bd_addr_segs pdp8i/axi_bram/S_AXI/reg0] SEG_axi_bram_0_reg0
   create_bd_addr_seg -range 0x00001000 -offset 0x43C10000 [get_bd_addr_spaces processing_system7/Data] [get_bd_addr_segs pdp8i/console_mux/S_AXI/reg0] SEG_console_mux_0_reg0
-  create_bd_addr_seg -range 0x00002000 -offset 0x43C00000 [get_bd_addr_spaces processing_system7/Data] [get_bd_addr_segs pdp8i/io_controller/S_AXI/reg0] SEG_io_controller_0_reg0
+  create_bd_addr_seg -range 0x00004000 -offset 0x43C00000 [get_bd_addr_spaces processing_system7/Data] [get_bd_addr_segs pdp8i/io_controller/S_AXI/reg0] SEG_io_controller_0_reg0
 
 
   # Restore current instance
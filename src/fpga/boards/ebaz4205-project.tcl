@@ -240,6 +240,7 @@ proc create_hier_cell_pdp8i { parentCell nameHier } {
   create_bd_pin -dir I -type rst S_AXI_ARESETN_1
   create_bd_pin -dir I -type rst S_AXI_ARESETN_2
   create_bd_pin -dir IO -from 11 -to 0 column_io_0
+  create_bd_pin -dir O -type intr cons_irq
   create_bd_pin -dir O -type intr io_irq
   create_bd_pin -dir O -from 7 -to 0 led_row_out_0
   create_bd_pin -dir I -type rst rstn_0
@@ -324,6 +325,7 @@ proc create_hier_cell_pdp8i { parentCell nameHier } {
   connect_bd_net -net S_AXI_ARESETN_1_1 [get_bd_pins S_AXI_ARESETN_1] [get_bd_pins axi_bram/S_AXI_ARESETN]
   connect_bd_net -net S_AXI_ARESETN_2_1 [get_bd_pins S_AXI_ARESETN_2] [get_bd_pins io_controller/S_AXI_ARESETN]
   connect_bd_net -net axi_bram_data_out [get_bd_pins axi_bram/data_out] [get_bd_pins pdp8/mem_in_data]
+  connect_bd_net -net console_mux_irq [get_bd_pins cons_irq] [get_bd_pins console_mux/irq]
   connect_bd_net -net console_mux_lamp_brightness_cons [get_bd_pins console_mux/lamp_brightness_cons] [get_bd_pins pidp8_console/lamp_brightness]
   connect_bd_net -net console_mux_switch_cont_pdp [get_bd_pins console_mux/switch_cont_pdp] [get_bd_pins pdp8/switch_cont]
   connect_bd_net -net console_mux_switch_data_field_pdp [get_bd_pins console_mux/switch_data_field_pdp] [get_bd_pins pdp8/switch_data_field]
@@ -345,6 +347,7 @@ proc create_hier_cell_pdp8i { parentCell nameHier } {
   connect_bd_net -net io_controller_brk_rqst [get_bd_pins io_controller/brk_rqst] [get_bd_pins pdp8/brk_rqst]
   connect_bd_net -net io_controller_brk_three_cycle [get_bd_pins io_controller/brk_three_cycle] [get_bd_pins pdp8/brk_three_cycle]
   connect_bd_net -net io_controller_conf_enable_eae [get_bd_pins io_controller/conf_enable_eae] [get_bd_pins pdp8/enable_ext_eae]
+  connect_bd_net -net io_controller_conf_enable_fast_eae [get_bd_pins io_controller/conf_enable_fast_eae] [get_bd_pins pdp8/enable_ext_fast_eae]
   connect_bd_net -net io_controller_conf_enable_kt8i [get_bd_pins io_controller/conf_enable_kt8i] [get_bd_pins pdp8/enable_ext_kt8i]
   connect_bd_net -net io_controller_conf_max_field [get_bd_pins io_controller/conf_max_field] [get_bd_pins pdp8/enable_ext_mem_fields]
   connect_bd_net -net io_controller_io_ac_clear [get_bd_pins io_controller/io_ac_clear] [get_bd_pins pdp8/io_ac_clear]
@@ -355,6 +358,15 @@ proc create_hier_cell_pdp8i { parentCell nameHier } {
   connect_bd_net -net pdp8_brk_ack [get_bd_pins io_controller/brk_ack] [get_bd_pins pdp8/brk_ack]
   connect_bd_net -net pdp8_brk_done [get_bd_pins io_controller/brk_done] [get_bd_pins pdp8/brk_done]
   connect_bd_net -net pdp8_brk_wc_overflow [get_bd_pins io_controller/brk_wc_overflow] [get_bd_pins pdp8/brk_wc_overflow]
+  connect_bd_net -net io_controller_cpu_bp_clear [get_bd_pins io_controller/cpu_bp_clear] [get_bd_pins pdp8/bp_clear]
+  connect_bd_net -net io_controller_cpu_bp_config [get_bd_pins io_controller/cpu_bp_config] [get_bd_pins pdp8/bp_config]
+  connect_bd_net -net io_controller_cpu_cont_rqst [get_bd_pins io_controller/cpu_cont_rqst] [get_bd_pins pdp8/cont_rqst]
+  connect_bd_net -net io_controller_cpu_halt_rqst [get_bd_pins io_controller/cpu_halt_rqst] [get_bd_pins pdp8/halt_rqst]
+  connect_bd_net -net io_controller_cpu_snap_load [get_bd_pins io_controller/cpu_snap_load] [get_bd_pins pdp8/snap_load]
+  connect_bd_net -net pdp8_bp_hits [get_bd_pins io_controller/cpu_bp_hits] [get_bd_pins pdp8/bp_hits]
+  connect_bd_net -net pdp8_cycle_count [get_bd_pins io_controller/cpu_cycles] [get_bd_pins pdp8/cycle_count]
+  connect_bd_net -net io_controller_cpu_snap_preload [get_bd_pins io_controller/cpu_snap_preload] [get_bd_pins pdp8/snap_preload]
+  connect_bd_net -net pdp8_snap_state [get_bd_pins io_controller/cpu_snap_state] [get_bd_pins pdp8/snap_state]
   connect_bd_net -net pdp8_io_ac [get_bd_pins io_controller/io_ac] [get_bd_pins pdp8/io_ac]
   connect_bd_net -net pdp8_io_iop [get_bd_pins io_controller/iop] [get_bd_pins pdp8/io_iop]
   connect_bd_net -net pdp8_io_mb [get_bd_pins io_controller/io_mb] [get_bd_pins pdp8/io_mb]
@@ -888,6 +900,12 @@ proc create_root_design { parentCell } {
    CONFIG.C_NUM_PERP_ARESETN {6} \
  ] $rst_ps7
 
+  # Create instance: irq_concat, and set properties
+  set irq_concat [ create_bd_cell -type ip -vlnv xilinx.com:ip:xlconcat:2.1 irq_concat ]
+  set_property -dict [ list \
+   CONFIG.NUM_PORTS {2} \
+ ] $irq_concat
+
   # Create instance: xlconcat_1, and set properties
   set xlconcat_1 [ create_bd_cell -type ip -vlnv xilinx.com:ip:xlconcat:2.1 xlconcat_1 ]
   set_property -dict [ list \
@@ -985,7 +1003,9 @@ proc create_root_design { parentCell } {
   connect_bd_net -net processing_system7_ENET0_GMII_TX_EN [get_bd_ports ENET0_GMII_TX_EN_0] [get_bd_pins processing_system7/ENET0_GMII_TX_EN]
   connect_bd_net -net rst_ps7_peripheral_aresetn [get_bd_pins rst_ps7/peripheral_aresetn] [get_bd_pins xlslice_0/Din] [get_bd_pins xlslice_1/Din] [get_bd_pins xlslice_2/Din] [get_bd_pins xlslice_3/Din] [get_bd_pins xlslice_4/Din] [get_bd_pins xlslice_5/Din]
   connect_bd_net -net socdp8_led_row_out_0 [get_bd_ports led_row] [get_bd_pins pdp8i/led_row_out_0]
-  connect_bd_net -net socdp8_soc_irq_0 [get_bd_pins pdp8i/io_irq] [get_bd_pins processing_system7/IRQ_F2P]
+  connect_bd_net -net irq_concat_dout [get_bd_pins irq_concat/dout] [get_bd_pins processing_system7/IRQ_F2P]
+  connect_bd_net -net pdp8i_cons_irq [get_bd_pins irq_concat/In1] [get_bd_pins pdp8i/cons_irq]
+  connect_bd_net -net socdp8_soc_irq_0 [get_bd_pins irq_concat/In0] [get_bd_pins pdp8i/io_irq]
   connect_bd_net -net socdp8_switch_row_out_0 [get_bd_ports switch_row] [get_bd_pins pdp8i/switch_row_out_0]
   connect_bd_net -net xlconcat_1_dout [get_bd_pins processing_system7/ENET0_GMII_RXD] [get_bd_pins xlconcat_1/dout]
   connect_bd_net -net xlconstant_0_dout [get_bd_pins xlconcat_1/In1] [get_bd_pins xlconstant_0/dout]
@@ -1000,7 +1020,7 @@ proc create_root_design { parentCell } {
   # Create address segments
   assign_bd_address -offset 0x43C20000 -range 0x00020000 -target_address_space [get_bd_addr_spaces processing_system7/Data] [get_bd_addr_segs pdp8i/axi_bram/S_AXI/reg0] -force
   assign_bd_address -offset 0x43C10000 -range 0x00001000 -target_address_space [get_bd_addr_spaces processing_system7/Data] [get_bd_addr_segs pdp8i/console_mux/S_AXI/reg0] -force
-  assign_bd_address -offset 0x43C00000 -range 0x00002000 -target_address_space [get_bd_addr_spaces processing_system7/Data] [get_bd_addr_segs pdp8i/io_controller/S_AXI/reg0] -force
+  assign_bd_address -offset 0x43C00000 -range 0x00004000 -target_address_space [get_bd_addr_spaces processing_system7/Data] [get_bd_addr_segs pdp8i/io_controller/S_AXI/reg0] -force
 
 
   # Restore current instance
@@ -36,6 +36,8 @@
 #    "/home/folko/socdp8/src/fpga/rtl/io/rf08.vhd"
 #    "/home/folko/socdp8/src/fpga/rtl/io/kw8i.vhd"
 #    "/home/folko/socdp8/src/fpga/rtl/io/rk8.vhd"
+#    "/home/folko/socdp8/src/fpga/rtl/io/rk8e.vhd"
+#    "/home/folko/socdp8/src/fpga/rtl/io/lp08.vhd"
 #    "/home/folko/socdp8/src/fpga/rtl/io/io_controller.vhd"
 #    "/home/folko/socdp8/src/fpga/rtl/ram/axi_bram.vhd"
 #    "/home/folko/socdp8/src/fpga/rtl/cpu/instructions/inst_common_package.vhd"
@@ -53,8 +55,10 @@
 #    "/home/folko/socdp8/src/fpga/rtl/cpu/instructions/eae/nmi.vhd"
 #    "/home/folko/socdp8/src/fpga/rtl/cpu/instructions/eae/shl.vhd"
 #    "/home/folko/socdp8/src/fpga/rtl/cpu/instructions/eae/lsr.vhd"
+#    "/home/folko/socdp8/src/fpga/rtl/cpu/instructions/eae/eae_fast.vhd"
 #    "/home/folko/socdp8/src/fpga/rtl/cpu/instructions/instruction_multiplexer.vhd"
 #    "/home/folko/socdp8/src/fpga/rtl/cpu/interrupt_controller.vhd"
+#    "/home/folko/socdp8/src/fpga/rtl/cpu/breakpoint_unit.vhd"
 #    "/home/folko/socdp8/src/fpga/rtl/cpu/memory_control.vhd"
 #    "/home/folko/socdp8/src/fpga/rtl/cpu/timing_manual.vhd"
 #    "/home/folko/socdp8/src/fpga/rtl/cpu/timing_auto.vhd"
@@ -186,6 +190,8 @@ set files [list \
  [file normalize "${origin_dir}/socdp8/src/fpga/rtl/io/rf08.vhd"] \
  [file normalize "${origin_dir}/socdp8/src/fpga/rtl/io/kw8i.vhd"] \
  [file normalize "${origin_dir}/socdp8/src/fpga/rtl/io/rk8.vhd"] \
+ [file normalize "${origin_dir}/socdp8/src/fpga/rtl/io/rk8e.vhd"] \
+ [file normalize "${origin_dir}/socdp8/src/fpga/rtl/io/lp08.vhd"] \
  [file normalize "${origin_dir}/socdp8/src/fpga/rtl/io/io_controller.vhd"] \
  [file normalize "${origin_dir}/socdp8/src/fpga/rtl/ram/axi_bram.vhd"] \
  [file normalize "${origin_dir}/socdp8/src/fpga/rtl/cpu/instructions/inst_common_package.vhd"] \
@@ -203,8 +209,10 @@ set files [list \
  [file normalize "${origin_dir}/socdp8/src/fpga/rtl/cpu/instructions/eae/nmi.vhd"] \
  [file normalize "${origin_dir}/socdp8/src/fpga/rtl/cpu/instructions/eae/shl.vhd"] \
  [file normalize "${origin_dir}/socdp8/src/fpga/rtl/cpu/instructions/eae/lsr.vhd"] \
+ [file normalize "${origin_dir}/socdp8/src/fpga/rtl/cpu/instructions/eae/eae_fast.vhd"] \
  [file normalize "${origin_dir}/socdp8/src/fpga/rtl/cpu/instructions/instruction_multiplexer.vhd"] \
  [file normalize "${origin_dir}/socdp8/src/fpga/rtl/cpu/interrupt_controller.vhd"] \
+ [file normalize "${origin_dir}/socdp8/src/fpga/rtl/cpu/breakpoint_unit.vhd"] \
  [file normalize "${origin_dir}/socdp8/src/fpga/rtl/cpu/memory_control.vhd"] \
  [file normalize "${origin_dir}/socdp8/src/fpga/rtl/cpu/timing_manual.vhd"] \
  [file normalize "${origin_dir}/socdp8/src/fpga/rtl/cpu/timing_auto.vhd"] \
@@ -263,6 +271,16 @@ set file [file normalize $file]
 set file_obj [get_files -of_objects [get_filesets sources_1] [list "*$file"]]
 set_property -name "file_type" -value "VHDL" -objects $file_obj
 
+set file "$origin_dir/socdp8/src/fpga/rtl/io/rk8e.vhd"
+set file [file normalize $file]
+set file_obj [get_files -of_objects [get_filesets sources_1] [list "*$file"]]
+set_property -name "file_type" -value "VHDL" -objects $file_obj
+
+set file "$origin_dir/socdp8/src/fpga/rtl/io/lp08.vhd"
+set file [file normalize $file]
+set file_obj [get_files -of_objects [get_filesets sources_1] [list "*$file"]]
+set_property -name "file_type" -value "VHDL" -objects $file_obj
+
 set file "$origin_dir/socdp8/src/fpga/rtl/io/io_controller.vhd"
 set file [file normalize $file]
 set file_obj [get_files -of_objects [get_filesets sources_1] [list "*$file"]]
@@ -348,6 +366,11 @@ set file [file normalize $file]
 set file_obj [get_files -of_objects [get_filesets sources_1] [list "*$file"]]
 set_property -name "file_type" -value "VHDL" -objects $file_obj
 
+set file "$origin_dir/socdp8/src/fpga/rtl/cpu/instructions/eae/eae_fast.vhd"
+set file [file normalize $file]
+set file_obj [get_files -of_objects [get_filesets sources_1] [list "*$file"]]
+set_property -name "file_type" -value "VHDL" -objects $file_obj
+
 set file "$origin_dir/socdp8/src/fpga/rtl/cpu/instructions/instruction_multiplexer.vhd"
 set file [file normalize $file]
 set file_obj [get_files -of_objects [get_filesets sources_1] [list "*$file"]]
@@ -358,6 +381,11 @@ set file [file normalize $file]
 set file_obj [get_files -of_objects [get_filesets sources_1] [list "*$file"]]
 set_property -name "file_type" -value "VHDL" -objects $file_obj
 
+set file "$origin_dir/socdp8/src/fpga/rtl/cpu/breakpoint_unit.vhd"
+set file [file normalize $file]
+set file_obj [get_files -of_objects [get_filesets sources_1] [list "*$file"]]
+set_property -name "file_type" -value "VHDL" -objects $file_obj
+
 set file "$origin_dir/socdp8/src/fpga/rtl/cpu/memory_control.vhd"
 set file [file normalize $file]
 set file_obj [get_files -of_objects [get_filesets sources_1] [list "*$file"]]
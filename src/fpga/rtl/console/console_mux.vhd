@@ -11,7 +11,11 @@ use work.socdp8_package.all;
 entity console_mux is
     generic(
         -- AXI parameters
-        C_S_AXI_ADDR_WIDTH: integer := 8
+        C_S_AXI_ADDR_WIDTH: integer := 8;
+
+        -- momentary keys pulsed by the host are held and then released for this time each,
+        -- the manual timing of the CPU needs at least 100 ms to debounce
+        key_pulse_time: real := 120.0e-3
     );
     port (
         -- PDP Connection
@@ -58,6 +62,9 @@ entity console_mux is
         switch_sing_step_cons: in std_logic;
         switch_sing_inst_cons: in std_logic;
 
+        -- Interrupt to the host when a switch event is queued
+        irq: out std_logic;
+
         -- AXI
         S_AXI_ACLK: in std_logic;
         S_AXI_ARESETN: in std_logic;
@@ -130,6 +137,36 @@ architecture Behavioral of console_mux is
     signal override_switches: std_logic;
     
     signal lamp_brightness: lamp_brightness_array(0 to 88);
+
+    -- Momentary key pulses requested by the host, queued as steps of a panel macro:
+    -- bits 2..0: key, 1 = START, 2 = LOAD ADD, 3 = DEP, 4 = EXAM, 5 = CONT, 6 = STOP
+    -- bit 3: set the switches below while the key is pressed and released
+    -- bits 15..4: SR, bits 18..16: DF, bits 21..19: IF
+    constant KEY_PULSE_DEPTH: natural := 8;
+    constant key_pulse_cycles: natural := period_to_cycles(clk_frq, key_pulse_time);
+    type key_pulse_queue_array is array(0 to KEY_PULSE_DEPTH - 1) of std_logic_vector(21 downto 0);
+    type key_pulse_state is (PULSE_IDLE, PULSE_PRESS, PULSE_RELEASE);
+    signal key_pulse_queue: key_pulse_queue_array;
+    signal key_pulse_head: natural range 0 to KEY_PULSE_DEPTH - 1;
+    signal key_pulse_count: natural range 0 to KEY_PULSE_DEPTH;
+    signal key_pulse_phase: key_pulse_state;
+    signal key_pulse_timer: natural range 0 to key_pulse_cycles;
+    signal key_pulse_active: std_logic_vector(2 downto 0);
+    signal key_pulse_step: std_logic_vector(21 downto 0);
+    signal key_pulse_rqst: std_logic;
+    signal key_pulse_rqst_step: std_logic_vector(21 downto 0);
+
+    -- Edges of the physical switches, each event holds the switch number and the new level.
+    -- Switch numbers: 0-2 DF, 3-5 IF, 6-17 SR, 18-25 START, LOAD, DEP, EXAM, CONT, STOP, SING STEP, SING INST
+    constant SWITCH_EVENT_DEPTH: natural := 16;
+    type switch_event_queue_array is array(0 to SWITCH_EVENT_DEPTH - 1) of std_logic_vector(5 downto 0);
+    signal switch_event_queue: switch_event_queue_array;
+    signal switch_event_head: natural range 0 to SWITCH_EVENT_DEPTH - 1;
+    signal switch_event_count: natural range 0 to SWITCH_EVENT_DEPTH;
+    signal switch_event_pop: std_logic;
+    signal switch_event_irq_enable: std_logic;
+    signal switches_cons: std_logic_vector(25 downto 0);
+    signal switches_reported: std_logic_vector(25 downto 0);
 begin
 
 lamps: entity work.lamp
@@ -177,6 +214,9 @@ begin
     --- Write ack channel
     S_AXI_BRESP <= "00";
     S_AXI_BVALID <= '0';
+
+    key_pulse_rqst <= '0';
+    switch_event_pop <= '0';
     
     case axi_state is
         when IDLE =>
@@ -220,6 +260,23 @@ begin
                 when 23 => s_axi_rdata(0) <= switch_stop_cons;
                 when 24 => s_axi_rdata(0) <= switch_sing_step_cons;
                 when 25 => s_axi_rdata(0) <= switch_sing_inst_cons;
+
+                when 26 =>
+                    if key_pulse_count /= 0 or key_pulse_phase /= PULSE_IDLE then
+                        s_axi_rdata(0) <= '1';
+                    end if;
+                    s_axi_rdata(7 downto 4) <= std_logic_vector(to_unsigned(key_pulse_count, 4));
+                when 27 =>
+                    if switch_event_count /= 0 then
+                        s_axi_rdata(31) <= '1';
+                        s_axi_rdata(4 downto 0) <= switch_event_queue(switch_event_head)(4 downto 0);
+                        s_axi_rdata(8) <= switch_event_queue(switch_event_head)(5);
+                    end if;
+                when 28 =>
+                    s_axi_rdata(0) <= switch_event_irq_enable;
+                    if switch_event_count /= 0 then
+                        s_axi_rdata(1) <= '1';
+                    end if;
                 
                 when others =>
                     if axi_addr(7) = '1' then
@@ -240,6 +297,10 @@ begin
             s_axi_rresp <= "00";
             s_axi_rvalid <= '1';
             if s_axi_rready = '1' then
+                -- reading an event removes it from the queue
+                if to_integer(unsigned(axi_addr(C_S_AXI_ADDR_WIDTH - 1 downto 2))) = 27 then
+                    switch_event_pop <= '1';
+                end if;
                 axi_state <= IDLE;
             end if;
         when WRITE =>
@@ -274,6 +335,10 @@ begin
                     when 23 => switch_stop <= s_axi_wdata(0);
                     when 24 => switch_sing_step <= s_axi_wdata(0);
                     when 25 => switch_sing_inst <= s_axi_wdata(0);
+                    when 26 =>
+                        key_pulse_rqst <= '1';
+                        key_pulse_rqst_step <= s_axi_wdata(21 downto 0);
+                    when 28 => switch_event_irq_enable <= s_axi_wdata(0);
                     when others => null;
                 end case;
             end if;
@@ -339,9 +404,105 @@ begin
         axi_state <= IDLE;
         override_leds <= '0';
         override_switches <= '0';
+        switch_event_irq_enable <= '0';
     end if;
 end process;
 
+-- Presses and releases the queued keys with the timing of a human operator
+key_pulser: process
+    variable count: natural range 0 to KEY_PULSE_DEPTH;
+begin
+    wait until rising_edge(S_AXI_ACLK);
+
+    count := key_pulse_count;
+
+    case key_pulse_phase is
+        when PULSE_IDLE =>
+            key_pulse_step(3) <= '0';
+            if count /= 0 then
+                key_pulse_step <= key_pulse_queue(key_pulse_head);
+                key_pulse_active <= key_pulse_queue(key_pulse_head)(2 downto 0);
+                key_pulse_head <= (key_pulse_head + 1) mod KEY_PULSE_DEPTH;
+                count := count - 1;
+                key_pulse_timer <= 0;
+                key_pulse_phase <= PULSE_PRESS;
+            end if;
+        when PULSE_PRESS =>
+            if key_pulse_timer = key_pulse_cycles - 1 then
+                key_pulse_active <= "000";
+                key_pulse_timer <= 0;
+                key_pulse_phase <= PULSE_RELEASE;
+            else
+                key_pulse_timer <= key_pulse_timer + 1;
+            end if;
+        when PULSE_RELEASE =>
+            if key_pulse_timer = key_pulse_cycles - 1 then
+                key_pulse_phase <= PULSE_IDLE;
+            else
+                key_pulse_timer <= key_pulse_timer + 1;
+            end if;
+    end case;
+
+    -- requests that don't fit into the queue are dropped, the host checks the fill level
+    if key_pulse_rqst = '1' and key_pulse_rqst_step(2 downto 0) /= "000" and count < KEY_PULSE_DEPTH then
+        key_pulse_queue((key_pulse_head + key_pulse_count) mod KEY_PULSE_DEPTH) <= key_pulse_rqst_step;
+        count := count + 1;
+    end if;
+
+    key_pulse_count <= count;
+
+    if S_AXI_ARESETN = '0' then
+        key_pulse_head <= 0;
+        key_pulse_count <= 0;
+        key_pulse_active <= "000";
+        key_pulse_step(3) <= '0';
+        key_pulse_phase <= PULSE_IDLE;
+    end if;
+end process;
+
+switches_cons <= switch_sing_inst_cons & switch_sing_step_cons & switch_stop_cons & switch_cont_cons &
+                 switch_exam_cons & switch_dep_cons & switch_load_cons & switch_start_cons &
+                 switch_swr_cons & switch_inst_field_cons & switch_data_field_cons;
+
+-- Queues one changed switch per cycle. A switch is only marked as reported when its event was queued,
+-- so the final state of all switches is reported even if the queue was full in between.
+switch_events: process
+    variable count: natural range 0 to SWITCH_EVENT_DEPTH;
+    variable head: natural range 0 to SWITCH_EVENT_DEPTH - 1;
+begin
+    wait until rising_edge(S_AXI_ACLK);
+
+    count := switch_event_count;
+    head := switch_event_head;
+
+    if switch_event_pop = '1' and count /= 0 then
+        head := (head + 1) mod SWITCH_EVENT_DEPTH;
+        count := count - 1;
+    end if;
+
+    if count < SWITCH_EVENT_DEPTH then
+        for i in 0 to 25 loop
+            if switches_cons(i) /= switches_reported(i) then
+                switch_event_queue((head + count) mod SWITCH_EVENT_DEPTH) <= switches_cons(i) & std_logic_vector(to_unsigned(i, 5));
+                switches_reported(i) <= switches_cons(i);
+                count := count + 1;
+                exit;
+            end if;
+        end loop;
+    end if;
+
+    switch_event_head <= head;
+    switch_event_count <= count;
+
+    if S_AXI_ARESETN = '0' then
+        switch_event_head <= 0;
+        switch_event_count <= 0;
+        switches_reported <= switches_cons;
+    end if;
+end process;
+
+irq <= '1' when switch_event_irq_enable = '1' and switch_event_count /= 0 else '0';
+
 ldf: for i in 0 to 2 generate
     lamp_brightness_cons((LAMP_DF + i + 1) * 4 - 1 downto (LAMP_DF + i) * 4) <= std_logic_vector(lamp_brightness(LAMP_DF + i));
 end generate;
@@ -388,15 +549,16 @@ lamp_brightness_cons((LAMP_ION + 1) * 4 - 1 downto LAMP_ION * 4) <= std_logic_ve
 lamp_brightness_cons((LAMP_PAUSE + 1) * 4 - 1 downto LAMP_PAUSE * 4) <= std_logic_vector(lamp_brightness(LAMP_PAUSE));
 lamp_brightness_cons((LAMP_RUN + 1) * 4 - 1 downto LAMP_RUN * 4) <= std_logic_vector(lamp_brightness(LAMP_RUN));
 
-switch_data_field_pdp <= switch_data_field;
-switch_inst_field_pdp <= switch_inst_field;
-switch_swr_pdp <= switch_swr;
-switch_start_pdp <= switch_start;
-switch_load_pdp <= switch_load;
-switch_dep_pdp <= switch_dep;
-switch_exam_pdp <= switch_exam;
-switch_cont_pdp <= switch_cont;
-switch_stop_pdp <= switch_stop;
+-- the switches of a macro step stay set until the key was released
+switch_data_field_pdp <= key_pulse_step(18 downto 16) when key_pulse_step(3) = '1' else switch_data_field;
+switch_inst_field_pdp <= key_pulse_step(21 downto 19) when key_pulse_step(3) = '1' else switch_inst_field;
+switch_swr_pdp <= key_pulse_step(15 downto 4) when key_pulse_step(3) = '1' else switch_swr;
+switch_start_pdp <= '1' when switch_start = '1' or key_pulse_active = "001" else '0';
+switch_load_pdp <= '1' when switch_load = '1' or key_pulse_active = "010" else '0';
+switch_dep_pdp <= '1' when switch_dep = '1' or key_pulse_active = "011" else '0';
+switch_exam_pdp <= '1' when switch_exam = '1' or key_pulse_active = "100" else '0';
+switch_cont_pdp <= '1' when switch_cont = '1' or key_pulse_active = "101" else '0';
+switch_stop_pdp <= '1' when switch_stop = '1' or key_pulse_active = "110" else '0';
 switch_sing_step_pdp <= switch_sing_step;
 switch_sing_inst_pdp <= switch_sing_inst;
 
@@ -0,0 +1,176 @@
+-- Part of SoCDP8, Copyright by Folke Will, 2019
+-- Licensed under CERN Open Hardware Licence v1.2
+-- See HW_LICENSE for details
+library IEEE;
+use IEEE.STD_LOGIC_1164.ALL;
+use IEEE.NUMERIC_STD.ALL;
+use work.socdp8_package.all;
+
+-- This is not part of the original PDP-8/I. It implements a bank of comparators that stop
+-- the CPU or notify the host when the CPU reaches a point of interest.
+--
+-- Each comparator is configured by a 32 bit word in config:
+--  bits 14..0: value to compare, field and address (14..12, 11..0), AC (11..0) or IOT device (5..0)
+--  bits 18..16: type, see BP_* below
+--  bit 20: halt on hit
+--  bit 21: interrupt on hit, evaluated by the I/O controller
+--
+-- PC and AC comparators are checked when the next cycle would be a fetch. On a hit,
+-- the CPU stops before fetching the instruction, so PC shows the breakpoint address.
+-- Memory and IOT comparators stop the CPU after the instruction that caused the hit.
+-- Each hit sets a sticky bit in hits that stays set until it is cleared.
+entity breakpoint_unit is
+    port (
+        clk: in std_logic;
+        rstn: in std_logic;
+
+        -- Configuration and hits
+        config: in std_logic_vector(127 downto 0);
+        hits: out std_logic_vector(3 downto 0);
+        hit_clear: in std_logic_vector(3 downto 0);
+
+        -- CPU state
+        run: in std_logic;
+        ts: in time_state_auto;
+        tp: in std_logic;
+        state: in major_state;
+        state_next: in major_state;
+        inst: in pdp8_instruction;
+        auto_index: in std_logic;
+        brk_data_in: in std_logic;
+        pc: in std_logic_vector(11 downto 0);
+        skip: in std_logic;
+        inst_field: in std_logic_vector(2 downto 0);
+        ma: in std_logic_vector(11 downto 0);
+        field: in std_logic_vector(2 downto 0);
+        mb: in std_logic_vector(11 downto 0);
+        ac: in std_logic_vector(11 downto 0);
+
+        -- stop before the next fetch, this must hold back TP4
+        stop_now: out std_logic;
+
+        -- stop at the end of the current instruction, works like the STOP switch
+        halt_rqst: out std_logic
+    );
+end breakpoint_unit;
+
+architecture Behavioral of breakpoint_unit is
+    constant BP_OFF: natural := 0;
+    constant BP_PC: natural := 1;
+    constant BP_MEM_READ: natural := 2;
+    constant BP_MEM_WRITE: natural := 3;
+    constant BP_MEM_ACCESS: natural := 4;
+    constant BP_AC: natural := 5;
+    constant BP_IOT: natural := 6;
+
+    -- the instruction is done and the next cycle will be a fetch
+    signal boundary: std_logic;
+    -- the memory cycle reads or writes data
+    signal mem_read, mem_write: std_logic;
+    signal next_fetch: std_logic_vector(14 downto 0);
+    signal cur_addr: std_logic_vector(14 downto 0);
+
+    -- combinatorial matches
+    signal match_boundary: std_logic_vector(3 downto 0);
+    signal match_mem: std_logic_vector(3 downto 0);
+    signal match_iot: std_logic_vector(3 downto 0);
+
+    signal hits_int: std_logic_vector(3 downto 0);
+    signal halt_pending: std_logic;
+begin
+
+boundary <= '1' when run = '1' and ts = TS4 and state /= STATE_NONE and state_next = STATE_FETCH else '0';
+
+mem_read <= '1' when state = STATE_DEFER or state = STATE_ADDR or
+                     (state = STATE_EXEC and (inst = INST_AND or inst = INST_TAD or inst = INST_ISZ)) or
+                     (state = STATE_BREAK and brk_data_in = '0')
+            else '0';
+
+mem_write <= '1' when state = STATE_COUNT or
+                      (state = STATE_DEFER and auto_index = '1') or
+                      (state = STATE_EXEC and (inst = INST_DCA or inst = INST_ISZ or inst = INST_JMS)) or
+                      (state = STATE_BREAK and brk_data_in = '1')
+             else '0';
+
+next_fetch <= inst_field & std_logic_vector(unsigned(pc) + 1) when skip = '1' else inst_field & pc;
+cur_addr <= field & ma;
+
+gen_match: for i in 0 to 3 generate
+    signal bp_type: natural range 0 to 7;
+    signal value: std_logic_vector(14 downto 0);
+begin
+    bp_type <= to_integer(unsigned(config(i * 32 + 18 downto i * 32 + 16)));
+    value <= config(i * 32 + 14 downto i * 32);
+
+    match_boundary(i) <= '1' when boundary = '1' and
+                            ((bp_type = BP_PC and next_fetch = value) or
+                             (bp_type = BP_AC and ac = value(11 downto 0)))
+                         else '0';
+
+    match_mem(i) <= '1' when cur_addr = value and
+                       ((bp_type = BP_MEM_READ and mem_read = '1') or
+                        (bp_type = BP_MEM_WRITE and mem_write = '1') or
+                        (bp_type = BP_MEM_ACCESS and (mem_read = '1' or mem_write = '1')))
+                    else '0';
+
+    match_iot(i) <= '1' when bp_type = BP_IOT and state = STATE_FETCH and inst = INST_IOT and mb(8 downto 3) = value(5 downto 0)
+                    else '0';
+end generate;
+
+-- The IOT is decoded in TS3, the same pulse decides whether run stays set
+stop_logic: process(match_boundary, match_iot, config, ts, halt_pending)
+    variable stop, halt: std_logic;
+begin
+    stop := '0';
+    halt := halt_pending;
+    for i in 0 to 3 loop
+        if config(i * 32 + 20) = '1' then
+            stop := stop or match_boundary(i);
+            if ts = TS3 then
+                halt := halt or match_iot(i);
+            end if;
+        end if;
+    end loop;
+    stop_now <= stop;
+    halt_rqst <= halt;
+end process;
+
+record_hits: process
+begin
+    wait until rising_edge(clk);
+
+    for i in 0 to 3 loop
+        if match_boundary(i) = '1' then
+            hits_int(i) <= '1';
+        end if;
+
+        if ts = TS2 and tp = '1' and match_mem(i) = '1' then
+            hits_int(i) <= '1';
+            if config(i * 32 + 20) = '1' then
+                halt_pending <= '1';
+            end if;
+        end if;
+
+        if ts = TS3 and tp = '1' and match_iot(i) = '1' then
+            hits_int(i) <= '1';
+        end if;
+
+        if hit_clear(i) = '1' then
+            hits_int(i) <= '0';
+        end if;
+    end loop;
+
+    -- the halt request is done once the CPU stopped
+    if run = '0' then
+        halt_pending <= '0';
+    end if;
+
+    if rstn = '0' then
+        hits_int <= (others => '0');
+        halt_pending <= '0';
+    end if;
+end process;
+
+hits <= hits_int;
+
+end Behavioral;
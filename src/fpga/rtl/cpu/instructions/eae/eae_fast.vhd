@@ -0,0 +1,117 @@
+-- Part of SoCDP8, Copyright by Folke Will, 2019
+-- Licensed under CERN Open Hardware Licence v1.2
+-- See HW_LICENSE for details
+library IEEE;
+use IEEE.STD_LOGIC_1164.ALL;
+use IEEE.NUMERIC_STD.ALL;
+
+use work.socdp8_package.all;
+
+-- This entity computes MUY and DVI in a few clock cycles instead of stepping through
+-- the mechanization charts. The results, including SC and L, are identical to the ones
+-- of inst_muy and inst_dvi:
+-- MUY: AC:MQ <- MQ * MEM + AC, 0 -> L, 11 -> SC
+-- DVI: MQ <- AC:MQ / MEM, AC <- remainder, 0 -> L, 13 -> SC
+--      If MEM <= AC, the quotient doesn't fit and the overflow step is executed instead:
+--      AC <- MEM - AC - 1, L <- not L, MQ and SC (cleared by the execute cycle) are kept
+-- The multiplication is mapped to a DSP slice, the division uses one clock per quotient bit.
+entity eae_fast is
+    port (
+        clk: in std_logic;
+        rstn: in std_logic;
+
+        start: in std_logic;
+        inst: in eae_instruction;
+        ac: in std_logic_vector(11 downto 0);
+        link: in std_logic;
+        mqr: in std_logic_vector(11 downto 0);
+        mb: in std_logic_vector(11 downto 0);
+
+        done: out std_logic;
+        ac_o: out std_logic_vector(11 downto 0);
+        link_o: out std_logic;
+        mqr_o: out std_logic_vector(11 downto 0);
+        sc_o: out std_logic_vector(4 downto 0)
+    );
+end eae_fast;
+
+architecture Behavioral of eae_fast is
+    type fast_state is (IDLE, MUY_MUL, MUY_DONE, DVI_STEP, DVI_DONE);
+    signal state: fast_state;
+
+    signal product: unsigned(23 downto 0);
+    signal remain: unsigned(12 downto 0);
+    signal quotient: unsigned(11 downto 0);
+    signal divisor: unsigned(11 downto 0);
+    signal steps: natural range 0 to 11;
+begin
+
+fast_eae: process
+    variable shifted: unsigned(12 downto 0);
+begin
+    wait until rising_edge(clk);
+
+    done <= '0';
+
+    case state is
+        when IDLE =>
+            if start = '1' and inst = EAE_MUY then
+                state <= MUY_MUL;
+            elsif start = '1' and inst = EAE_DVI then
+                if unsigned(mb) <= unsigned(ac) then
+                    ac_o <= std_logic_vector(unsigned(mb) - unsigned(ac) - 1);
+                    link_o <= not link;
+                    mqr_o <= mqr;
+                    sc_o <= "00000";
+                    done <= '1';
+                else
+                    remain <= '0' & unsigned(ac);
+                    quotient <= unsigned(mqr);
+                    divisor <= unsigned(mb);
+                    steps <= 0;
+                    state <= DVI_STEP;
+                end if;
+            end if;
+        when MUY_MUL =>
+            -- registered input and output so this maps to a DSP48 with its post-adder
+            product <= unsigned(mqr) * unsigned(mb) + resize(unsigned(ac), 24);
+            state <= MUY_DONE;
+        when MUY_DONE =>
+            ac_o <= std_logic_vector(product(23 downto 12));
+            mqr_o <= std_logic_vector(product(11 downto 0));
+            link_o <= '0';
+            sc_o <= "01011";
+            done <= '1';
+            state <= IDLE;
+        when DVI_STEP =>
+            -- restoring division, the dividend bits are shifted out of the quotient register
+            shifted := remain(11 downto 0) & quotient(11);
+            if shifted >= ('0' & divisor) then
+                remain <= shifted - ('0' & divisor);
+                quotient <= quotient(10 downto 0) & '1';
+            else
+                remain <= shifted;
+                quotient <= quotient(10 downto 0) & '0';
+            end if;
+
+            if steps = 11 then
+                state <= DVI_DONE;
+            else
+                steps <= steps + 1;
+            end if;
+        when DVI_DONE =>
+            ac_o <= std_logic_vector(remain(11 downto 0));
+            mqr_o <= std_logic_vector(quotient);
+            link_o <= '0';
+            sc_o <= "01101";
+            done <= '1';
+            state <= IDLE;
+    end case;
+
+    if rstn = '0' then
+        state <= IDLE;
+        done <= '0';
+    end if;
+end process;
+
+end Behavioral;
@@ -24,6 +24,12 @@ entity interrupt_controller is
         -- State output
         int_enable: out std_logic;
         int_ok: out std_logic;
+        int_delay_o: out std_logic;
+
+        -- Snapshot preload while halted
+        preload: in std_logic;
+        preload_enable: in std_logic;
+        preload_delay: in std_logic;
 
         -- Various state signals
         ts: in time_state_auto;
@@ -104,6 +110,11 @@ begin
     if manual_preset = '1' then
         int_sync <= '0';
     end if;
+
+    if preload = '1' then
+        int_enable_int <= preload_enable;
+        int_delay <= preload_delay;
+    end if;
     
     if rstn = '0' then
         int_sync <= '0';
@@ -115,6 +126,7 @@ end process;
 int_ok_int <= int_sync and int_delay and not int_inhibit;
 int_ok <= int_ok_int;
 
-int_enable <= int_enable_int; 
+int_enable <= int_enable_int;
+int_delay_o <= int_delay;
 
 end Behavioral;
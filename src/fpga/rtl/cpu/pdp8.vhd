@@ -20,6 +20,7 @@ entity pdp8 is
         enable_ext_eae: in std_logic;
         enable_ext_kt8i: in std_logic;
         enable_ext_mem_fields: in std_logic_vector(2 downto 0);
+        enable_ext_fast_eae: in std_logic := '0'; -- MUY and DVI in a few clocks, see eae_fast.vhd
         
         -- I/O connections
         io_bus_in: in std_logic_vector(11 downto 0);
@@ -55,6 +56,30 @@ entity pdp8 is
         brk_ack: out std_logic;
         brk_done: out std_logic;
 
+        -- Snapshot connections
+        -- snap_state always shows the current CPU state. If snap_load is pulsed while
+        -- the CPU is halted, the state is replaced by snap_preload. For the layout, see
+        -- the snapshot registers in io_controller.vhd.
+        snap_state: out std_logic_vector(127 downto 0);
+        snap_preload: in std_logic_vector(127 downto 0) := (others => '0');
+        snap_load: in std_logic := '0';
+
+        -- Halt request: Works like the STOP switch, halting is acknowledged by run going low
+        halt_rqst: in std_logic := '0';
+
+        -- Continue request: Works like the CONT key but without the debounced manual timing.
+        -- It is only accepted while the CPU is halted at the end of a cycle.
+        cont_rqst: in std_logic := '0';
+
+        -- Breakpoint connections, see breakpoint_unit.vhd for the layout of bp_config.
+        -- bp_hits are sticky and cleared by pulsing the corresponding bit in bp_clear.
+        bp_config: in std_logic_vector(127 downto 0) := (others => '0');
+        bp_clear: in std_logic_vector(3 downto 0) := (others => '0');
+        bp_hits: out std_logic_vector(3 downto 0);
+
+        -- Free-running count of memory cycles, used as time base by the peripherals
+        cycle_count: out std_logic_vector(31 downto 0);
+
         -- to be connected to RAM
         mem_out_addr: out std_logic_vector(14 downto 0);
         mem_out_data: out std_logic_vector(11 downto 0);
@@ -188,6 +213,24 @@ architecture Behavioral of pdp8 is
     --- from interrupt controller
     signal int_ok: std_logic;
     signal int_enable: std_logic;
+    signal int_delay: std_logic;
+    --- snapshots
+    signal reg_state: register_state;
+    signal preload_state: register_state;
+    signal snap_apply: std_logic;
+    --- fast EAE
+    signal eae_fast_start: std_logic;
+    signal eae_fast_done: std_logic;
+    signal eae_fast_ac: std_logic_vector(11 downto 0);
+    signal eae_fast_link: std_logic;
+    signal eae_fast_mqr: std_logic_vector(11 downto 0);
+    signal eae_fast_sc: std_logic_vector(4 downto 0);
+    --- time base
+    signal cycles: unsigned(31 downto 0);
+    --- breakpoints
+    signal bp_stop: std_logic;
+    signal bp_halt: std_logic;
+    signal run_timing: std_logic;
 begin
 
 manual_timing_inst: entity work.timing_manual
@@ -224,7 +267,7 @@ port map (
     strobe => strobe,
     mem_done => mem_done,
     manual_preset => manual_preset,
-    run => run,
+    run => run_timing,
     pause => pause,
     force_tp4 => force_tp4,
     
@@ -280,7 +323,36 @@ port map (
     df_o => mc8_df,
     if_o => mc8_if,
     wc_ovf_o => brk_wc_overflow,
-    kt8i_uf_o => kt8i_uf
+    kt8i_uf_o => kt8i_uf,
+
+    state_o => reg_state,
+    preload => snap_apply,
+    preload_state => preload_state,
+
+    eae_load => eae_fast_done,
+    eae_ac => eae_fast_ac,
+    eae_link => eae_fast_link,
+    eae_mqr => eae_fast_mqr,
+    eae_sc => eae_fast_sc
+);
+
+eae_fast_inst: entity work.eae_fast
+port map (
+    clk => clk,
+    rstn => rstn,
+
+    start => eae_fast_start,
+    inst => eae_inst,
+    ac => ac,
+    link => link,
+    mqr => mqr,
+    mb => mb,
+
+    done => eae_fast_done,
+    ac_o => eae_fast_ac,
+    link_o => eae_fast_link,
+    mqr_o => eae_fast_mqr,
+    sc_o => eae_fast_sc
 );
 
 mem_control: entity work.memory_control
@@ -350,6 +422,11 @@ port map (
     
     int_enable => int_enable,
     int_ok => int_ok,
+    int_delay_o => int_delay,
+
+    preload => snap_apply,
+    preload_enable => snap_preload(102),
+    preload_delay => snap_preload(103),
 
     ts => ts,
     tp => tp,
@@ -366,6 +443,38 @@ port map (
     kt8i_uf => kt8i_uf
 );
 
+breakpoints: entity work.breakpoint_unit
+port map (
+    clk => clk,
+    rstn => rstn,
+
+    config => bp_config,
+    hits => bp_hits,
+    hit_clear => bp_clear,
+
+    run => run,
+    ts => ts,
+    tp => tp,
+    state => state,
+    state_next => next_state_inst,
+    inst => inst,
+    auto_index => auto_index,
+    brk_data_in => brk_data_in,
+    pc => pc,
+    skip => skip,
+    inst_field => mc8_if,
+    ma => ma,
+    field => field,
+    mb => mb,
+    ac => ac,
+
+    stop_now => bp_stop,
+    halt_rqst => bp_halt
+);
+
+-- A breakpoint that stops before the next fetch holds back TP4 just like a cleared run FF
+run_timing <= run and not bp_stop;
+
 mftp2 <= '1' when mft = MFT2 and mftp = '1' else '0';
 auto_index <= '1' when state = STATE_DEFER and ma(11 downto 3) = o"001" else '0';
 norm <= '1' when (ac(11) /= ac(10)) or (mqr = o"0000" and ac(9 downto 0) = "0000000000") else '0';
@@ -392,6 +501,7 @@ begin
     io_start <= '0';
     eae_start <= '0';
     eae_end <= '0';
+    eae_fast_start <= '0';
 
     --- registers
     reg_trans <= nop_transfer;
@@ -489,8 +599,8 @@ begin
                     run <= '0';
                 end if;
                 
-                --- c) the STOP and SING INST switches disable run but only if the next cycle would be fetch
-                if (next_state_inst = STATE_FETCH or state = STATE_NONE) and (switch_sing_inst = '1' or switch_stop = '1') then
+                --- c) the STOP and SING INST switches and the halt request disable run but only if the next cycle would be fetch
+                if (next_state_inst = STATE_FETCH or state = STATE_NONE) and (switch_sing_inst = '1' or switch_stop = '1' or halt_rqst = '1' or bp_halt = '1') then
                     run <= '0';
                 end if;
                 
@@ -510,7 +620,11 @@ begin
                 
                 if reg_trans_inst.eae_set = '1' then
                     pause <= '1';
-                    eae_start <= '1';
+                    if enable_ext_fast_eae = '1' and (eae_inst = EAE_MUY or eae_inst = EAE_DVI) then
+                        eae_fast_start <= '1';
+                    else
+                        eae_start <= '1';
+                    end if;
                 end if;
                 
                 -- MC8 are part of TS3
@@ -614,6 +728,11 @@ begin
                 reg_trans <= reg_trans_inst;
             end if;
         when TS4 =>
+            -- A breakpoint hit before the next fetch ends up in the same state as a cleared run FF
+            if bp_stop = '1' then
+                run <= '0';
+            end if;
+
             -- If run was set to 0 in TS3, this pulse will not happen until CONT is pressed.
             -- Pressing START will go to TS1 without this pulse! 
             if tp = '1' then
@@ -690,6 +809,33 @@ begin
             null;
     end case;
 
+    -- The continue request does what MFT2 does for the CONT key so that the host can step quickly
+    if cont_rqst = '1' and run = '0' and ts = TS4 and mfts0 = '0' then
+        mem_start <= '1';
+        force_tp4 <= '1';
+    end if;
+
+    -- The fast EAE result is loaded into AC, L, MQ and SC by the registers
+    if eae_fast_done = '1' then
+        pause <= '0';
+    end if;
+
+    -- Restoring a snapshot replaces the state of the halted CPU so that CONT continues
+    -- exactly where the snapshot was taken.
+    if snap_apply = '1' then
+        int_inhibit <= snap_preload(104);
+        kt8i_uint <= snap_preload(105);
+        deferred <= snap_preload(106);
+        -- the field can hold one value more than there are states
+        if to_integer(unsigned(snap_preload(109 downto 107))) > major_state'pos(major_state'high) then
+            state <= STATE_FETCH;
+        else
+            state <= major_state'val(to_integer(unsigned(snap_preload(109 downto 107))));
+        end if;
+        inst <= pdp8_instruction'val(to_integer(unsigned(snap_preload(112 downto 110))));
+        eae_inst <= eae_instruction'val(to_integer(unsigned(snap_preload(115 downto 113))));
+    end if;
+
     if rstn = '0' then
         state <= STATE_NONE;
         inst <= INST_AND; -- all zero = AND
@@ -703,6 +849,74 @@ begin
     end if;
 end process;
 
+snap_apply <= snap_load and not run;
+
+-- every memory cycle ends with TP4, including break cycles
+count_cycles: process
+begin
+    wait until rising_edge(clk);
+
+    if ts = TS4 and tp = '1' then
+        cycles <= cycles + 1;
+    end if;
+
+    if rstn = '0' then
+        cycles <= (others => '0');
+    end if;
+end process;
+cycle_count <= std_logic_vector(cycles);
+
+preload_state <= (
+        ac => snap_preload(11 downto 0),
+        link => snap_preload(12),
+        mqr => snap_preload(27 downto 16),
+        pc => snap_preload(43 downto 32),
+        inst_field => snap_preload(46 downto 44),
+        inst_buf => snap_preload(49 downto 47),
+        data_field => snap_preload(52 downto 50),
+        save_field => snap_preload(58 downto 53),
+        user_field => snap_preload(59),
+        user_buf => snap_preload(60),
+        save_user_field => snap_preload(61),
+        ma => snap_preload(75 downto 64),
+        mb => snap_preload(91 downto 80),
+        sc => snap_preload(100 downto 96),
+        skip => snap_preload(101)
+    );
+
+snap_state(11 downto 0) <= reg_state.ac;
+snap_state(12) <= reg_state.link;
+snap_state(15 downto 13) <= (others => '0');
+snap_state(27 downto 16) <= reg_state.mqr;
+snap_state(31 downto 28) <= (others => '0');
+snap_state(43 downto 32) <= reg_state.pc;
+snap_state(46 downto 44) <= reg_state.inst_field;
+snap_state(49 downto 47) <= reg_state.inst_buf;
+snap_state(52 downto 50) <= reg_state.data_field;
+snap_state(58 downto 53) <= reg_state.save_field;
+snap_state(59) <= reg_state.user_field;
+snap_state(60) <= reg_state.user_buf;
+snap_state(61) <= reg_state.save_user_field;
+snap_state(63 downto 62) <= (others => '0');
+snap_state(75 downto 64) <= reg_state.ma;
+snap_state(79 downto 76) <= (others => '0');
+snap_state(91 downto 80) <= reg_state.mb;
+snap_state(95 downto 92) <= (others => '0');
+snap_state(100 downto 96) <= reg_state.sc;
+snap_state(101) <= reg_state.skip;
+snap_state(102) <= int_enable;
+snap_state(103) <= int_delay;
+snap_state(104) <= int_inhibit;
+snap_state(105) <= kt8i_uint;
+snap_state(106) <= deferred;
+snap_state(109 downto 107) <= std_logic_vector(to_unsigned(major_state'pos(state), 3));
+snap_state(112 downto 110) <= std_logic_vector(to_unsigned(pdp8_instruction'pos(inst), 3));
+snap_state(115 downto 113) <= std_logic_vector(to_unsigned(eae_instruction'pos(eae_inst), 3));
+snap_state(116) <= run;
+snap_state(117) <= pause;
+snap_state(119 downto 118) <= std_logic_vector(to_unsigned(time_state_auto'pos(ts), 2));
+snap_state(127 downto 120) <= (others => '0');
+
 io_iop_tmp(0) <= '1' when ios = IO1 and mb(0) = '1' else '0';
 io_iop_tmp(1) <= '1' when ios = IO2 and mb(1) = '1' else '0';
 io_iop_tmp(2) <= '1' when ios = IO4 and mb(2) = '1' else '0';
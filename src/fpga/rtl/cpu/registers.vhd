@@ -50,6 +50,18 @@ entity registers is
         wc_ovf_o: out std_logic;
         kt8i_uf_o: out std_logic;
 
+        -- snapshot: complete register state and preload, only to be used while the CPU is halted
+        state_o: out register_state;
+        preload: in std_logic;
+        preload_state: in register_state;
+
+        -- result of the fast EAE, only replaces AC, L, MQ and SC
+        eae_load: in std_logic;
+        eae_ac: in std_logic_vector(11 downto 0);
+        eae_link: in std_logic;
+        eae_mqr: in std_logic_vector(11 downto 0);
+        eae_sc: in std_logic_vector(4 downto 0);
+
         -- instruction decoder (combinatorial)
         inst_o: out pdp8_instruction;
         eae_inst_o: out eae_instruction
@@ -380,6 +392,31 @@ begin
         end if;
     end if;
 
+    if preload = '1' then
+        ac <= preload_state.ac;
+        link <= preload_state.link;
+        pc <= preload_state.pc;
+        mem_addr <= preload_state.ma;
+        mem_buf <= preload_state.mb;
+        mqr <= preload_state.mqr;
+        sc <= preload_state.sc;
+        skip <= preload_state.skip;
+        mc8_if <= preload_state.inst_field;
+        mc8_ib <= preload_state.inst_buf;
+        mc8_df <= preload_state.data_field;
+        mc8_sf <= preload_state.save_field;
+        kt8i_uf <= preload_state.user_field;
+        kt8i_ub <= preload_state.user_buf;
+        kt8i_suf <= preload_state.save_user_field;
+    end if;
+
+    if eae_load = '1' then
+        ac <= eae_ac;
+        link <= eae_link;
+        mqr <= eae_mqr;
+        sc <= eae_sc;
+    end if;
+
     if enable_eae = '0' then
         mqr <= (others => '0');
         sc <= (others => '0');
@@ -418,6 +455,23 @@ df_o <= mc8_df;
 if_o <= mc8_if;
 wc_ovf_o <= wc_ovf;
 kt8i_uf_o <= kt8i_uf;
+state_o <= (
+        ac => ac,
+        link => link,
+        pc => pc,
+        ma => mem_addr,
+        mb => mem_buf,
+        mqr => mqr,
+        sc => sc,
+        skip => skip,
+        inst_field => mc8_if,
+        inst_buf => mc8_ib,
+        data_field => mc8_df,
+        save_field => mc8_sf,
+        user_field => kt8i_uf,
+        user_buf => kt8i_ub,
+        save_user_field => kt8i_suf
+    );
 carry_o <= '1' when unsigned(mem_buf) <= unsigned(ac) else '0';
 
 with sense(11 downto 9) select inst_o <=
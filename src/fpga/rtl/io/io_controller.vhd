@@ -11,7 +11,7 @@ use work.socdp8_package.all;
 entity io_controller is
     generic(
         -- AXI parameters
-        C_S_AXI_ADDR_WIDTH: integer := 13;
+        C_S_AXI_ADDR_WIDTH: integer := 14;
         num_uarts: natural := 2
     );
     port (
@@ -51,6 +51,7 @@ entity io_controller is
         -- PDP-8 configuration output
         conf_enable_eae: out std_logic;
         conf_enable_kt8i: out std_logic;
+        conf_enable_fast_eae: out std_logic;
         conf_max_field: out std_logic_vector(2 downto 0);
 
         -- I/O connections to PDP-8
@@ -73,6 +74,19 @@ entity io_controller is
         brk_wc_overflow: in std_logic;
         brk_ack: in std_logic;
         brk_done: in std_logic;
+
+        -- Snapshot connections to PDP-8
+        cpu_snap_state: in std_logic_vector(127 downto 0);
+        cpu_snap_preload: out std_logic_vector(127 downto 0);
+        cpu_snap_load: out std_logic;
+        cpu_halt_rqst: out std_logic;
+        cpu_cont_rqst: out std_logic;
+        cpu_cycles: in std_logic_vector(31 downto 0);
+
+        -- Breakpoint connections to PDP-8
+        cpu_bp_config: out std_logic_vector(127 downto 0);
+        cpu_bp_clear: out std_logic_vector(3 downto 0);
+        cpu_bp_hits: in std_logic_vector(3 downto 0);
         
         -- UARTs
         uart_rx: in std_logic_vector(num_uarts - 1 downto 0);
@@ -83,8 +97,9 @@ entity io_controller is
         -- PDP-8 interrupt line
         pdp_irq: out std_logic;
         
-        -- The I/O controller generates an interrupt whenever a device has a pending transfer.
-        -- Address 0 can be read to see which of the devices is pending.
+        -- The I/O controller generates an interrupt whenever a breakpoint with the interrupt bit
+        -- was hit. Register 15 on bus 0 can be read to see which of the breakpoints was hit.
+        -- The interrupt is also active while the register event FIFO is not empty.
         soc_irq: out std_logic
     );
 
@@ -95,11 +110,15 @@ architecture Behavioral of io_controller is
     type axi_state is (IDLE, READ_WAIT, READ, WRITE_WAIT, WRITE, WRITE_ACK);
     signal state: axi_state;
     signal axi_in_table: std_logic;
+    signal axi_in_brk: std_logic;
+    signal axi_in_burst: std_logic;
+    signal axi_burst_index: integer range 0 to 255;
     signal axi_bus_id: integer range 0 to 63;
     signal axi_dev_reg: integer range 0 to 15;
 
     signal enable_eae: std_logic;
     signal enable_kt8i: std_logic;
+    signal enable_fast_eae: std_logic;
     signal max_mem_field: std_logic_vector(2 downto 0);
 
     type bus_to_dev_a is array(0 to 63) of integer range 0 to DEV_ID_COUNT - 1;
@@ -127,34 +146,107 @@ architecture Behavioral of io_controller is
     
     signal peripheral_out: peripheral_out_a;
     
-    -- data break
+    -- data break slots, one per device ID. The slot of DEV_ID_NULL is used by the system registers.
+    type brk_slot_rec is record
+        data: std_logic_vector(11 downto 0);
+        data_add: std_logic_vector(11 downto 0);
+        data_ext: std_logic_vector(2 downto 0);
+        data_in: std_logic;
+        mb_inc: std_logic;
+        ca_inc: std_logic;
+        three_cycle: std_logic;
+        priority: unsigned(1 downto 0);
+        pending: std_logic; -- requested but not passed to the CPU yet
+        ready: std_logic;   -- reply is valid
+        mb: std_logic_vector(11 downto 0);
+        wc_ovf: std_logic;
+    end record;
+    type brk_slot_a is array(0 to DEV_ID_COUNT - 1) of brk_slot_rec;
+    signal brk_slots: brk_slot_a;
+
+    -- the granted slot drives the break signals until the break is done
+    signal bk_slot: integer range 0 to DEV_ID_COUNT - 1;
+    signal bk_active: std_logic;
     signal bk_rqst: std_logic;
-    signal bk_three_cycle: std_logic;
-    signal bk_ca_inc: std_logic;
-    signal bk_mb_inc: std_logic;
-    signal bk_data_in: std_logic;
-    signal bk_data_add: std_logic_vector(11 downto 0);
-    signal bk_data_ext: std_logic_vector(2 downto 0);
-    signal bk_data: std_logic_vector(11 downto 0);
-    signal bk_ready: std_logic; 
-    
-    signal bk_mb: std_logic_vector(11 downto 0);
-    signal bk_wc_ovf: std_logic;
+
+    -- data break burst: the words of a block are passed through one slot without the host
+    constant BURST_SIZE: natural := 256;
+    type burst_buf_a is array(0 to BURST_SIZE - 1) of std_logic_vector(11 downto 0);
+    signal burst_buf: burst_buf_a;
+    signal burst_slot: integer range 0 to DEV_ID_COUNT - 1;
+    signal burst_active: std_logic;
+    signal burst_wait: std_logic;   -- the current word was requested
+    signal burst_index: integer range 0 to BURST_SIZE;
+    signal burst_count: integer range 0 to BURST_SIZE;
+
+    -- CPU snapshot
+    signal snap_preload: std_logic_vector(127 downto 0);
+    signal snap_load: std_logic;
+    signal halt_rqst: std_logic;
+    signal cont_rqst: std_logic;
+    signal cont_pending: std_logic;
+
+    -- CPU breakpoints
+    signal bp_config: std_logic_vector(127 downto 0);
+    signal bp_clear: std_logic_vector(3 downto 0);
+    signal bp_irq: std_logic_vector(3 downto 0);
+
+    -- register events: changes of watched device registers caused by IOTs
+    constant EVT_ROW: natural := 63;
+    constant EVT_NUM_REGS: natural := 7; -- registers 1 to 7 can be watched
+    constant EVT_FIFO_DEPTH: natural := 64;
+    type evt_mask_a is array(0 to DEV_ID_COUNT - 1) of std_logic_vector(EVT_NUM_REGS downto 1);
+    type evt_regs_a is array(1 to EVT_NUM_REGS) of std_logic_vector(15 downto 0);
+    type evt_shadow_a is array(0 to DEV_ID_COUNT - 1) of evt_regs_a;
+    type evt_fifo_a is array(0 to EVT_FIFO_DEPTH - 1) of std_logic_vector(63 downto 0);
+    signal evt_mask: evt_mask_a;
+    signal evt_shadow: evt_shadow_a;    -- last reported value of each register
+    signal evt_check: std_logic_vector(DEV_ID_COUNT - 1 downto 0);
+    signal evt_scan: std_logic;
+    signal evt_dev: integer range 0 to DEV_ID_COUNT - 1;
+    signal evt_reg: integer range 1 to EVT_NUM_REGS;
+    signal evt_snoop: std_logic;
+    signal evt_fifo: evt_fifo_a;
+    signal evt_head: unsigned(5 downto 0);
+    signal evt_tail: unsigned(5 downto 0);
+    signal evt_count: integer range 0 to EVT_FIFO_DEPTH;
+    signal evt_overflow: std_logic;
+    signal iop_last: io_state;
+
+    -- CPU time base
+    signal cycles_last: std_logic_vector(31 downto 0);
+    signal cycle_tick: std_logic;
 begin
 
 brk_rqst <= bk_rqst;
-brk_three_cycle <= bk_three_cycle;
-brk_ca_inc <= bk_ca_inc;
-brk_mb_inc <= bk_mb_inc;
-brk_data_in <= bk_data_in;
-brk_data_add <= bk_data_add;
-brk_data_ext <= bk_data_ext;
-brk_data <= bk_data; 
+brk_three_cycle <= brk_slots(bk_slot).three_cycle;
+brk_ca_inc <= brk_slots(bk_slot).ca_inc;
+brk_mb_inc <= brk_slots(bk_slot).mb_inc;
+brk_data_in <= brk_slots(bk_slot).data_in;
+brk_data_add <= brk_slots(bk_slot).data_add;
+brk_data_ext <= brk_slots(bk_slot).data_ext;
+brk_data <= brk_slots(bk_slot).data;
+
+cpu_snap_preload <= snap_preload;
+cpu_snap_load <= snap_load;
+cpu_halt_rqst <= halt_rqst;
+cpu_cont_rqst <= cont_rqst;
+
+cpu_bp_config <= bp_config;
+cpu_bp_clear <= bp_clear;
+gen_bp_irq: for i in 0 to 3 generate
+    bp_irq(i) <= cpu_bp_hits(i) and bp_config(i * 32 + 21);
+end generate;
+soc_irq <= '1' when bp_irq /= "0000" or evt_count /= 0 else '0';
+
+cycles_last <= cpu_cycles when rising_edge(S_AXI_ACLK);
+cycle_tick <= '1' when cpu_cycles /= cycles_last else '0';
 
 iop_code <= IO1 when iop(0) = '1' else
             IO2 when iop(1) = '1' else
             IO4 when iop(2) = '1' else
             IO_NONE;
+iop_last <= iop_code when rising_edge(S_AXI_ACLK);
 
 pt08_inst: entity work.pt08
     generic map(
@@ -337,7 +429,9 @@ kw8i_inst: entity work.kw8i
         io_bus_out => peripheral_out(DEV_ID_KW8I).io_bus_out,
         
         pdp8_irq => dev_interrupts(DEV_ID_KW8I),
-        soc_attention => dev_attention(DEV_ID_KW8I)
+        soc_attention => dev_attention(DEV_ID_KW8I),
+
+        cycle_tick => cycle_tick
     );
 
 rk8_inst: entity work.rk8
@@ -363,9 +457,56 @@ rk8_inst: entity work.rk8
         soc_attention => dev_attention(DEV_ID_RK8)
     );
 
+rk8e_inst: entity work.rk8e
+    port map(
+        clk => S_AXI_ACLK,
+        rstn => S_AXI_ARESETN,
+        
+        reg_sel => perph_reg_sel,
+        reg_out => peripheral_out(DEV_ID_RK8E).reg_out,
+        reg_in => perph_reg_in,
+        reg_write => perph_reg_write(DEV_ID_RK8E),
+        
+        enable => dev_enable(DEV_ID_RK8E),
+        iop => iop_code,
+        io_mb => io_mb,
+        io_ac => io_ac,
+        
+        io_skip => peripheral_out(DEV_ID_RK8E).io_skip,
+        io_ac_clear => peripheral_out(DEV_ID_RK8E).io_ac_clear,
+        io_bus_out => peripheral_out(DEV_ID_RK8E).io_bus_out,
+        
+        pdp8_irq => dev_interrupts(DEV_ID_RK8E),
+        soc_attention => dev_attention(DEV_ID_RK8E)
+    );
+
+lp08_inst: entity work.lp08
+    port map(
+        clk => S_AXI_ACLK,
+        rstn => S_AXI_ARESETN,
+        
+        reg_sel => perph_reg_sel,
+        reg_out => peripheral_out(DEV_ID_LP08).reg_out,
+        reg_in => perph_reg_in,
+        reg_write => perph_reg_write(DEV_ID_LP08),
+        
+        enable => dev_enable(DEV_ID_LP08),
+        iop => iop_code,
+        io_mb => io_mb,
+        io_ac => io_ac,
+        
+        io_skip => peripheral_out(DEV_ID_LP08).io_skip,
+        io_ac_clear => peripheral_out(DEV_ID_LP08).io_ac_clear,
+        io_bus_out => peripheral_out(DEV_ID_LP08).io_bus_out,
+        
+        pdp8_irq => dev_interrupts(DEV_ID_LP08),
+        soc_attention => dev_attention(DEV_ID_LP08)
+    );
+
 conf_enable_eae <= enable_eae;
 conf_max_field <= max_mem_field;
 conf_enable_kt8i <= enable_kt8i;
+conf_enable_fast_eae <= enable_fast_eae;
 
 peripheral_out(0).io_skip <= '0';
 peripheral_out(0).io_ac_clear <= '0';
@@ -382,10 +523,59 @@ io_skip <= peripheral_out(cur_dev_id).io_skip;
 io_ac_clear <= peripheral_out(cur_dev_id).io_ac_clear;
 io_bus_out <= peripheral_out(cur_dev_id).io_bus_out;
 
-perph_reg_sel <= std_logic_vector(to_unsigned(axi_dev_reg, 4));
+-- The AXI side only needs the register select while reading or writing a device register,
+-- the event scan uses it in all other states
+evt_snoop <= '1' when state = IDLE or state = READ_WAIT or state = WRITE_WAIT else '0';
+perph_reg_sel <= std_logic_vector(to_unsigned(evt_reg, 4)) when evt_snoop = '1' else
+                 std_logic_vector(to_unsigned(axi_dev_reg, 4));
 
 -- addr 0 to 63: bus num to dev id
 -- addr 64 to 64 + DEV_ID_COUNT: device regs
+-- addr 128 to 128 + DEV_ID_COUNT: data break slots
+-- addr 191: register event FIFO
+-- addr 192 to 207: data break burst buffer
+--
+-- The system registers on bus 0 are:
+-- 0: configuration, 1: device count, 2: device attention, 3: data break data, 4: data break control,
+--    the last two access the data break slot of DEV_ID_NULL
+-- 5 to 8: CPU snapshot words, reading shows the current state, writing sets the preload value:
+--    5: AC (0-11), L (12), MQ (16-27)
+--    6: PC (0-11), IF (12-14), IB (15-17), DF (18-20), SF (21-26), UF (27), UB (28), SUF (29)
+--    7: MA (0-11), MB (16-27)
+--    8: SC (0-4), skip (5), ION (6), ION delay (7), interrupt inhibit (8), user interrupt (9), deferred (10),
+--       major state (11-13), instruction (14-16), EAE instruction (17-19), run (20), pause (21), time state (22-23), the last three are read only
+-- 9: CPU control, writing bit 0 loads the preload value if the CPU is halted, bit 1 requests a halt,
+--    bit 2 continues a halted CPU like the CONT key. Together with bit 1, this executes a single instruction.
+--    reading returns halted (0), the pending halt request (1) and whether the CPU didn't leave TS4 since
+--    the last continue (2)
+-- 10: number of memory cycles executed by the CPU, read only
+-- 11 to 14: breakpoint configuration, see breakpoint_unit.vhd for the layout
+-- 15: breakpoint hits (0-3), writing a 1 clears the hit
+--
+-- Each device has its own data break slot so that several devices can request a break at the same time.
+-- The pending slot with the highest priority is passed to the CPU, the lower device ID wins a tie.
+-- The slot registers are:
+-- 0: writing sets the request: data (0-11), address (12-23), field (24-26), data in (27), MB inc (28), CA inc (29), three cycle (30)
+--    reading returns the reply: MB (0-11), WC overflow (12), ready (13)
+-- 1: control, writing 1 requests the break, writing 0 cancels it unless the CPU already took it,
+--    reading returns ready (0) and busy (1)
+-- 2: priority (0-1), 3 is the highest
+-- 3: burst, writing count (0-8) with start (15) passes the words of the burst buffer through the slot, writing
+--    without start stops the burst. The request in register 0 is the template for all words, the address
+--    is incremented after each word. A three cycle burst ends early when the word count overflows.
+--    Reading returns the number of transferred words (0-8) and whether the burst is still running (15).
+--    There is only one burst buffer, a burst of another slot reads as not running.
+--
+-- The burst buffer holds one word (0-11) per register. Before a burst it contains the words to write into
+-- memory, afterwards each transferred word is replaced with the MB of its break.
+--
+-- Register 0 of a device contains its enable bit (0) and a mask of the registers to watch (9-15, bit 8 + n watches register n).
+-- After each IOT of a device, its watched registers are compared with the last value that was reported or written by the host.
+-- A change pushes an event into the FIFO. The FIFO registers are:
+-- 0: oldest event: value (0-15), register (16-19), device ID (20-27), valid (31)
+-- 1: CPU cycle counter when the change was detected
+-- 2: writing bit 0 removes the oldest event, writing bit 1 clears the overflow flag
+--    reading returns the number of events (0-6) and whether events were lost because the FIFO was full (8)
 
 axi_fsm: process
     function to_dev_id(addr: std_logic_vector(9 downto 0)) return integer is
@@ -397,6 +587,61 @@ axi_fsm: process
     begin
         return to_integer(unsigned(addr(3 downto 0)));
     end function;
+
+    -- slot that is passed to the CPU in this clock, -1 for none
+    variable grant: integer range -1 to DEV_ID_COUNT - 1;
+
+    -- register event FIFO changes in this clock
+    variable evt_push, evt_pop: boolean;
+    variable evt_next: integer range -1 to DEV_ID_COUNT - 1;
+    variable reg_val: std_logic_vector(15 downto 0);
+
+    -- burst buffer write in this clock, there is a single write port
+    variable buf_we: boolean;
+    variable buf_addr: integer range 0 to BURST_SIZE - 1;
+    variable buf_data: std_logic_vector(11 downto 0);
+
+    procedure write_brk_request(slot: natural) is
+    begin
+        if s_axi_wstrb(0) = '1' then
+            brk_slots(slot).data(7 downto 0) <= s_axi_wdata(7 downto 0);
+        end if;
+
+        if s_axi_wstrb(1) = '1' then
+            brk_slots(slot).data(11 downto 8) <= s_axi_wdata(11 downto 8);
+            brk_slots(slot).data_add(3 downto 0) <= s_axi_wdata(15 downto 12);
+        end if;
+
+        if s_axi_wstrb(2) = '1' then
+            brk_slots(slot).data_add(11 downto 4) <= s_axi_wdata(23 downto 16);
+        end if;
+
+        if s_axi_wstrb(3) = '1' then
+            brk_slots(slot).data_ext <= s_axi_wdata(26 downto 24);
+            brk_slots(slot).data_in <= s_axi_wdata(27);
+            brk_slots(slot).mb_inc <= s_axi_wdata(28);
+            brk_slots(slot).ca_inc <= s_axi_wdata(29);
+            brk_slots(slot).three_cycle <= s_axi_wdata(30);
+        end if;
+    end procedure;
+
+    procedure write_brk_control(slot: natural) is
+    begin
+        if s_axi_wstrb(0) = '1' then
+            if s_axi_wdata(0) = '1' then
+                brk_slots(slot).pending <= '1';
+                brk_slots(slot).ready <= '0';
+            else
+                brk_slots(slot).pending <= '0';
+                brk_slots(slot).ready <= '1';
+                -- withdraw the request if the CPU didn't acknowledge it yet
+                if grant = slot or (bk_active = '1' and bk_slot = slot and bk_rqst = '1' and brk_ack = '0') then
+                    bk_rqst <= '0';
+                    bk_active <= '0';
+                end if;
+            end if;
+        end if;
+    end procedure;
 begin
     wait until rising_edge(S_AXI_ACLK);
 
@@ -416,28 +661,133 @@ begin
     S_AXI_BVALID <= '0';
     
     perph_reg_write <= (others => '0');
+    snap_load <= '0';
+    cont_rqst <= '0';
+    bp_clear <= (others => '0');
 
     if brk_ack = '1' then
         bk_rqst <= '0';
     end if;
+
+    -- a continued CPU leaves TS4 with the next pulse
+    if cpu_snap_state(119 downto 118) /= "11" then
+        cont_pending <= '0';
+    end if;
     
-    if brk_done = '1' then
-        bk_ready <= '1';
-        bk_wc_ovf <= brk_wc_overflow;
-        bk_mb <= io_mb;
+    grant := -1;
+    if brk_done = '1' and bk_active = '1' then
+        brk_slots(bk_slot).ready <= '1';
+        brk_slots(bk_slot).wc_ovf <= brk_wc_overflow;
+        brk_slots(bk_slot).mb <= io_mb;
+        bk_active <= '0';
+    elsif bk_active = '0' then
+        for i in 0 to DEV_ID_COUNT - 1 loop
+            if brk_slots(i).pending = '1' then
+                if grant < 0 then
+                    grant := i;
+                elsif brk_slots(i).priority > brk_slots(grant).priority then
+                    grant := i;
+                end if;
+            end if;
+        end loop;
+
+        if grant >= 0 then
+            bk_slot <= grant;
+            bk_active <= '1';
+            bk_rqst <= '1';
+            brk_slots(grant).pending <= '0';
+        end if;
+    end if;
+
+    -- burst: request the next word when the break of the previous one is done
+    buf_we := false;
+    buf_addr := 0;
+    buf_data := (others => '0');
+    if burst_active = '1' then
+        if burst_wait = '0' then
+            if burst_index = burst_count then
+                burst_active <= '0';
+            else
+                brk_slots(burst_slot).data <= burst_buf(burst_index);
+                brk_slots(burst_slot).pending <= '1';
+                brk_slots(burst_slot).ready <= '0';
+                burst_wait <= '1';
+            end if;
+        elsif brk_slots(burst_slot).ready = '1' then
+            buf_we := true;
+            buf_addr := burst_index;
+            buf_data := brk_slots(burst_slot).mb;
+            burst_index <= burst_index + 1;
+            burst_wait <= '0';
+            if brk_slots(burst_slot).three_cycle = '0' then
+                brk_slots(burst_slot).data_add <= std_logic_vector(unsigned(brk_slots(burst_slot).data_add) + 1);
+            elsif brk_slots(burst_slot).wc_ovf = '1' then
+                burst_active <= '0';
+            end if;
+        end if;
+    end if;
+
+    evt_push := false;
+    evt_pop := false;
+    if evt_scan = '1' then
+        if evt_snoop = '1' then
+            reg_val := peripheral_out(evt_dev).reg_out;
+            if evt_mask(evt_dev)(evt_reg) = '1' and reg_val /= evt_shadow(evt_dev)(evt_reg) then
+                evt_shadow(evt_dev)(evt_reg) <= reg_val;
+                if evt_count < EVT_FIFO_DEPTH then
+                    evt_fifo(to_integer(evt_tail)) <= cpu_cycles & "0000" &
+                        std_logic_vector(to_unsigned(evt_dev, 8)) & std_logic_vector(to_unsigned(evt_reg, 4)) & reg_val;
+                    evt_tail <= evt_tail + 1;
+                    evt_push := true;
+                else
+                    evt_overflow <= '1';
+                end if;
+            end if;
+
+            if evt_reg = EVT_NUM_REGS then
+                evt_scan <= '0';
+            else
+                evt_reg <= evt_reg + 1;
+            end if;
+        end if;
+    else
+        evt_next := -1;
+        for i in 0 to DEV_ID_COUNT - 1 loop
+            if evt_check(i) = '1' and evt_next < 0 then
+                evt_next := i;
+            end if;
+        end loop;
+
+        if evt_next >= 0 then
+            evt_check(evt_next) <= '0';
+            evt_dev <= evt_next;
+            evt_reg <= 1;
+            evt_scan <= '1';
+        end if;
+    end if;
+
+    -- the IOT is done when the last IOP ends, the device has updated its registers by then
+    if iop_code = IO_NONE and iop_last /= IO_NONE and evt_mask(cur_dev_id) /= (EVT_NUM_REGS downto 1 => '0') then
+        evt_check(cur_dev_id) <= '1';
     end if;
 
     case state is
         when IDLE =>
             if s_axi_arvalid = '1' then
                 s_axi_arready <= '1';
-                axi_in_table <= not s_axi_araddr(12);
+                axi_in_brk <= s_axi_araddr(13) and not s_axi_araddr(12);
+                axi_in_burst <= s_axi_araddr(13) and s_axi_araddr(12);
+                axi_in_table <= not s_axi_araddr(13) and not s_axi_araddr(12);
+                axi_burst_index <= to_integer(unsigned(s_axi_araddr(9 downto 2)));
                 axi_bus_id <= to_dev_id(s_axi_araddr(11 downto 2));
                 axi_dev_reg <= to_dev_reg(s_axi_araddr(11 downto 2));
                 state <= READ_WAIT;
             elsif s_axi_awvalid = '1' and s_axi_wvalid = '1' then
                 s_axi_awready <= '1';
-                axi_in_table <= not s_axi_awaddr(12);
+                axi_in_brk <= s_axi_awaddr(13) and not s_axi_awaddr(12);
+                axi_in_burst <= s_axi_awaddr(13) and s_axi_awaddr(12);
+                axi_in_table <= not s_axi_awaddr(13) and not s_axi_awaddr(12);
+                axi_burst_index <= to_integer(unsigned(s_axi_awaddr(9 downto 2)));
                 axi_bus_id <= to_dev_id(s_axi_awaddr(11 downto 2));
                 axi_dev_reg <= to_dev_reg(s_axi_awaddr(11 downto 2));
                 state <= WRITE_WAIT;
@@ -448,24 +798,73 @@ begin
             -- write answer
             s_axi_rdata <= (others => '0');
 
-            if axi_in_table = '1' then
+            if axi_in_burst = '1' then
+                s_axi_rdata(11 downto 0) <= burst_buf(axi_burst_index);
+            elsif axi_in_brk = '1' then
+                if axi_bus_id = EVT_ROW then
+                    case axi_dev_reg is
+                        when 0 =>
+                            if evt_count /= 0 then
+                                s_axi_rdata <= evt_fifo(to_integer(evt_head))(31 downto 0);
+                                s_axi_rdata(31) <= '1';
+                            end if;
+                        when 1 =>
+                            s_axi_rdata <= evt_fifo(to_integer(evt_head))(63 downto 32);
+                        when 2 =>
+                            s_axi_rdata(6 downto 0) <= std_logic_vector(to_unsigned(evt_count, 7));
+                            s_axi_rdata(8) <= evt_overflow;
+                        when others => null;
+                    end case;
+                elsif axi_bus_id < DEV_ID_COUNT then
+                    case axi_dev_reg is
+                        when 0 =>
+                            s_axi_rdata(11 downto 0) <= brk_slots(axi_bus_id).mb;
+                            s_axi_rdata(12) <= brk_slots(axi_bus_id).wc_ovf;
+                            s_axi_rdata(13) <= brk_slots(axi_bus_id).ready;
+                        when 1 =>
+                            s_axi_rdata(0) <= brk_slots(axi_bus_id).ready;
+                            s_axi_rdata(1) <= not brk_slots(axi_bus_id).ready;
+                        when 2 =>
+                            s_axi_rdata(1 downto 0) <= std_logic_vector(brk_slots(axi_bus_id).priority);
+                        when 3 =>
+                            if burst_slot = axi_bus_id then
+                                s_axi_rdata(8 downto 0) <= std_logic_vector(to_unsigned(burst_index, 9));
+                                s_axi_rdata(15) <= burst_active;
+                            end if;
+                        when others => null;
+                    end case;
+                end if;
+            elsif axi_in_table = '1' then
                 if axi_bus_id = 0 then
                     case axi_dev_reg is
                         when 0 =>
                             s_axi_rdata(2 downto 0) <= max_mem_field;
                             s_axi_rdata(3) <= enable_eae;
                             s_axi_rdata(4) <= enable_kt8i;
+                            s_axi_rdata(6) <= enable_fast_eae;
                         when 1 =>
                             s_axi_rdata(7 downto 0) <= std_logic_vector(to_unsigned(DEV_ID_COUNT, 8));
                         when 2 =>
                             s_axi_rdata(DEV_ID_COUNT - 1 downto 0) <= dev_attention;
                         when 3 =>
-                            s_axi_rdata(11 downto 0) <= bk_mb;
-                            s_axi_rdata(12) <= bk_wc_ovf;
-                            s_axi_rdata(13) <= bk_ready;
+                            s_axi_rdata(11 downto 0) <= brk_slots(DEV_ID_NULL).mb;
+                            s_axi_rdata(12) <= brk_slots(DEV_ID_NULL).wc_ovf;
+                            s_axi_rdata(13) <= brk_slots(DEV_ID_NULL).ready;
                         when 4 =>
-                            s_axi_rdata(0) <= bk_ready;
-                            s_axi_rdata(1) <= bk_rqst;
+                            s_axi_rdata(0) <= brk_slots(DEV_ID_NULL).ready;
+                            s_axi_rdata(1) <= not brk_slots(DEV_ID_NULL).ready;
+                        when 5 to 8 =>
+                            s_axi_rdata <= cpu_snap_state((axi_dev_reg - 5) * 32 + 31 downto (axi_dev_reg - 5) * 32);
+                        when 9 =>
+                            s_axi_rdata(0) <= not cpu_snap_state(116);
+                            s_axi_rdata(1) <= halt_rqst;
+                            s_axi_rdata(2) <= cont_pending;
+                        when 10 =>
+                            s_axi_rdata <= cpu_cycles;
+                        when 11 to 14 =>
+                            s_axi_rdata <= bp_config((axi_dev_reg - 11) * 32 + 31 downto (axi_dev_reg - 11) * 32);
+                        when 15 =>
+                            s_axi_rdata(3 downto 0) <= cpu_bp_hits;
                         when others => null;
                     end case;
                 else
@@ -476,6 +875,7 @@ begin
             else
                 if axi_dev_reg = 0 then
                     s_axi_rdata(0) <= dev_enable(axi_bus_id);
+                    s_axi_rdata(8 + EVT_NUM_REGS downto 9) <= evt_mask(axi_bus_id);
                 else
                     s_axi_rdata(15 downto 0) <= peripheral_out(axi_bus_id).reg_out;
                 end if;
@@ -487,11 +887,58 @@ begin
                 state <= IDLE;
             end if;
         when WRITE_WAIT =>
-            if axi_in_table = '1' or axi_bus_id /= cur_dev_id or iop_code = IO_NONE then
+            if axi_in_brk = '1' or axi_in_burst = '1' or axi_in_table = '1' or axi_bus_id /= cur_dev_id or iop_code = IO_NONE then
                 state <= WRITE;
             end if;
         when WRITE =>
-            if axi_in_table = '1' then
+            if axi_in_burst = '1' then
+                -- the buffer belongs to the burst while it's running
+                if burst_active = '0' and s_axi_wstrb(0) = '1' then
+                    buf_we := true;
+                    buf_addr := axi_burst_index;
+                    buf_data := s_axi_wdata(11 downto 0);
+                end if;
+            elsif axi_in_brk = '1' then
+                if axi_bus_id = EVT_ROW then
+                    if axi_dev_reg = 2 and s_axi_wstrb(0) = '1' then
+                        if s_axi_wdata(0) = '1' and evt_count /= 0 then
+                            evt_head <= evt_head + 1;
+                            evt_pop := true;
+                        end if;
+                        if s_axi_wdata(1) = '1' then
+                            evt_overflow <= '0';
+                        end if;
+                    end if;
+                elsif axi_bus_id < DEV_ID_COUNT then
+                    case axi_dev_reg is
+                        when 0 =>
+                            write_brk_request(axi_bus_id);
+                        when 1 =>
+                            write_brk_control(axi_bus_id);
+                        when 2 =>
+                            if s_axi_wstrb(0) = '1' then
+                                brk_slots(axi_bus_id).priority <= unsigned(s_axi_wdata(1 downto 0));
+                            end if;
+                        when 3 =>
+                            if s_axi_wstrb(1) = '1' then
+                                if s_axi_wdata(15) = '1' then
+                                    burst_slot <= axi_bus_id;
+                                    if to_integer(unsigned(s_axi_wdata(8 downto 0))) > BURST_SIZE then
+                                        burst_count <= BURST_SIZE;
+                                    else
+                                        burst_count <= to_integer(unsigned(s_axi_wdata(8 downto 0)));
+                                    end if;
+                                    burst_index <= 0;
+                                    burst_wait <= '0';
+                                    burst_active <= '1';
+                                elsif burst_slot = axi_bus_id then
+                                    burst_active <= '0';
+                                end if;
+                            end if;
+                        when others => null;
+                    end case;
+                end if;
+            elsif axi_in_table = '1' then
                 if axi_bus_id = 0 then
                     case axi_dev_reg is
                         when 0 =>
@@ -499,32 +946,36 @@ begin
                                 max_mem_field <= s_axi_wdata(2 downto 0);
                                 enable_eae <= s_axi_wdata(3);
                                 enable_kt8i <= s_axi_wdata(4);
+                                enable_fast_eae <= s_axi_wdata(6);
                             end if;
                         when 3 =>
+                            write_brk_request(DEV_ID_NULL);
+                        when 4 =>
+                            write_brk_control(DEV_ID_NULL);
+                        when 5 to 8 =>
+                            for i in 0 to 3 loop
+                                if s_axi_wstrb(i) = '1' then
+                                    snap_preload((axi_dev_reg - 5) * 32 + i * 8 + 7 downto (axi_dev_reg - 5) * 32 + i * 8) <= s_axi_wdata(i * 8 + 7 downto i * 8);
+                                end if;
+                            end loop;
+                        when 9 =>
                             if s_axi_wstrb(0) = '1' then
-                                bk_data(7 downto 0) <= s_axi_wdata(7 downto 0);
+                                snap_load <= s_axi_wdata(0);
+                                halt_rqst <= s_axi_wdata(1);
+                                cont_rqst <= s_axi_wdata(2);
+                                if s_axi_wdata(2) = '1' then
+                                    cont_pending <= '1';
+                                end if;
                             end if;
-                            
-                            if s_axi_wstrb(1) = '1' then
-                                bk_data(11 downto 8) <= s_axi_wdata(11 downto 8);
-                                bk_data_add(3 downto 0) <= s_axi_wdata(15 downto 12);
-                            end if;
-                            
-                            if s_axi_wstrb(2) = '1' then
-                                bk_data_add(11 downto 4) <= s_axi_wdata(23 downto 16);
-                            end if;
-                            
-                            if s_axi_wstrb(3) = '1' then
-                                bk_data_ext <= s_axi_wdata(26 downto 24);
-                                bk_data_in <= s_axi_wdata(27);
-                                bk_mb_inc <= s_axi_wdata(28);
-                                bk_ca_inc <= s_axi_wdata(29);
-                                bk_three_cycle <= s_axi_wdata(30);
-                            end if;
-                        when 4 =>
+                        when 11 to 14 =>
+                            for i in 0 to 3 loop
+                                if s_axi_wstrb(i) = '1' then
+                                    bp_config((axi_dev_reg - 11) * 32 + i * 8 + 7 downto (axi_dev_reg - 11) * 32 + i * 8) <= s_axi_wdata(i * 8 + 7 downto i * 8);
+                                end if;
+                            end loop;
+                        when 15 =>
                             if s_axi_wstrb(0) = '1' then
-                                bk_ready <= not s_axi_wdata(0);
-                                bk_rqst <= s_axi_wdata(0);
+                                bp_clear <= s_axi_wdata(3 downto 0);
                             end if;
                         when others => null;
                     end case;
@@ -540,16 +991,26 @@ begin
                     if s_axi_wstrb(0) = '1' then
                         dev_enable(axi_bus_id) <= s_axi_wdata(0);
                     end if;
+
+                    if s_axi_wstrb(1) = '1' then
+                        evt_mask(axi_bus_id) <= s_axi_wdata(8 + EVT_NUM_REGS downto 9);
+                    end if;
                 else
-                    perph_reg_in <= peripheral_out(axi_bus_id).reg_out;
+                    reg_val := peripheral_out(axi_bus_id).reg_out;
                     if s_axi_wstrb(0) = '1' then
-                        perph_reg_in(7 downto 0) <= s_axi_wdata(7 downto 0);
+                        reg_val(7 downto 0) := s_axi_wdata(7 downto 0);
                     end if;
         
                     if s_axi_wstrb(1) = '1' then
-                        perph_reg_in(15 downto 8) <= s_axi_wdata(15 downto 8);
+                        reg_val(15 downto 8) := s_axi_wdata(15 downto 8);
                     end if;
+                    perph_reg_in <= reg_val;
                     perph_reg_write(axi_bus_id) <= '1';
+
+                    -- the host knows about its own changes
+                    if axi_dev_reg <= EVT_NUM_REGS then
+                        evt_shadow(axi_bus_id)(axi_dev_reg) <= reg_val;
+                    end if;
                 end if;
             end if;
 
@@ -562,26 +1023,65 @@ begin
                 state <= IDLE;
             end if;
     end case;
+
+    if buf_we then
+        burst_buf(buf_addr) <= buf_data;
+    end if;
+
+    if evt_push and not evt_pop then
+        evt_count <= evt_count + 1;
+    elsif evt_pop and not evt_push then
+        evt_count <= evt_count - 1;
+    end if;
     
     if s_axi_aresetn = '0' then
         state <= IDLE;
         dev_enable <= (others => '0');
 
         enable_eae <= '0';
+        enable_fast_eae <= '0';
         max_mem_field <= "000";
 
         bk_rqst <= '0';
-        bk_three_cycle <= '0';
-        bk_ca_inc <= '0';
-        bk_mb_inc <= '0';
-        bk_data_in <= '0';
-        bk_data_add <= (others => '0');
-        bk_data_ext <= (others => '0');
-        bk_data <= (others => '0');
-        
-        bk_ready <= '1';
-        bk_mb <= (others => '0');
-        bk_wc_ovf <= '0';
+        bk_active <= '0';
+        bk_slot <= DEV_ID_NULL;
+        burst_slot <= DEV_ID_NULL;
+        burst_active <= '0';
+        burst_wait <= '0';
+        burst_index <= 0;
+        burst_count <= 0;
+        for i in 0 to DEV_ID_COUNT - 1 loop
+            brk_slots(i) <= (
+                data => (others => '0'),
+                data_add => (others => '0'),
+                data_ext => (others => '0'),
+                data_in => '0',
+                mb_inc => '0',
+                ca_inc => '0',
+                three_cycle => '0',
+                priority => (others => '0'),
+                pending => '0',
+                ready => '1',
+                mb => (others => '0'),
+                wc_ovf => '0'
+            );
+        end loop;
+
+        snap_preload <= (others => '0');
+        halt_rqst <= '0';
+        cont_pending <= '0';
+        bp_config <= (others => '0');
+
+        evt_mask <= (others => (others => '0'));
+        evt_shadow <= (others => (others => (others => '0')));
+        evt_check <= (others => '0');
+        evt_scan <= '0';
+        evt_dev <= DEV_ID_NULL;
+        evt_reg <= 1;
+        evt_head <= (others => '0');
+        evt_tail <= (others => '0');
+        evt_count <= 0;
+        evt_overflow <= '0';
     end if;
 end process;
 
@@ -28,30 +28,47 @@ entity kw8i is
         io_bus_out: out std_logic_vector(11 downto 0);
         
         pdp8_irq: out std_logic;
-        soc_attention: out std_logic
+        soc_attention: out std_logic;
+
+        -- pulsed once per CPU memory cycle
+        cycle_tick: in std_logic
     );
     
-    -- assuming 60 Hz
-    constant counter_cycles: natural := period_to_cycles(clk_frq, 1.0 / 60.0);
+    -- The clock either runs in real time or in machine time, i.e. counting 1.5 us memory cycles
+    constant counter_cycles_60: natural := period_to_cycles(clk_frq, 1.0 / 60.0);
+    constant counter_cycles_50: natural := period_to_cycles(clk_frq, 1.0 / 50.0);
+    constant machine_cycles_60: natural := 11111;
+    constant machine_cycles_50: natural := 13333;
 end kw8i;
 
 architecture Behavioral of kw8i is
     signal iop_last: io_state;
-    signal counter: integer range 0 to counter_cycles - 1;
+    signal counter: integer range 0 to counter_cycles_50 - 1;
+    signal counter_max: integer range 0 to counter_cycles_50 - 1;
     signal irq_enable: std_logic;
     signal flag: std_logic;
     signal clock_enable: std_logic;
+    signal use_50hz: std_logic;
+    signal real_time: std_logic;
+    signal count_tick: std_logic;
 begin
 
 with reg_sel select reg_out <=
     -- 0 is used for dev enable outside
     "0000000000000" & flag & irq_enable & clock_enable when x"1",
+    "00000000000000" & real_time & use_50hz when x"2",
     x"0000" when others;
 
 pdp8_irq <= flag and irq_enable when enable = '1' else '0';
 soc_attention <= '0';
 iop_last <= iop when rising_edge(clk);
 
+counter_max <= counter_cycles_50 - 1 when use_50hz = '1' and real_time = '1' else
+               counter_cycles_60 - 1 when real_time = '1' else
+               machine_cycles_50 - 1 when use_50hz = '1' else
+               machine_cycles_60 - 1;
+count_tick <= '1' when real_time = '1' else cycle_tick;
+
 kw8i_proc: process
 begin
     wait until rising_edge(clk);
@@ -62,6 +79,9 @@ begin
                 clock_enable <= reg_in(0);
                 irq_enable <= reg_in(1);
                 flag <= reg_in(2);
+            when x"2" =>
+                use_50hz <= reg_in(0);
+                real_time <= reg_in(1);
             when others => null;
         end case;
     end if;
@@ -73,11 +93,13 @@ begin
     end if;
 
     if clock_enable = '1' then    
-        if counter < counter_cycles - 1 then
-            counter <= counter + 1;
-        else 
-            counter <= 0;
-            flag <= '1';
+        if count_tick = '1' then
+            if counter < counter_max then
+                counter <= counter + 1;
+            else 
+                counter <= 0;
+                flag <= '1';
+            end if;
         end if;
     else
         counter <= 0;
@@ -118,6 +140,8 @@ begin
         flag <= '0';
         clock_enable <= '0';
         irq_enable <= '0';
+        use_50hz <= '0';
+        real_time <= '1';
     end if;
 end process;
 
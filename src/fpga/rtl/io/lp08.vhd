@@ -0,0 +1,148 @@
+-- Part of SoCDP8, Copyright by Folke Will, 2019
+-- Licensed under CERN Open Hardware Licence v1.2
+-- See HW_LICENSE for details
+library IEEE;
+use IEEE.STD_LOGIC_1164.ALL;
+use IEEE.NUMERIC_STD.ALL;
+
+use work.socdp8_package.all;
+
+-- LP08 line printer. The characters go into a FIFO that is emptied by the SoC, so the
+-- program only has to wait when the FIFO is full.
+entity lp08 is
+    port (
+        clk: in std_logic;
+        rstn: in std_logic;
+
+        enable: in std_logic;
+
+        reg_sel: in std_logic_vector(3 downto 0);
+        reg_out: out std_logic_vector(15 downto 0);
+        reg_in: in std_logic_vector(15 downto 0);
+        reg_write: in std_logic;
+
+        iop: in io_state;
+        io_mb: in std_logic_vector(11 downto 0);
+        io_ac: in std_logic_vector(11 downto 0);
+
+        io_skip: out std_logic;
+        io_ac_clear: out std_logic;
+        io_bus_out: out std_logic_vector(11 downto 0);
+
+        pdp8_irq: out std_logic;
+        soc_attention: out std_logic
+    );
+end lp08;
+
+architecture Behavioral of lp08 is
+    constant FIFO_DEPTH: natural := 64;
+    type fifo_a is array(0 to FIFO_DEPTH - 1) of std_logic_vector(7 downto 0);
+
+    signal iop_last: io_state;
+
+    -- regA: oldest character (0-7), its FIFO position (13-8), valid (15), read only.
+    -- The position makes repeated characters visible to the register watch.
+    -- regB: printer flag (0), error (1)
+    -- regC: writing bit 0 removes the oldest character, reading returns the number of characters
+    signal regA: std_logic_vector(15 downto 0);
+    signal regB: std_logic_vector(15 downto 0);
+    signal regC: std_logic_vector(15 downto 0);
+
+    signal fifo: fifo_a;
+    signal head: unsigned(5 downto 0);
+    signal tail: unsigned(5 downto 0);
+    signal count: integer range 0 to FIFO_DEPTH;
+
+    -- the flag is set as soon as there is room for the next character
+    signal flag_wait: std_logic;
+begin
+
+regA <= "10" & std_logic_vector(head) & fifo(to_integer(head)) when count /= 0 else x"0000";
+regC <= std_logic_vector(to_unsigned(count, 16));
+
+with reg_sel select reg_out <=
+    -- 0 is used for dev enable outside
+    regA when x"1",
+    regB when x"2",
+    regC when x"3",
+    x"0000" when others;
+
+pdp8_irq <= regB(0) when enable = '1' else '0';
+soc_attention <= '1' when enable = '1' and count /= 0 else '0';
+iop_last <= iop when rising_edge(clk);
+
+lp08_proc: process
+    variable push, pop: boolean;
+begin
+    wait until rising_edge(clk);
+
+    push := false;
+    pop := false;
+
+    if reg_write = '1' then
+        case reg_sel is
+            when x"2" => regB <= reg_in;
+            when x"3" =>
+                if reg_in(0) = '1' and count /= 0 then
+                    head <= head + 1;
+                    pop := true;
+                end if;
+            when others => null;
+        end case;
+    end if;
+
+    if flag_wait = '1' and count < FIFO_DEPTH then
+        regB(0) <= '1';
+        flag_wait <= '0';
+    end if;
+
+    if iop = IO_NONE or enable = '0' then
+        io_skip <= '0';
+        io_ac_clear <= '0';
+        io_bus_out <= (others => '0');
+    end if;
+
+    if enable = '1' and iop_last /= iop and io_mb(8 downto 3) = o"66" then
+        case iop is
+            when IO1 =>
+                -- PSKF: Skip on printer flag
+                io_skip <= regB(0);
+            when IO2 =>
+                -- PCLF: Clear printer flag
+                regB(0) <= '0';
+            when IO4 =>
+                -- PSTB: Load printer buffer and print, PLS when combined with PCLF
+                if count < FIFO_DEPTH then
+                    fifo(to_integer(tail)) <= io_ac(7 downto 0);
+                    tail <= tail + 1;
+                    push := true;
+                end if;
+                regB(0) <= '0';
+                flag_wait <= '1';
+            when others => null;
+        end case;
+    elsif enable = '1' and iop_last /= iop and io_mb(8 downto 3) = o"65" then
+        case iop is
+            when IO1 =>
+                -- PSKE: Skip on printer error
+                io_skip <= regB(1);
+            when others => null;
+        end case;
+    end if;
+
+    if push and not pop then
+        count <= count + 1;
+    elsif pop and not push then
+        count <= count - 1;
+    end if;
+
+    if rstn = '0' then
+        regB <= (others => '0');
+        head <= (others => '0');
+        tail <= (others => '0');
+        count <= 0;
+        flag_wait <= '0';
+    end if;
+end process;
+
+end Behavioral;
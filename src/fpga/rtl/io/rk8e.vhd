@@ -0,0 +1,206 @@
+-- Part of SoCDP8, Copyright by Folke Will, 2019
+-- Licensed under CERN Open Hardware Licence v1.2
+-- See HW_LICENSE for details
+library IEEE;
+use IEEE.STD_LOGIC_1164.ALL;
+use IEEE.NUMERIC_STD.ALL;
+
+use work.socdp8_package.all;
+
+-- RK8E disk controller for up to four RK05 drives.
+-- The IOTs are handled here, the transfers and seeks are done by the SoC.
+entity rk8e is
+    port (
+        clk: in std_logic;
+        rstn: in std_logic;
+
+        enable: in std_logic;
+
+        reg_sel: in std_logic_vector(3 downto 0);
+        reg_out: out std_logic_vector(15 downto 0);
+        reg_in: in std_logic_vector(15 downto 0);
+        reg_write: in std_logic;
+
+        iop: in io_state;
+        io_mb: in std_logic_vector(11 downto 0);
+        io_ac: in std_logic_vector(11 downto 0);
+
+        io_skip: out std_logic;
+        io_ac_clear: out std_logic;
+        io_bus_out: out std_logic_vector(11 downto 0);
+
+        pdp8_irq: out std_logic;
+        soc_attention: out std_logic
+    );
+end rk8e;
+
+architecture Behavioral of rk8e is
+    signal iop_last: io_state;
+    signal cmd: std_logic_vector(11 downto 0);
+    signal disk_addr: std_logic_vector(11 downto 0);
+    signal status: std_logic_vector(11 downto 0);
+    signal cur_addr: std_logic_vector(11 downto 0);
+    signal go_rqst: std_logic;
+    signal recal_rqst: std_logic;
+    signal busy: std_logic;
+    signal flag: std_logic;
+begin
+
+-- regA: command register
+-- regB: disk address
+-- regC: status register
+-- regD: current address
+-- regE: go request (0), recalibrate request (1), busy (2)
+--
+-- Command bits (PDP-8 numbering in parentheses):
+-- 11 downto 9 (0-2): function, 0 read, 1 read all, 2 set write lock, 3 seek, 4 write, 5 write all
+--  8 (3): interrupt on done or error
+--  7 (4): set done when seek finished
+--  6 (5): 128 word transfers
+--  5 downto 3 (6-8): memory field
+--  2 downto 1 (9-10): drive
+--  0 (11): cylinder MSB
+--
+-- Status bits:
+-- 11: done
+-- 10: heads in motion
+--  8: seek fail
+--  7: drive not ready
+--  6: control busy error
+--  5: timing error
+--  4: write lock error
+--  3: CRC error
+--  2: data rate error
+--  1: drive status error
+--  0: cylinder address error
+
+with reg_sel select reg_out <=
+    -- 0 is used for dev enable outside
+    x"0" & cmd when x"1",
+    x"0" & disk_addr when x"2",
+    x"0" & status when x"3",
+    x"0" & cur_addr when x"4",
+    "0000000000000" & busy & recal_rqst & go_rqst when x"5",
+    x"0000" when others;
+
+iop_last <= iop when rising_edge(clk);
+soc_attention <= go_rqst or recal_rqst;
+
+-- done or any error
+flag <= '1' when status(11) = '1' or status(6 downto 0) /= "0000000" else '0';
+pdp8_irq <= cmd(8) and flag when enable = '1' else '0';
+
+rk8e_proc: process
+begin
+    wait until rising_edge(clk);
+
+    if reg_write = '1' then
+        case reg_sel is
+            when x"1" => cmd <= reg_in(11 downto 0);
+            when x"2" => disk_addr <= reg_in(11 downto 0);
+            when x"3" => status <= reg_in(11 downto 0);
+            when x"4" => cur_addr <= reg_in(11 downto 0);
+            when x"5" =>
+                go_rqst <= reg_in(0);
+                recal_rqst <= reg_in(1);
+                busy <= reg_in(2);
+            when others => null;
+        end case;
+    end if;
+
+    if iop = IO_NONE or enable = '0' then
+        io_skip <= '0';
+        io_ac_clear <= '0';
+        io_bus_out <= (others => '0');
+    end if;
+
+    if enable = '1' and iop_last /= iop and io_mb(8 downto 3) = o"74" then
+        case io_mb(2 downto 0) is
+            when o"1" =>
+                if iop = IO1 then
+                    -- DSKP: Skip on done or error
+                    io_skip <= flag;
+                end if;
+            when o"2" =>
+                if iop = IO2 then
+                    -- DCLR: Clear as selected by AC 10-11, clear AC
+                    case io_ac(1 downto 0) is
+                        when "01" =>
+                            -- clear control
+                            cmd <= (others => '0');
+                            status <= (others => '0');
+                            go_rqst <= '0';
+                            recal_rqst <= '0';
+                            busy <= '0';
+                        when "10" =>
+                            -- recalibrate selected drive
+                            status <= (others => '0');
+                            if busy = '1' then
+                                status(6) <= '1';
+                            else
+                                recal_rqst <= '1';
+                                busy <= '1';
+                            end if;
+                        when others =>
+                            -- clear status
+                            status <= (others => '0');
+                    end case;
+                    io_ac_clear <= '1';
+                end if;
+            when o"3" =>
+                if iop = IO1 then
+                    -- DLAG: Load disk address from AC, clear AC and start the function
+                    if busy = '1' then
+                        status(6) <= '1';
+                    else
+                        disk_addr <= io_ac;
+                        go_rqst <= '1';
+                        busy <= '1';
+                    end if;
+                    io_ac_clear <= '1';
+                end if;
+            when o"4" =>
+                if iop = IO4 then
+                    -- DLCA: Load current address from AC, clear AC
+                    if busy = '1' then
+                        status(6) <= '1';
+                    else
+                        cur_addr <= io_ac;
+                    end if;
+                    io_ac_clear <= '1';
+                end if;
+            when o"5" =>
+                if iop = IO1 then
+                    -- DRST: Load status into AC
+                    io_ac_clear <= '1';
+                    io_bus_out <= status;
+                end if;
+            when o"6" =>
+                if iop = IO2 then
+                    -- DLDC: Load command from AC, clear AC and status
+                    if busy = '1' then
+                        status(6) <= '1';
+                    else
+                        cmd <= io_ac;
+                        status <= (others => '0');
+                    end if;
+                    io_ac_clear <= '1';
+                end if;
+            when others =>
+                -- DMAN: Maintenance, not implemented
+                null;
+        end case;
+    end if;
+
+    if rstn = '0' then
+        cmd <= (others => '0');
+        disk_addr <= (others => '0');
+        status <= (others => '0');
+        cur_addr <= (others => '0');
+        go_rqst <= '0';
+        recal_rqst <= '0';
+        busy <= '0';
+    end if;
+end process;
+
+end Behavioral;
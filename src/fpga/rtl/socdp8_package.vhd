@@ -36,8 +36,10 @@ package socdp8_package is
     constant DEV_ID_TT4:    natural := 9;
     constant DEV_ID_KW8I:   natural := 10;
     constant DEV_ID_RK8:    natural := 11;
+    constant DEV_ID_RK8E:   natural := 12;
+    constant DEV_ID_LP08:   natural := 13;
     
-    constant DEV_ID_COUNT:  natural := 12;
+    constant DEV_ID_COUNT:  natural := 14;
 
     -- The manual function timing states (MFTS) and automatic timing states (TS)
     type time_state_auto is (TS1, TS2, TS3, TS4);
@@ -214,6 +216,25 @@ package socdp8_package is
         l_disable => '0'
     );
 
+    -- Architectural state of the register network, used to take and restore snapshots of a halted CPU
+    type register_state is record
+        ac: std_logic_vector(11 downto 0);
+        link: std_logic;
+        pc: std_logic_vector(11 downto 0);
+        ma: std_logic_vector(11 downto 0);
+        mb: std_logic_vector(11 downto 0);
+        mqr: std_logic_vector(11 downto 0);
+        sc: std_logic_vector(4 downto 0);
+        skip: std_logic;
+        inst_field: std_logic_vector(2 downto 0);
+        inst_buf: std_logic_vector(2 downto 0);
+        data_field: std_logic_vector(2 downto 0);
+        save_field: std_logic_vector(5 downto 0);
+        user_field: std_logic;
+        user_buf: std_logic;
+        save_user_field: std_logic;
+    end record;
+
     -- lamp indices when lamps states are stored in arrays
     constant LAMP_DF:       natural :=  0; -- 00, 01, 02
     constant LAMP_IF:       natural :=  3; -- 03, 04, 05
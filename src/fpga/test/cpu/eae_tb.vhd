@@ -0,0 +1,321 @@
+-- Part of SoCDP8, Copyright by Folke Will, 2019
+-- Licensed under CERN Open Hardware Licence v1.2
+-- See HW_LICENSE for details
+library IEEE;
+use IEEE.STD_LOGIC_1164.ALL;
+use IEEE.NUMERIC_STD.ALL;
+use IEEE.MATH_REAL.ALL;
+
+use work.socdp8_package.all;
+
+-- Runs MUY and DVI on two CPUs, one with the iterative EAE and one with the fast EAE,
+-- and compares AC, MQ, L and SC bit for bit. PC and MA are compared as well because the fast
+-- EAE must not disturb the registers it doesn't compute.
+entity eae_tb is
+end eae_tb;
+
+architecture Behavioral of eae_tb is
+    signal clk: std_logic := '0';
+    signal rstn: std_logic;
+
+    signal mem_out_addr_slow, mem_out_addr_fast: std_logic_vector(14 downto 0);
+    signal mem_out_data_slow, mem_out_data_fast: std_logic_vector(11 downto 0);
+    signal mem_out_write_slow, mem_out_write_fast: std_logic;
+    signal mem_in_data_slow, mem_in_data_fast: std_logic_vector(11 downto 0);
+
+    signal led_accu_slow, led_accu_fast: std_logic_vector(11 downto 0);
+    signal led_mqr_slow, led_mqr_fast: std_logic_vector(11 downto 0);
+    signal led_link_slow, led_link_fast: std_logic;
+    signal led_step_counter_slow, led_step_counter_fast: std_logic_vector(4 downto 0);
+    signal led_run_slow, led_run_fast: std_logic;
+    signal led_pc_slow, led_pc_fast: std_logic_vector(11 downto 0);
+    signal led_mem_addr_slow, led_mem_addr_fast: std_logic_vector(11 downto 0);
+
+    signal switch_data_field: std_logic_vector(2 downto 0);
+    signal switch_inst_field: std_logic_vector(2 downto 0);
+    signal switch_swr: std_logic_vector(11 downto 0);
+    signal switch_start: std_logic;
+    signal switch_load: std_logic;
+    signal switch_dep: std_logic;
+    signal switch_exam: std_logic;
+    signal switch_cont: std_logic;
+    signal switch_stop: std_logic;
+    signal switch_sing_step: std_logic;
+    signal switch_sing_inst: std_logic;
+
+    type ram_a is array (0 to 4095) of std_logic_vector(11 downto 0);
+    signal ram_slow, ram_fast, new_ram_data: ram_a := (others => (others => '0'));
+    signal load_ram: std_logic := '0';
+    signal stop_sim: boolean := false;
+begin
+
+slow: entity work.pdp8
+generic map (
+    debounce_ms => 1
+)
+port map (
+    clk => clk,
+    rstn => rstn,
+    
+    enable_ext_eae => '1',
+    enable_ext_kt8i => '1',
+    enable_ext_mem_fields => "111",
+    enable_ext_fast_eae => '0',
+    
+    io_bus_in => o"0000",
+    io_ac_clear => '0',
+    io_skip => '0',
+    io_iop => open,
+    io_ac => open,
+    io_mb => open,
+    
+    brk_rqst => '0',
+    brk_three_cycle => '0',
+    brk_ca_inc => '0',
+    brk_mb_inc => '0',
+    brk_data_in => '0',
+    brk_data_add => o"0000",
+    brk_data_ext => o"0",
+    brk_data => o"0000",
+    brk_wc_overflow => open,
+    brk_ack => open,
+    brk_done => open,
+
+    mem_out_addr => mem_out_addr_slow,
+    mem_out_data => mem_out_data_slow,
+    mem_out_write => mem_out_write_slow,
+    mem_in_data => mem_in_data_slow,
+    
+    led_data_field => open,
+    led_inst_field => open,
+    led_pc => led_pc_slow,
+    led_mem_addr => led_mem_addr_slow,
+    led_mem_buf => open,
+    led_link => led_link_slow,
+    led_accu => led_accu_slow,
+    led_step_counter => led_step_counter_slow,
+    led_mqr => led_mqr_slow,
+    led_instruction => open,
+    led_state => open,
+    led_ion => open,
+    led_pause => open,
+    led_run => led_run_slow,
+
+    switch_data_field => switch_data_field,
+    switch_inst_field => switch_inst_field,
+    switch_swr => switch_swr,
+    switch_start => switch_start,
+    switch_load => switch_load,
+    switch_dep => switch_dep,
+    switch_exam => switch_exam,
+    switch_cont => switch_cont,
+    switch_stop => switch_stop,
+    switch_sing_step => switch_sing_step,
+    switch_sing_inst => switch_sing_inst,
+
+    int_rqst => '0'
+);
+
+fast: entity work.pdp8
+generic map (
+    debounce_ms => 1
+)
+port map (
+    clk => clk,
+    rstn => rstn,
+    
+    enable_ext_eae => '1',
+    enable_ext_kt8i => '1',
+    enable_ext_mem_fields => "111",
+    enable_ext_fast_eae => '1',
+    
+    io_bus_in => o"0000",
+    io_ac_clear => '0',
+    io_skip => '0',
+    io_iop => open,
+    io_ac => open,
+    io_mb => open,
+    
+    brk_rqst => '0',
+    brk_three_cycle => '0',
+    brk_ca_inc => '0',
+    brk_mb_inc => '0',
+    brk_data_in => '0',
+    brk_data_add => o"0000",
+    brk_data_ext => o"0",
+    brk_data => o"0000",
+    brk_wc_overflow => open,
+    brk_ack => open,
+    brk_done => open,
+
+    mem_out_addr => mem_out_addr_fast,
+    mem_out_data => mem_out_data_fast,
+    mem_out_write => mem_out_write_fast,
+    mem_in_data => mem_in_data_fast,
+    
+    led_data_field => open,
+    led_inst_field => open,
+    led_pc => led_pc_fast,
+    led_mem_addr => led_mem_addr_fast,
+    led_mem_buf => open,
+    led_link => led_link_fast,
+    led_accu => led_accu_fast,
+    led_step_counter => led_step_counter_fast,
+    led_mqr => led_mqr_fast,
+    led_instruction => open,
+    led_state => open,
+    led_ion => open,
+    led_pause => open,
+    led_run => led_run_fast,
+
+    switch_data_field => switch_data_field,
+    switch_inst_field => switch_inst_field,
+    switch_swr => switch_swr,
+    switch_start => switch_start,
+    switch_load => switch_load,
+    switch_dep => switch_dep,
+    switch_exam => switch_exam,
+    switch_cont => switch_cont,
+    switch_stop => switch_stop,
+    switch_sing_step => switch_sing_step,
+    switch_sing_inst => switch_sing_inst,
+
+    int_rqst => '0'
+);
+
+clk_gen: process
+begin
+    wait for 20 ns;
+    clk <= not clk;
+
+    if stop_sim then
+        wait;
+    end if;
+end process;
+
+ram_sim: process
+begin
+    wait until rising_edge(clk);
+
+    if load_ram = '1' then
+        ram_slow <= new_ram_data;
+        ram_fast <= new_ram_data;
+    end if;
+
+    if mem_out_write_slow = '1' then
+        ram_slow(to_integer(unsigned(mem_out_addr_slow(11 downto 0)))) <= mem_out_data_slow;
+    end if;
+    if mem_out_write_fast = '1' then
+        ram_fast(to_integer(unsigned(mem_out_addr_fast(11 downto 0)))) <= mem_out_data_fast;
+    end if;
+
+    mem_in_data_slow <= ram_slow(to_integer(unsigned(mem_out_addr_slow(11 downto 0))));
+    mem_in_data_fast <= ram_fast(to_integer(unsigned(mem_out_addr_fast(11 downto 0))));
+end process;
+
+tests: process
+    variable seed1, seed2: positive := 42;
+    variable rnd: real;
+    variable failures: natural := 0;
+
+    procedure compare(op: std_logic_vector(11 downto 0); hi: natural; lo: natural; operand: natural) is
+    begin
+        new_ram_data <= (
+            8#0# => o"7300",        -- CLA CLL
+            8#1# => o"1011",        -- TAD 11
+            8#2# => o"7421",        -- MQL
+            8#3# => o"1010",        -- TAD 10
+            8#4# => op,             -- MUY / DVI
+            8#5# => std_logic_vector(to_unsigned(operand, 12)),
+            8#6# => o"7402",        -- HLT
+            8#10# => std_logic_vector(to_unsigned(hi, 12)),
+            8#11# => std_logic_vector(to_unsigned(lo, 12)),
+            others => o"7402"
+        );
+        load_ram <= '1';
+        rstn <= '0';
+        wait until rising_edge(clk);
+        wait for 40 ns;
+
+        rstn <= '1';
+        load_ram <= '0';
+        wait until rising_edge(clk);
+        wait for 40 ns;
+
+        switch_start <= '1';
+        wait until led_run_slow = '1' and led_run_fast = '1';
+        switch_start <= '0';
+        if led_run_slow = '1' then
+            wait until led_run_slow = '0';
+        end if;
+        if led_run_fast = '1' then
+            wait until led_run_fast = '0';
+        end if;
+
+        if led_accu_slow /= led_accu_fast or led_mqr_slow /= led_mqr_fast or
+           led_link_slow /= led_link_fast or led_step_counter_slow /= led_step_counter_fast then
+            failures := failures + 1;
+            report "Mismatch for " & integer'image(to_integer(unsigned(op))) & " with AC=" & integer'image(hi) &
+                   " MQ=" & integer'image(lo) & " MEM=" & integer'image(operand) &
+                   ": AC " & integer'image(to_integer(unsigned(led_accu_slow))) & " / " & integer'image(to_integer(unsigned(led_accu_fast))) &
+                   ", MQ " & integer'image(to_integer(unsigned(led_mqr_slow))) & " / " & integer'image(to_integer(unsigned(led_mqr_fast))) &
+                   ", L " & std_logic'image(led_link_slow) & " / " & std_logic'image(led_link_fast) &
+                   ", SC " & integer'image(to_integer(unsigned(led_step_counter_slow))) & " / " & integer'image(to_integer(unsigned(led_step_counter_fast)))
+                severity error;
+        end if;
+
+        -- both stop at the HLT after the operand, so PC points behind it
+        if led_pc_slow /= o"0007" or led_pc_fast /= o"0007" or led_mem_addr_slow /= led_mem_addr_fast then
+            failures := failures + 1;
+            report "Wrong PC or MA for " & integer'image(to_integer(unsigned(op))) & " with AC=" & integer'image(hi) &
+                   " MQ=" & integer'image(lo) & " MEM=" & integer'image(operand) &
+                   ": PC " & integer'image(to_integer(unsigned(led_pc_slow))) & " / " & integer'image(to_integer(unsigned(led_pc_fast))) &
+                   ", MA " & integer'image(to_integer(unsigned(led_mem_addr_slow))) & " / " & integer'image(to_integer(unsigned(led_mem_addr_fast)))
+                severity error;
+        end if;
+    end procedure;
+
+    impure function random_word return natural is
+    begin
+        uniform(seed1, seed2, rnd);
+        return natural(floor(rnd * 4096.0));
+    end function;
+
+    type corner_a is array (natural range <>) of natural;
+    constant corners: corner_a := (0, 1, 2, 8#3777#, 8#4000#, 8#7776#, 8#7777#);
+begin
+    switch_data_field <= (others => '0');
+    switch_inst_field <= (others => '0');
+    switch_swr <= (others => '0');
+    switch_load <= '0';
+    switch_exam <= '0';
+    switch_dep <= '0';
+    switch_cont <= '0';
+    switch_start <= '0';
+    switch_stop <= '0';
+    switch_sing_step <= '0';
+    switch_sing_inst <= '0';
+
+    -- corner cases, including all DVI overflows
+    for a in corners'range loop
+        for m in corners'range loop
+            for o in corners'range loop
+                compare(o"7405", corners(a), corners(m), corners(o));
+                compare(o"7407", corners(a), corners(m), corners(o));
+            end loop;
+        end loop;
+    end loop;
+
+    -- random operands, DVI with AC below the divisor so that most don't overflow
+    for i in 1 to 200 loop
+        compare(o"7405", random_word, random_word, random_word);
+        compare(o"7407", random_word mod 8#0100#, random_word, random_word);
+    end loop;
+
+    assert failures = 0 report integer'image(failures) & " mismatches" severity failure;
+    report "End of tests";
+    stop_sim <= true;
+    wait;
+end process;
+
+end Behavioral;
@@ -0,0 +1,186 @@
+#!/usr/bin/env python3
+# Part of SoCDP8, Copyright by Folke Will, 2019
+# Licensed under CERN Open Hardware Licence v1.2
+# See HW_LICENSE for details
+
+# Runs MAINDEC diagnostics on the elaborated maindec_tb, one GHDL simulation per
+# test and as many in parallel as there are host cores.
+#
+# Each line of the test list has the form
+#   name start swr max_instructions [pass_addr [pass_count]]
+# with octal addresses and switch settings. The tape image is read from
+# maindec/name.bin (BIN format) or maindec/name.rim (RIM format).
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+import time
+from concurrent.futures import ThreadPoolExecutor
+
+TB = './maindec_tb'
+RESULT_RE = re.compile(r'MAINDEC (PASS|FAIL)(.*)')
+INSTRUCTIONS_RE = re.compile(r'instructions=(\d+)')
+
+
+def read_tape(path, rim):
+    """Returns the words of a BIN or RIM paper tape as (address, value) pairs"""
+    with open(path, 'rb') as f:
+        tape = f.read()
+
+    words = []
+    field = 0
+    addr = 0
+    pending = None
+    in_comment = False
+    started = False
+    i = 0
+
+    while i < len(tape):
+        frame = tape[i]
+        i += 1
+
+        if frame == 0o377:
+            in_comment = not in_comment
+            continue
+        if in_comment:
+            continue
+
+        if frame == 0o200:
+            # leader and trailer
+            if started:
+                break
+            continue
+        started = True
+
+        if frame & 0o300 == 0o300:
+            field = (frame >> 3) & 0o7
+            continue
+
+        if i >= len(tape):
+            break
+        word = ((frame & 0o77) << 6) | (tape[i] & 0o77)
+        i += 1
+
+        if pending is not None:
+            words.append(pending)
+            pending = None
+
+        if frame & 0o100:
+            addr = word
+        else:
+            pending = ((field << 12) | addr, word)
+            addr = (addr + 1) & 0o7777
+
+    # The last data word of a BIN tape is the checksum
+    if rim and pending is not None:
+        words.append(pending)
+
+    return words
+
+
+def write_mem(words, path):
+    with open(path, 'w') as f:
+        for addr, value in words:
+            f.write(f'{addr} {value}\n')
+
+
+def parse_tests(path):
+    tests = []
+    with open(path) as f:
+        for line in f:
+            line = line.split('#')[0].strip()
+            if not line:
+                continue
+            fields = line.split()
+            test = {
+                'name': fields[0],
+                'start': int(fields[1], 8),
+                'swr': int(fields[2], 8),
+                'max_instructions': int(fields[3]),
+                'pass_addr': int(fields[4], 8) if len(fields) > 4 else -1,
+                'pass_count': int(fields[5]) if len(fields) > 5 else 1,
+            }
+            tests.append(test)
+    return tests
+
+
+def run_test(test, image_dir, out_dir):
+    name = test['name']
+    result = {'name': name, 'passed': False, 'instructions': 0, 'wall': 0.0, 'message': ''}
+
+    rim_path = os.path.join(image_dir, name + '.rim')
+    bin_path = os.path.join(image_dir, name + '.bin')
+    if os.path.exists(bin_path):
+        words = read_tape(bin_path, False)
+    elif os.path.exists(rim_path):
+        words = read_tape(rim_path, True)
+    else:
+        result['message'] = 'image missing'
+        return result
+
+    mem_path = os.path.join(out_dir, name + '.mem')
+    write_mem(words, mem_path)
+
+    cmd = [
+        TB,
+        f'-gimage={mem_path}',
+        f'-gtty_file={os.path.join(out_dir, name + ".tty")}',
+        f'-gstart_addr={test["start"]}',
+        f'-gswr={test["swr"]}',
+        f'-gpass_addr={test["pass_addr"]}',
+        f'-gpass_count={test["pass_count"]}',
+        f'-gmax_instructions={test["max_instructions"]}',
+        '--ieee-asserts=disable',
+    ]
+
+    start = time.monotonic()
+    proc = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True)
+    result['wall'] = time.monotonic() - start
+
+    with open(os.path.join(out_dir, name + '.log'), 'w') as log:
+        log.write(proc.stdout)
+
+    match = RESULT_RE.search(proc.stdout)
+    if not match:
+        result['message'] = f'simulation failed with exit code {proc.returncode}'
+        return result
+
+    result['passed'] = match.group(1) == 'PASS'
+    result['message'] = match.group(2).strip()
+    count = INSTRUCTIONS_RE.search(match.group(2))
+    if count:
+        result['instructions'] = int(count.group(1))
+    return result
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Run MAINDEC diagnostics in GHDL')
+    parser.add_argument('tests', help='test list')
+    parser.add_argument('--images', default='maindec', help='directory containing the tape images')
+    parser.add_argument('--out', default='maindec/out', help='directory for logs and teleprinter output')
+    parser.add_argument('-j', '--jobs', type=int, default=os.cpu_count(), help='number of parallel simulations')
+    parser.add_argument('-k', '--filter', default='', help='only run tests whose name contains this string')
+    args = parser.parse_args()
+
+    tests = [t for t in parse_tests(args.tests) if args.filter in t['name']]
+    os.makedirs(args.out, exist_ok=True)
+
+    start = time.monotonic()
+    with ThreadPoolExecutor(max_workers=args.jobs) as pool:
+        results = list(pool.map(lambda t: run_test(t, args.images, args.out), tests))
+    total = time.monotonic() - start
+
+    print(f'{"Test":<20} {"Result":<6} {"Instructions":>12} {"Wall [s]":>9}  Details')
+    for res in results:
+        status = 'PASS' if res['passed'] else 'FAIL'
+        print(f'{res["name"]:<20} {status:<6} {res["instructions"]:>12} {res["wall"]:>9.1f}  {res["message"]}')
+
+    failed = sum(1 for res in results if not res['passed'])
+    print(f'{len(results) - failed} of {len(results)} tests passed in {total:.1f} s')
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,316 @@
+-- Part of SoCDP8, Copyright by Folke Will, 2019
+-- Licensed under CERN Open Hardware Licence v1.2
+-- See HW_LICENSE for details
+library IEEE;
+use IEEE.STD_LOGIC_1164.ALL;
+use IEEE.NUMERIC_STD.ALL;
+use std.textio.all;
+
+use work.socdp8_package.all;
+
+-- Runs a single MAINDEC diagnostic, see maindec.py.
+-- The core image is a text file with one decimal "address value" pair per line.
+-- The test fails if the CPU halts anywhere but at pass_addr or if max_instructions
+-- are executed before the instruction at pass_addr was fetched pass_count times.
+-- Halts at pass_addr are continued.
+-- A pass_addr of -1 accepts any run of max_instructions that doesn't halt.
+entity maindec_tb is
+    generic (
+        image: string := "maindec.mem";
+        tty_file: string := "maindec.tty";
+        start_addr: natural := 8#0200#;
+        swr: natural := 0;
+        pass_addr: integer := -1;
+        pass_count: natural := 1;
+        max_instructions: natural := 1000000
+    );
+end maindec_tb;
+
+architecture Behavioral of maindec_tb is
+    signal clk: std_logic := '0';
+    signal rstn: std_logic;
+
+    -- Bus
+    signal io_bus_in: std_logic_vector(11 downto 0);
+    signal io_ac_clear: std_logic;
+    signal io_skip: std_logic;
+    signal io_iop: std_logic_vector(2 downto 0);
+    signal io_ac: std_logic_vector(11 downto 0);
+    signal io_mb: std_logic_vector(11 downto 0);
+
+    -- Memory
+    signal mem_out_addr: std_logic_vector(14 downto 0);
+    signal mem_out_data: std_logic_vector(11 downto 0);
+    signal mem_out_write: std_logic;
+    signal mem_in_data: std_logic_vector(11 downto 0);
+
+    -- Console
+    signal led_data_field: std_logic_vector(2 downto 0);
+    signal led_inst_field: std_logic_vector(2 downto 0);
+    signal led_pc: std_logic_vector(11 downto 0);
+    signal led_mem_addr: std_logic_vector(11 downto 0);
+    signal led_mem_buf: std_logic_vector(11 downto 0);
+    signal led_link: std_logic;
+    signal led_accu: std_logic_vector(11 downto 0);
+    signal led_step_counter: std_logic_vector(4 downto 0);
+    signal led_mqr: std_logic_vector(11 downto 0);
+    signal led_instruction: std_logic_vector(7 downto 0);
+    signal led_state: std_logic_vector(5 downto 0);
+    signal led_ion: std_logic;
+    signal led_pause: std_logic;
+    signal led_run: std_logic;
+
+    signal switch_data_field: std_logic_vector(2 downto 0);
+    signal switch_inst_field: std_logic_vector(2 downto 0);
+    signal switch_swr: std_logic_vector(11 downto 0);
+    signal switch_start: std_logic;
+    signal switch_load: std_logic;
+    signal switch_dep: std_logic;
+    signal switch_exam: std_logic;
+    signal switch_cont: std_logic;
+    signal switch_stop: std_logic;
+    signal switch_sing_step: std_logic;
+    signal switch_sing_inst: std_logic;
+        
+    signal int_rqst: std_logic := '0';
+    signal snap_state: std_logic_vector(127 downto 0);
+
+    type ram_a is array (0 to 32767) of std_logic_vector(11 downto 0);
+
+    impure function load_image(file_name: string) return ram_a is
+        file f: text open read_mode is file_name;
+        variable l: line;
+        variable addr, value: integer;
+        variable res: ram_a := (others => (others => '0'));
+    begin
+        while not endfile(f) loop
+            readline(f, l);
+            read(l, addr);
+            read(l, value);
+            res(addr) := std_logic_vector(to_unsigned(value, 12));
+        end loop;
+        return res;
+    end function;
+
+    signal ram: ram_a := load_image(image);
+    signal stop_sim: boolean := false;
+
+    -- from the snapshot output, see io_controller.vhd
+    signal cpu_ma: natural;
+    signal cpu_if: natural;
+    signal cpu_run: std_logic;
+    signal fetch_start: std_logic;
+    signal fetch_addr: natural := 0;
+    signal instructions: natural := 0;
+    signal passes: natural := 0;
+begin
+
+dut: entity work.pdp8
+generic map (
+    debounce_ms => 1
+)
+port map (
+    clk => clk,
+    rstn => rstn,
+    
+    enable_ext_eae => '1',
+    enable_ext_kt8i => '1',
+    enable_ext_mem_fields => "111",
+    
+    io_bus_in => io_bus_in,
+    io_ac_clear => io_ac_clear,
+    io_skip => io_skip,
+    io_iop => io_iop,
+    io_ac => io_ac,
+    io_mb => io_mb,
+    
+    brk_rqst => '0',
+    brk_three_cycle => '0',
+    brk_ca_inc => '0',
+    brk_mb_inc => '0',
+    brk_data_in => '0',
+    brk_data_add => o"0000",
+    brk_data_ext => o"0",
+    brk_data => o"0000",
+    brk_wc_overflow => open,
+    brk_ack => open,
+    brk_done => open,
+
+    mem_out_addr => mem_out_addr,
+    mem_out_data => mem_out_data,
+    mem_out_write => mem_out_write,
+    mem_in_data => mem_in_data,
+    
+    led_data_field => led_data_field,
+    led_inst_field => led_inst_field,
+    led_pc => led_pc,
+    led_mem_addr => led_mem_addr,
+    led_mem_buf => led_mem_buf,
+    led_link => led_link,
+    led_accu => led_accu,
+    led_step_counter => led_step_counter,
+    led_mqr => led_mqr,
+    led_instruction => led_instruction,
+    led_state => led_state,
+    led_ion => led_ion,
+    led_pause => led_pause,
+    led_run => led_run,
+
+    switch_data_field => switch_data_field,
+    switch_inst_field => switch_inst_field,
+    switch_swr => switch_swr,
+    switch_start => switch_start,
+    switch_load => switch_load,
+    switch_dep => switch_dep,
+    switch_exam => switch_exam,
+    switch_cont => switch_cont,
+    switch_stop => switch_stop,
+    switch_sing_step => switch_sing_step,
+    switch_sing_inst => switch_sing_inst,
+
+    int_rqst => int_rqst,
+
+    snap_state => snap_state
+);
+
+clk_gen: process
+begin
+    wait for 20 ns;
+    clk <= not clk;
+
+    if stop_sim then
+        wait;
+    end if;
+end process;
+
+ram_sim: process
+begin
+    wait until rising_edge(clk);
+
+    if mem_out_write = '1' then
+        ram(to_integer(unsigned(mem_out_addr))) <= mem_out_data;
+    end if;
+
+    mem_in_data <= ram(to_integer(unsigned(mem_out_addr)));
+end process;
+
+-- Minimal teleprinter: the printer is always ready, the keyboard never has input
+tty_sim: process
+    file tty: text open write_mode is tty_file;
+    variable l: line;
+    variable last_iop: std_logic_vector(2 downto 0) := "000";
+    variable char: natural;
+begin
+    wait until rising_edge(clk);
+
+    if io_mb(8 downto 3) = "000100" and io_iop(2) = '1' and last_iop(2) = '0' then
+        char := to_integer(unsigned(io_ac(6 downto 0)));
+        if char = 10 then
+            writeline(tty, l);
+        elsif char >= 32 then
+            write(l, character'val(char));
+        end if;
+    end if;
+    last_iop := io_iop;
+
+    if stop_sim then
+        if l /= null and l'length > 0 then
+            writeline(tty, l);
+        end if;
+        wait;
+    end if;
+end process;
+
+io_bus_in <= (others => '0');
+io_skip <= '1' when io_mb(8 downto 3) = "000100" and io_iop(0) = '1' else '0';
+io_ac_clear <= '1' when io_mb(8 downto 3) = "000011" and io_iop(1) = '1' else '0';
+
+cpu_ma <= to_integer(unsigned(snap_state(75 downto 64)));
+cpu_if <= to_integer(unsigned(snap_state(46 downto 44)));
+cpu_run <= snap_state(116);
+
+-- An instruction starts when TS1 of a fetch cycle is entered
+fetch_start <= '1' when snap_state(109 downto 107) = "001" and snap_state(119 downto 118) = "00" else '0';
+
+counter: process
+    variable last_fetch: std_logic := '0';
+begin
+    wait until rising_edge(clk);
+
+    if fetch_start = '1' and last_fetch = '0' and cpu_run = '1' then
+        instructions <= instructions + 1;
+        fetch_addr <= cpu_if * 4096 + cpu_ma;
+        if cpu_if * 4096 + cpu_ma = pass_addr then
+            passes <= passes + 1;
+        end if;
+    end if;
+    last_fetch := fetch_start;
+end process;
+
+tests: process
+    procedure press(signal key: out std_logic) is
+    begin
+        key <= '1';
+        wait for 2 ms;
+        key <= '0';
+        wait for 2 ms;
+    end procedure;
+
+    variable start_time: time;
+begin
+    switch_data_field <= (others => '0');
+    switch_inst_field <= std_logic_vector(to_unsigned(start_addr / 4096, 3));
+    switch_swr <= std_logic_vector(to_unsigned(start_addr mod 4096, 12));
+    switch_load <= '0';
+    switch_exam <= '0';
+    switch_dep <= '0';
+    switch_cont <= '0';
+    switch_start <= '0';
+    switch_stop <= '0';
+    switch_sing_step <= '0';
+    switch_sing_inst <= '0';
+
+    rstn <= '0';
+    wait until rising_edge(clk);
+    wait for 40 ns;
+    rstn <= '1';
+    wait until rising_edge(clk);
+
+    press(switch_load);
+    switch_swr <= std_logic_vector(to_unsigned(swr, 12));
+    switch_start <= '1';
+    wait until led_run = '1';
+    switch_start <= '0';
+    start_time := now;
+
+    loop
+        wait until rising_edge(clk);
+
+        if pass_addr >= 0 and passes >= pass_count then
+            report "MAINDEC PASS instructions=" & integer'image(instructions) & " time=" & time'image(now - start_time);
+            exit;
+        elsif led_run = '0' and fetch_addr = pass_addr then
+            -- diagnostics that halt at the end of each pass
+            press(switch_cont);
+        elsif led_run = '0' then
+            report "MAINDEC FAIL halted at " & integer'image(fetch_addr) &
+                   " PC=" & integer'image(to_integer(unsigned(led_pc))) &
+                   " AC=" & integer'image(to_integer(unsigned(led_accu))) &
+                   " instructions=" & integer'image(instructions) & " time=" & time'image(now - start_time);
+            exit;
+        elsif instructions >= max_instructions then
+            if pass_addr < 0 then
+                report "MAINDEC PASS instructions=" & integer'image(instructions) & " time=" & time'image(now - start_time);
+            else
+                report "MAINDEC FAIL timeout after " & integer'image(passes) & " passes instructions=" &
+                       integer'image(instructions) & " time=" & time'image(now - start_time);
+            end if;
+            exit;
+        end if;
+    end loop;
+
+    stop_sim <= true;
+    wait;
+end process;
+
+end Behavioral;
@@ -0,0 +1,397 @@
+-- Part of SoCDP8, Copyright by Folke Will, 2019
+-- Licensed under CERN Open Hardware Licence v1.2
+-- See HW_LICENSE for details
+library IEEE;
+use IEEE.STD_LOGIC_1164.ALL;
+use IEEE.NUMERIC_STD.ALL;
+use std.textio.all;
+
+use work.socdp8_package.all;
+
+-- Measures the clock cycles from the fetch of an instruction to the next fetch and
+-- compares them with the times from the PDP-8/I instruction list. The result is
+-- written as a CSV table to table_file, deviations are only reported as warnings.
+entity timing_tb is
+    generic (
+        table_file: string := "timing_table.csv";
+        tolerance_pct: natural := 5
+    );
+end timing_tb;
+
+architecture Behavioral of timing_tb is
+    constant clk_period: time := 1 sec / clk_frq;
+
+    signal clk: std_logic := '0';
+    signal rstn: std_logic;
+
+    -- Bus
+    signal io_bus_in: std_logic_vector(11 downto 0);
+    signal io_ac_clear: std_logic;
+    signal io_skip: std_logic;
+    signal io_iop: std_logic_vector(2 downto 0);
+    signal io_ac: std_logic_vector(11 downto 0);
+    signal io_mb: std_logic_vector(11 downto 0);
+
+    -- Memory
+    signal mem_out_addr: std_logic_vector(14 downto 0);
+    signal mem_out_data: std_logic_vector(11 downto 0);
+    signal mem_out_write: std_logic;
+    signal mem_in_data: std_logic_vector(11 downto 0);
+
+    -- Console
+    signal led_data_field: std_logic_vector(2 downto 0);
+    signal led_inst_field: std_logic_vector(2 downto 0);
+    signal led_pc: std_logic_vector(11 downto 0);
+    signal led_mem_addr: std_logic_vector(11 downto 0);
+    signal led_mem_buf: std_logic_vector(11 downto 0);
+    signal led_link: std_logic;
+    signal led_accu: std_logic_vector(11 downto 0);
+    signal led_step_counter: std_logic_vector(4 downto 0);
+    signal led_mqr: std_logic_vector(11 downto 0);
+    signal led_instruction: std_logic_vector(7 downto 0);
+    signal led_state: std_logic_vector(5 downto 0);
+    signal led_ion: std_logic;
+    signal led_pause: std_logic;
+    signal led_run: std_logic;
+
+    signal switch_data_field: std_logic_vector(2 downto 0);
+    signal switch_inst_field: std_logic_vector(2 downto 0);
+    signal switch_swr: std_logic_vector(11 downto 0);
+    signal switch_start: std_logic;
+    signal switch_load: std_logic;
+    signal switch_dep: std_logic;
+    signal switch_exam: std_logic;
+    signal switch_cont: std_logic;
+    signal switch_stop: std_logic;
+    signal switch_sing_step: std_logic;
+    signal switch_sing_inst: std_logic;
+        
+    -- Data break
+    signal brk_rqst: std_logic := '0';
+    signal brk_three_cycle: std_logic := '0';
+    signal brk_data_add: std_logic_vector(11 downto 0) := o"0000";
+    signal brk_done: std_logic;
+
+    signal snap_state: std_logic_vector(127 downto 0);
+
+    type ram_a is array (0 to 32767) of std_logic_vector(11 downto 0);
+    signal ram, new_ram_data: ram_a := (others => (others => '0'));
+    signal load_ram: std_logic := '0';
+    signal stop_sim: boolean := false;
+
+    -- measurement, see io_controller.vhd for the snapshot layout
+    signal cycle_start: std_logic;
+    signal cycle_state: natural;
+    signal cycle_addr: natural;
+    signal target_addr: integer := -1;
+    signal inst_cycles: natural := 0;
+    signal brk_cycles: natural := 0;
+begin
+
+dut: entity work.pdp8
+generic map (
+    debounce_ms => 1
+)
+port map (
+    clk => clk,
+    rstn => rstn,
+    
+    enable_ext_eae => '1',
+    enable_ext_kt8i => '1',
+    enable_ext_mem_fields => "111",
+    
+    io_bus_in => io_bus_in,
+    io_ac_clear => io_ac_clear,
+    io_skip => io_skip,
+    io_iop => io_iop,
+    io_ac => io_ac,
+    io_mb => io_mb,
+    
+    brk_rqst => brk_rqst,
+    brk_three_cycle => brk_three_cycle,
+    brk_ca_inc => '1',
+    brk_mb_inc => '0',
+    brk_data_in => '1',
+    brk_data_add => brk_data_add,
+    brk_data_ext => o"0",
+    brk_data => o"1234",
+    brk_wc_overflow => open,
+    brk_ack => open,
+    brk_done => brk_done,
+
+    mem_out_addr => mem_out_addr,
+    mem_out_data => mem_out_data,
+    mem_out_write => mem_out_write,
+    mem_in_data => mem_in_data,
+    
+    led_data_field => led_data_field,
+    led_inst_field => led_inst_field,
+    led_pc => led_pc,
+    led_mem_addr => led_mem_addr,
+    led_mem_buf => led_mem_buf,
+    led_link => led_link,
+    led_accu => led_accu,
+    led_step_counter => led_step_counter,
+    led_mqr => led_mqr,
+    led_instruction => led_instruction,
+    led_state => led_state,
+    led_ion => led_ion,
+    led_pause => led_pause,
+    led_run => led_run,
+
+    switch_data_field => switch_data_field,
+    switch_inst_field => switch_inst_field,
+    switch_swr => switch_swr,
+    switch_start => switch_start,
+    switch_load => switch_load,
+    switch_dep => switch_dep,
+    switch_exam => switch_exam,
+    switch_cont => switch_cont,
+    switch_stop => switch_stop,
+    switch_sing_step => switch_sing_step,
+    switch_sing_inst => switch_sing_inst,
+
+    int_rqst => '0',
+
+    snap_state => snap_state
+);
+
+clk_gen: process
+begin
+    wait for clk_period / 2;
+    clk <= not clk;
+
+    if stop_sim then
+        wait;
+    end if;
+end process;
+
+ram_sim: process
+begin
+    wait until rising_edge(clk);
+
+    if load_ram = '1' then
+        ram <= new_ram_data;
+    end if;
+
+    if mem_out_write = '1' then
+        ram(to_integer(unsigned(mem_out_addr))) <= mem_out_data;
+    end if;
+
+    mem_in_data <= ram(to_integer(unsigned(mem_out_addr)));
+end process;
+
+io_bus_in <= (others => '0');
+io_skip <= '0';
+io_ac_clear <= '0';
+
+-- A memory cycle starts when TS1 is entered
+cycle_start <= '1' when snap_state(119 downto 118) = "00" and snap_state(116) = '1' else '0';
+cycle_state <= to_integer(unsigned(snap_state(109 downto 107)));
+cycle_addr <= to_integer(unsigned(snap_state(46 downto 44))) * 4096 + to_integer(unsigned(snap_state(75 downto 64)));
+
+measure: process
+    variable last_start: std_logic := '0';
+    variable clocks: natural := 0;
+    variable inst_start, brk_start: natural;
+    variable in_inst, in_brk, measured: boolean := false;
+begin
+    wait until rising_edge(clk);
+    clocks := clocks + 1;
+
+    if cycle_start = '1' and last_start = '0' then
+        if cycle_state = major_state'pos(STATE_FETCH) then
+            if in_inst then
+                inst_cycles <= clocks - inst_start;
+                in_inst := false;
+                measured := true;
+            end if;
+
+            if in_brk then
+                brk_cycles <= clocks - brk_start;
+                in_brk := false;
+            end if;
+
+            if cycle_addr = target_addr and not measured then
+                inst_start := clocks;
+                in_inst := true;
+            end if;
+        elsif cycle_state >= major_state'pos(STATE_COUNT) and not in_brk then
+            brk_start := clocks;
+            in_brk := true;
+        end if;
+    end if;
+    last_start := cycle_start;
+
+    if rstn = '0' then
+        inst_cycles <= 0;
+        brk_cycles <= 0;
+        in_inst := false;
+        in_brk := false;
+        measured := false;
+    end if;
+end process;
+
+tests: process
+    file table: text open write_mode is table_file;
+    variable l: line;
+    variable mismatches: natural := 0;
+
+    procedure run(ram_data: ram_a; target: integer) is
+    begin
+        new_ram_data <= ram_data;
+        target_addr <= target;
+        load_ram <= '1';
+        rstn <= '0';
+        wait until rising_edge(clk);
+        wait for 2 * clk_period;
+
+        rstn <= '1';
+        load_ram <= '0';
+        wait until rising_edge(clk);
+        wait for 2 * clk_period;
+
+        switch_start <= '1';
+        wait until led_run = '1';
+        switch_start <= '0';
+    end procedure;
+
+    procedure result(name: string; code: string; cycles: natural; min_ns: natural; max_ns: natural) is
+        variable ns: natural;
+        variable ok: boolean;
+    begin
+        ns := cycles * (1_000_000_000 / clk_frq);
+        ok := ns * 100 >= min_ns * (100 - tolerance_pct) and ns * 100 <= max_ns * (100 + tolerance_pct);
+
+        write(l, name & "," & code & ",");
+        write(l, cycles);
+        write(l, string'(","));
+        write(l, ns);
+        write(l, string'(","));
+        write(l, min_ns);
+        write(l, string'(","));
+        write(l, max_ns);
+        if ok then
+            write(l, string'(",ok"));
+        else
+            write(l, string'(",deviation"));
+            mismatches := mismatches + 1;
+        end if;
+        writeline(table, l);
+
+        assert ok report name & " takes " & integer'image(ns) & " ns, manual: " &
+                         integer'image(min_ns) & " - " & integer'image(max_ns) & " ns" severity warning;
+    end procedure;
+
+    -- Executes the instruction at address target once and halts
+    procedure inst(name: string; code: string; ram_data: ram_a; target: natural; min_ns: natural; max_ns: natural) is
+    begin
+        run(ram_data, target);
+        wait until led_run = '0';
+        wait until rising_edge(clk);
+        result(name, code, inst_cycles, min_ns, max_ns);
+    end procedure;
+
+    -- Requests a data break while the CPU executes JMP . and measures it
+    procedure brk(name: string; three_cycle: std_logic; min_ns: natural; max_ns: natural) is
+    begin
+        run((8#00000# => o"5000", 8#07750# => o"7770", 8#07751# => o"0100", others => o"7402"), -1);
+        wait for 20 us;
+        brk_three_cycle <= three_cycle;
+        brk_data_add <= o"7750";
+        brk_rqst <= '1';
+        wait until brk_done = '1';
+        brk_rqst <= '0';
+        wait for 20 us;
+        switch_stop <= '1';
+        wait until led_run = '0';
+        switch_stop <= '0';
+        result(name, "-", brk_cycles, min_ns, max_ns);
+    end procedure;
+begin
+    switch_data_field <= (others => '0');
+    switch_inst_field <= (others => '0');
+    switch_swr <= o"5252";
+    switch_load <= '0';
+    switch_exam <= '0';
+    switch_dep <= '0';
+    switch_cont <= '0';
+    switch_start <= '0';
+    switch_stop <= '0';
+    switch_sing_step <= '0';
+    switch_sing_inst <= '0';
+
+    write(l, string'("instruction,code,cycles,ns,manual_min_ns,manual_max_ns,result"));
+    writeline(table, l);
+
+    -- Memory reference instructions, direct
+    inst("AND", "0005", (8#0# => o"0005", 8#5# => o"7777", others => o"7402"), 0, 3000, 3000);
+    inst("TAD", "1005", (8#0# => o"1005", 8#5# => o"0001", others => o"7402"), 0, 3000, 3000);
+    inst("ISZ", "2005", (8#0# => o"2005", 8#5# => o"0001", others => o"7402"), 0, 3000, 3000);
+    inst("DCA", "3005", (8#0# => o"3005", others => o"7402"), 0, 3000, 3000);
+    inst("JMS", "4005", (8#0# => o"4005", others => o"7402"), 0, 3000, 3000);
+    inst("JMP", "5005", (8#0# => o"5005", others => o"7402"), 0, 1500, 1500);
+
+    -- Indirect
+    inst("AND I", "0405", (8#0# => o"0405", 8#5# => o"0006", 8#6# => o"7777", others => o"7402"), 0, 4500, 4500);
+    inst("TAD I", "1405", (8#0# => o"1405", 8#5# => o"0006", 8#6# => o"0001", others => o"7402"), 0, 4500, 4500);
+    inst("ISZ I", "2405", (8#0# => o"2405", 8#5# => o"0006", 8#6# => o"0001", others => o"7402"), 0, 4500, 4500);
+    inst("DCA I", "3405", (8#0# => o"3405", 8#5# => o"0006", others => o"7402"), 0, 4500, 4500);
+    inst("JMS I", "4405", (8#0# => o"4405", 8#5# => o"0006", others => o"7402"), 0, 4500, 4500);
+    inst("JMP I", "5405", (8#0# => o"5405", 8#5# => o"0006", others => o"7402"), 0, 3000, 3000);
+
+    -- Auto-index
+    inst("TAD I auto", "1410", (8#0# => o"1410", 8#10# => o"0005", 8#6# => o"0001", others => o"7402"), 0, 4500, 4500);
+    inst("DCA I auto", "3410", (8#0# => o"3410", 8#10# => o"0005", others => o"7402"), 0, 4500, 4500);
+    inst("JMP I auto", "5410", (8#0# => o"5410", 8#10# => o"0005", others => o"7402"), 0, 3000, 3000);
+
+    -- Operate group 1
+    inst("NOP", "7000", (8#0# => o"7000", others => o"7402"), 0, 1500, 1500);
+    inst("CLA CLL", "7300", (8#0# => o"7300", others => o"7402"), 0, 1500, 1500);
+    inst("CIA", "7041", (8#0# => o"7041", others => o"7402"), 0, 1500, 1500);
+    inst("CLA IAC", "7201", (8#0# => o"7201", others => o"7402"), 0, 1500, 1500);
+    inst("RAL", "7004", (8#0# => o"7004", others => o"7402"), 0, 1500, 1500);
+    inst("CLL RTR", "7112", (8#0# => o"7112", others => o"7402"), 0, 1500, 1500);
+
+    -- Operate group 2
+    inst("SZA CLA", "7640", (8#0# => o"7640", others => o"7402"), 0, 1500, 1500);
+    inst("SKP", "7410", (8#0# => o"7410", others => o"7402"), 0, 1500, 1500);
+    inst("SMA SZA", "7540", (8#0# => o"7540", others => o"7402"), 0, 1500, 1500);
+    inst("LAS", "7604", (8#0# => o"7604", others => o"7402"), 0, 1500, 1500);
+
+    -- IOT
+    inst("KSF", "6031", (8#0# => o"6031", others => o"7402"), 0, 4250, 4250);
+    inst("TLS", "6046", (8#0# => o"6046", others => o"7402"), 0, 4250, 4250);
+    inst("ION", "6001", (8#0# => o"6001", others => o"7402"), 0, 1500, 1500);
+    inst("CDF 1", "6211", (8#0# => o"6211", others => o"7402"), 0, 1500, 1500);
+    inst("RIB", "6234", (8#0# => o"6234", others => o"7402"), 0, 1500, 1500);
+
+    -- EAE, AC and MQ are set up before the measured instruction
+    inst("MQL", "7421", (8#0# => o"7421", others => o"7402"), 0, 1500, 1500);
+    inst("MQA", "7501", (8#0# => o"7501", others => o"7402"), 0, 1500, 1500);
+    inst("CAM", "7621", (8#0# => o"7621", others => o"7402"), 0, 1500, 1500);
+    inst("SCA", "7441", (8#0# => o"7441", others => o"7402"), 0, 1500, 1500);
+    inst("SCL", "7403", (8#0# => o"7403", 8#1# => o"0005", others => o"7402"), 0, 3000, 3000);
+    inst("MUY", "7405",
+        (8#0# => o"1007", 8#1# => o"7421", 8#2# => o"7405", 8#3# => o"3333", 8#7# => o"4321", others => o"7402"),
+        2, 4800, 7200);
+    inst("DVI", "7407",
+        (8#0# => o"1007", 8#1# => o"7421", 8#2# => o"7407", 8#3# => o"0123", 8#7# => o"4321", others => o"7402"),
+        2, 5200, 7800);
+    inst("NMI n=1", "7411", (8#0# => o"1007", 8#1# => o"7411", 8#7# => o"1000", others => o"7402"), 1, 1750, 1750);
+    inst("NMI n=0", "7411", (8#0# => o"1007", 8#1# => o"7411", 8#7# => o"2000", others => o"7402"), 1, 1500, 1500);
+    inst("SHL 5", "7413", (8#0# => o"7413", 8#1# => o"0005", others => o"7402"), 0, 4250, 4250);
+    inst("ASR 5", "7415", (8#0# => o"7415", 8#1# => o"0005", others => o"7402"), 0, 4250, 4250);
+    inst("LSR 5", "7417", (8#0# => o"7417", 8#1# => o"0005", others => o"7402"), 0, 4250, 4250);
+    inst("LSR 23", "7417", (8#0# => o"7417", 8#1# => o"0027", others => o"7402"), 0, 8750, 8750);
+
+    -- Data breaks
+    brk("BRK 1-cycle", '0', 1500, 1500);
+    brk("BRK 3-cycle", '1', 4500, 4500);
+
+    report "Timing table written to " & table_file & ", " & integer'image(mismatches) & " deviations";
+    stop_sim <= true;
+    wait;
+end process;
+
+end Behavioral;
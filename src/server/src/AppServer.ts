@@ -27,29 +27,63 @@ import { ConsoleState } from './types/ConsoleTypes';
 import { Server, Socket } from 'socket.io';
 import * as io from 'socket.io';
 import { PeripheralInAction, PeripheralOutAction } from './types/PeripheralAction';
+import { CounterChild, metrics, registry } from './Metrics';
+import { tracer } from './Trace';
+import { ImageTransferManager } from './models/ImageTransferManager';
+import { ImageStore } from './drivers/IO/ImageStore';
+import { ImageChunk, ImageTransferRequest } from './types/ImageTransfer';
+import { RemoteReply } from './types/RemoteReply';
+import { CoreRange, CoreSegment, toWords } from './types/CoreSegments';
+import { TapeLoadRequest, TapeLoadResult } from './types/TapeFormat';
+import { PanelMacroResult, PanelStep } from './types/PanelMacro';
+import { Breakpoint, BreakpointState } from './types/Breakpoint';
+import { DebugCommand, DebugReply } from './types/DebugProtocol';
 
 export class AppServer {
     private readonly DATA_DIR = '/home/socdp8/'
-    private readonly MOMENTARY_DEBOUNCE_MS = 150;
     private readonly PANEL_CHECK_MS = 75;
 
     private app: express.Application;
     private pdp8: SoCDP8;
     private systems: SystemConfigurationList;
+    private images: ImageStore;
+    private transfers: ImageTransferManager;
     private socket: Server;
     private httpServer: HTTPServer;
 
     private lastConsoleState?: ConsoleState;
+    private messageCounters = new Map<string, CounterChild>();
 
     constructor() {
-        this.systems = new SystemConfigurationList(this.DATA_DIR);
+        this.images = new ImageStore(this.DATA_DIR);
+        this.systems = new SystemConfigurationList(this.DATA_DIR, this.images);
 
-        this.pdp8 = new SoCDP8(this.DATA_DIR, {
+        this.pdp8 = new SoCDP8(this.DATA_DIR, this.images, {
             onPeripheralEvent: (id, action) => this.sendPeripheralEvent(id, action),
+            onSwitchEvents: () => this.checkConsoleState(),
+            onBreakpointHit: state => this.onBreakpointHit(state),
         });
 
+        this.transfers = new ImageTransferManager(this.pdp8, this.images);
+
         this.app = express();
         this.app.use(cors());
+        this.app.get('/metrics', (_req, res) => {
+            res.type('text/plain; version=0.0.4');
+            res.send(registry.render());
+        });
+        // peripheral trace in Chrome trace format, load it in chrome://tracing or Perfetto
+        this.app.get('/trace', (req, res) => {
+            res.attachment('socdp8-trace.json');
+            res.json(tracer.toChromeTrace());
+            if (req.query.clear !== undefined) {
+                tracer.clear();
+            }
+        });
+        // batched debugger commands for scripts, the same as the 'debug' socket message
+        this.app.post('/debug', express.json({ limit: '1mb' }), async (req, res) => {
+            res.json(await this.runDebugCommands(req.ip ?? 'http', req.body));
+        });
         this.app.use(express.static(__dirname + '/../public'));
 
         this.httpServer = new HTTPServer(this.app);
@@ -59,6 +93,8 @@ export class AppServer {
             }
         });
         this.setupSocketAPI();
+
+        registry.gauge('socdp8_socket_clients', 'Connected socket.io clients', () => this.socket.engine.clientsCount);
     }
 
     public async start(port: number) {
@@ -70,8 +106,22 @@ export class AppServer {
         this.startConsoleCheckLoop();
     }
 
+    private broadcast(event: string, data: any): void {
+        this.countMessage(event);
+        this.socket.emit(event, data);
+    }
+
+    private countMessage(event: string) {
+        let counter = this.messageCounters.get(event);
+        if (!counter) {
+            counter = metrics.socketMessages.labels({ event });
+            this.messageCounters.set(event, counter);
+        }
+        counter.inc();
+    }
+
     private sendPeripheralEvent(id: number, action: PeripheralInAction): void {
-        this.socket.emit('peripheral-event', {
+        this.broadcast('peripheral-event', {
             id: id,
             action: action,
         });
@@ -89,15 +139,35 @@ export class AppServer {
         client.on('peripheral-action', data => this.execPeripheralAction(client, data));
         client.on('peripheral-change-conf', data => this.changePeripheralConfig(client, data));
         client.on('core', data => this.execCoreMemoryAction(client, data));
-        client.on('read-disk-block', (id: number, block: number, reply) => reply(this.readDiskBlock(client, id, block)));
+        client.on('core-write', (segments: CoreSegment[], reply) => reply(this.writeCore(client, segments)));
+        client.on('core-read', (ranges: CoreRange[], reply) => reply(this.readCore(client, ranges)));
+        client.on('load-tape', async (req: TapeLoadRequest, reply) => reply(await this.loadTape(client, req)));
+        client.on('panel-macro', async (steps: PanelStep[], reply) => reply(await this.runPanelMacro(client, steps)));
+        client.on('breakpoint-set', async (slot: number, bp: Breakpoint | null, reply) => reply(await this.setBreakpoint(client, slot, bp)));
+        client.on('breakpoint-list', reply => reply(this.pdp8.readBreakpoints()));
+        client.on('breakpoint-clear-hits', reply => reply(this.pdp8.clearBreakpointHits()));
+        client.on('debug', async (cmds: DebugCommand[], reply) => reply(await this.runDebugCommands(client.id, cmds)));
+        client.on('read-disk-block', async (id: number, block: number, reply) => reply(await this.readDiskBlock(client, id, block)));
+
+        client.on('image-open', async (req: ImageTransferRequest, reply) => {
+            console.log(`${client.id}: Image ${req.direction} for ${req.id}.${req.unit}${req.transferId ? ' (resume)' : ''}`);
+            reply(await this.runRemoteOp('Image transfer', () => this.transfers.open(req)));
+        });
+        client.on('image-chunk', async (chunk: ImageChunk, reply) => reply(await this.runRemoteOp('Image transfer', () => this.transfers.writeChunk(chunk))));
+        client.on('image-read-chunk', async (transferId: string, index: number, reply) => {
+            reply(await this.runRemoteOp('Image transfer', () => this.transfers.readChunk(transferId, index)));
+        });
+        client.on('image-close', async (transferId: string, reply) => reply(await this.runRemoteOp('Image transfer', () => this.transfers.close(transferId))));
 
         client.on('system-list', reply => reply(this.getSystemList(client)));
         client.on('create-system', (sys, reply) => reply(this.createSystem(client, sys)));
         client.on('active-system', reply => reply(this.getActiveSystem(client)));
         client.on('set-active-system', (id, reply) => reply(this.setActiveSystem(client, id)));
         client.on('save-active-system', reply => reply(this.saveActiveSystem(client)));
+        client.on('copy-system', (id: string, name: string, reply) => reply(this.copySystem(client, id, name)));
         client.on('delete-system', (id, reply) => reply(this.deleteSystem(client, id)));
 
+        this.countMessage('console-state');
         client.emit('console-state', this.pdp8.readConsoleState());
     }
 
@@ -118,6 +188,20 @@ export class AppServer {
         }
     }
 
+    // Copies the saved state, disk images are only referenced so this is cheap
+    private copySystem(client: Socket, id: string, name: string): boolean {
+        console.log(`${client.id}: Copy system`);
+
+        try {
+            const sys = this.systems.findSystemById(id);
+            this.systems.copySystem(sys, name);
+            this.sendSystemListChange();
+            return true;
+        } catch (e) {
+            return false;
+        }
+    }
+
     private deleteSystem(client: Socket, id: string): boolean {
         console.log(`${client.id}: Delete system`);
         try {
@@ -136,7 +220,7 @@ export class AppServer {
     }
 
     private sendSystemListChange() {
-        this.socket.emit('state', {type: 'state-list-changed'} as PeripheralInAction);
+        this.broadcast('state', {type: 'state-list-changed'} as PeripheralInAction);
     }
 
     private getActiveSystem(client: Socket): SystemConfiguration {
@@ -151,7 +235,7 @@ export class AppServer {
             const system = this.systems.findSystemById(id);
             const dir = this.systems.getDirForSystem(system);
             await this.pdp8.activateSystem(system, dir);
-            this.socket.emit('state', {type: 'active-state-changed'} as PeripheralInAction);
+            this.broadcast('state', {type: 'active-state-changed'} as PeripheralInAction);
             console.log('State changed');
             return true;
         } catch (e) {
@@ -163,9 +247,11 @@ export class AppServer {
         console.log(`${client.id}: Save active system`);
         const system = this.pdp8.getActiveSystem();
         const dir = this.systems.getDirForSystem(system);
+        const endTimer = metrics.saveDuration.startTimer();
         try {
             await this.systems.saveSystem(system);
             await this.pdp8.saveSystemState(dir);
+            endTimer();
             return true;
         }  catch (e) {
             return false;
@@ -174,14 +260,8 @@ export class AppServer {
 
     private setConsoleSwitch(client: Socket, data: any): void {
         console.log(`${client.id}: Setting switch ${data.switch} to ${data.state ? '1' : '0'}`);
+        // momentary switches are released by the console
         this.pdp8.setSwitch(data.switch, data.state);
-
-        // release momentary switches automatically
-        if (['start', 'load', 'dep', 'exam', 'cont', 'stop'].includes(data.switch)) {
-            setTimeout(() => {
-                this.pdp8.setSwitch(data.switch, false);
-            }, this.MOMENTARY_DEBOUNCE_MS);
-        }
     }
 
     private execPeripheralAction(client: Socket, data: any): void {
@@ -203,40 +283,115 @@ export class AppServer {
             case 'clear':
                 this.pdp8.clearCoreMemory();
                 break;
-            case 'write':
-                this.pdp8.writeCoreMemory(data.addr, data.fragment);
-                break;
         }
     }
 
-    private readDiskBlock(client: Socket, id: number, block: number): Uint16Array {
+    private writeCore(client: Socket, segments: CoreSegment[]): boolean {
+        console.log(`${client.id}: Write ${segments.length} core segments`);
+        try {
+            this.pdp8.writeCoreMemory(segments.map(seg => ({ address: seg.address, data: toWords(seg.data) })));
+            return true;
+        } catch (e) {
+            console.warn(e);
+            return false;
+        }
+    }
+
+    private readCore(client: Socket, ranges: CoreRange[]): CoreSegment[] {
+        console.log(`${client.id}: Read ${ranges.length} core ranges`);
+        try {
+            return this.pdp8.readCoreMemory(ranges);
+        } catch (e) {
+            console.warn(e);
+            return [];
+        }
+    }
+
+    private async loadTape(client: Socket, req: TapeLoadRequest): Promise<RemoteReply<TapeLoadResult>> {
+        console.log(`${client.id}: Load ${req.format} tape`);
+        return await this.runRemoteOp('Load tape', async () => {
+            const res = await this.pdp8.loadTape({ ...req, data: new Uint8Array(req.data) });
+            if (res.checksum && res.checksum.expected != res.checksum.computed) {
+                console.warn(`Checksum error: ${res.checksum.computed.toString(8)} instead of ${res.checksum.expected.toString(8)}`);
+            }
+            return res;
+        });
+    }
+
+    private async runPanelMacro(client: Socket, steps: PanelStep[]): Promise<RemoteReply<PanelMacroResult>> {
+        console.log(`${client.id}: Panel macro with ${steps.length} steps`);
+        return await this.runRemoteOp('Panel macro', () => this.pdp8.runPanelMacro(steps));
+    }
+
+    private async setBreakpoint(client: Socket, slot: number, bp: Breakpoint | null): Promise<RemoteReply<BreakpointState>> {
+        console.log(`${client.id}: Set breakpoint ${slot}`);
+        return await this.runRemoteOp('Set breakpoint', async () => this.pdp8.setBreakpoint(slot, bp));
+    }
+
+    private async runDebugCommands(source: string, cmds: DebugCommand[]): Promise<DebugReply> {
+        if (!Array.isArray(cmds)) {
+            return { results: [], error: 'Expected a list of commands' };
+        }
+
+        try {
+            const reply = await this.pdp8.runDebugCommands(cmds);
+            if (reply.error) {
+                console.warn(`${source}: Debug request failed: ${reply.error}`);
+            }
+            return reply;
+        } catch (e) {
+            console.warn(e);
+            return { results: [], error: `${e}` };
+        }
+    }
+
+    private onBreakpointHit(state: BreakpointState) {
+        this.broadcast('breakpoint-hit', state);
+        this.checkConsoleState();
+    }
+
+    private async readDiskBlock(client: Socket, id: number, block: number): Promise<Uint16Array> {
         console.log(`${client.id}: Read disk ${id} block ${block}`);
         try {
-            return this.pdp8.readPeripheralBlock(id, block);
+            return await this.pdp8.readPeripheralBlock(id, block);
         } catch (e) {
             console.warn(e);
             return new Uint16Array();
         }
     }
 
+    // Runs a request that can fail and passes the result or the error to the client
+    private async runRemoteOp<T>(name: string, op: () => Promise<T>): Promise<RemoteReply<T>> {
+        try {
+            return { ok: true, result: await op() };
+        } catch (e) {
+            console.warn(`${name}: ${e}`);
+            return { ok: false, error: `${e}` };
+        }
+    }
+
     // Console maintenance
 
     private async startConsoleCheckLoop(): Promise<void> {
         const sleepMs = promisify(setTimeout);
 
         while (true) {
-            const curState = this.pdp8.readConsoleState();
-            if (!isDeepStrictEqual(this.lastConsoleState, curState)) {
-                this.broadcastConsoleState(curState);
-                this.lastConsoleState = curState;
-            }
-
+            this.checkConsoleState();
             await sleepMs(this.PANEL_CHECK_MS);
         }
     }
 
+    // also called when a physical switch was flipped so the change doesn't wait for the next check
+    private checkConsoleState() {
+        const curState = this.pdp8.readConsoleState();
+        if (!isDeepStrictEqual(this.lastConsoleState, curState)) {
+            this.broadcastConsoleState(curState);
+            this.lastConsoleState = curState;
+        }
+    }
+
     private broadcastConsoleState(state: ConsoleState) {
         // since we are only sending changes, do not send as volatile
-        this.socket.emit('console-state', state);
+        this.broadcast('console-state', state);
     }
 }
@@ -0,0 +1,197 @@
+/*
+ *   SoCDP8 - A PDP-8/I implementation on a SoC
+ *   Copyright (C) 2019 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+import { monitorEventLoopDelay } from 'perf_hooks';
+
+// Minimal metrics registry that renders the Prometheus text format.
+// Updating a metric is a plain number increment, all formatting happens when scraped.
+
+type Labels = { [name: string]: string };
+
+interface Metric {
+    readonly name: string;
+    readonly help: string;
+    readonly type: string;
+    render(): string[];
+}
+
+function formatLabels(labels: Labels): string {
+    const parts = Object.keys(labels).map(k => `${k}="${labels[k].replace(/(["\\])/g, '\\$1').replace(/\n/g, '\\n')}"`);
+    return parts.length ? `{${parts.join(',')}}` : '';
+}
+
+export class CounterChild {
+    public value = 0;
+
+    constructor(public readonly labels: Labels) {
+    }
+
+    public inc(n = 1) {
+        this.value += n;
+    }
+}
+
+export class Counter implements Metric {
+    public readonly type = 'counter';
+    private children = new Map<string, CounterChild>();
+
+    constructor(public readonly name: string, public readonly help: string) {
+    }
+
+    // Returns a handle for a label set, keep it to avoid the lookup on hot paths
+    public labels(labels: Labels = {}): CounterChild {
+        const key = formatLabels(labels);
+        let child = this.children.get(key);
+        if (!child) {
+            child = new CounterChild(labels);
+            this.children.set(key, child);
+        }
+        return child;
+    }
+
+    public inc(n = 1) {
+        this.labels().inc(n);
+    }
+
+    public render(): string[] {
+        return [...this.children.values()].map(c => `${this.name}${formatLabels(c.labels)} ${c.value}`);
+    }
+}
+
+export class Gauge implements Metric {
+    public readonly type = 'gauge';
+    private value = 0;
+
+    // the collector is called when scraped, e.g. for values that are cheaper to read than to track
+    constructor(public readonly name: string, public readonly help: string, private collect?: () => number) {
+    }
+
+    public set(value: number) {
+        this.value = value;
+    }
+
+    public render(): string[] {
+        const value = this.collect ? this.collect() : this.value;
+        return [`${this.name} ${value}`];
+    }
+}
+
+export class Histogram implements Metric {
+    public readonly type = 'histogram';
+    private readonly counts: Float64Array;
+    private sum = 0;
+    private count = 0;
+
+    // buckets are upper bounds in seconds, ascending
+    constructor(public readonly name: string, public readonly help: string, private readonly buckets: number[]) {
+        this.counts = new Float64Array(buckets.length);
+    }
+
+    public observe(value: number) {
+        this.sum += value;
+        this.count++;
+        for (let i = 0; i < this.buckets.length; i++) {
+            if (value <= this.buckets[i]) {
+                this.counts[i]++;
+                return;
+            }
+        }
+    }
+
+    // Starts a measurement, call the returned function at its end
+    public startTimer(): () => void {
+        const start = process.hrtime.bigint();
+        return () => this.observe(Number(process.hrtime.bigint() - start) / 1e9);
+    }
+
+    public render(): string[] {
+        const lines: string[] = [];
+        let cumulative = 0;
+        for (let i = 0; i < this.buckets.length; i++) {
+            cumulative += this.counts[i];
+            lines.push(`${this.name}_bucket${formatLabels({ le: this.buckets[i].toString() })} ${cumulative}`);
+        }
+        lines.push(`${this.name}_bucket{le="+Inf"} ${this.count}`);
+        lines.push(`${this.name}_sum ${this.sum}`);
+        lines.push(`${this.name}_count ${this.count}`);
+        return lines;
+    }
+}
+
+export class MetricsRegistry {
+    private metrics: Metric[] = [];
+
+    public counter(name: string, help: string): Counter {
+        return this.register(new Counter(name, help));
+    }
+
+    public gauge(name: string, help: string, collect?: () => number): Gauge {
+        return this.register(new Gauge(name, help, collect));
+    }
+
+    public histogram(name: string, help: string, buckets: number[]): Histogram {
+        return this.register(new Histogram(name, help, buckets));
+    }
+
+    public render(): string {
+        const lines: string[] = [];
+        for (const metric of this.metrics) {
+            lines.push(`# HELP ${metric.name} ${metric.help}`);
+            lines.push(`# TYPE ${metric.name} ${metric.type}`);
+            lines.push(...metric.render());
+        }
+        return lines.join('\n') + '\n';
+    }
+
+    private register<T extends Metric>(metric: T): T {
+        this.metrics.push(metric);
+        return metric;
+    }
+}
+
+export const registry = new MetricsRegistry();
+
+const eventLoopDelay = monitorEventLoopDelay({ resolution: 10 });
+eventLoopDelay.enable();
+
+export const metrics = {
+    dataBreaks: registry.counter('socdp8_data_breaks_total', 'Data breaks requested by peripherals'),
+    dataBreakLatency: registry.histogram('socdp8_data_break_latency_seconds', 'Time from data break request to reply',
+        [10e-6, 25e-6, 50e-6, 100e-6, 250e-6, 500e-6, 1e-3, 5e-3, 10e-3]),
+    dataBreakTimeouts: registry.counter('socdp8_data_break_timeouts_total', 'Data breaks that were not accepted in time'),
+    dataBreakPendingRemoved: registry.counter('socdp8_data_break_pending_removed_total', 'Stale pending data breaks that were removed'),
+
+    peripheralOps: registry.counter('socdp8_peripheral_operations_total', 'Peripheral operations by device and type'),
+
+    // the histogram is never reset so that the values don't depend on how often and by whom it's scraped
+    eventLoopLag: registry.gauge('socdp8_event_loop_lag_seconds', 'Mean event loop delay since the server started', () => {
+        const mean = eventLoopDelay.mean / 1e9;
+        return isNaN(mean) ? 0 : mean;
+    }),
+    eventLoopLagP99: registry.gauge('socdp8_event_loop_lag_p99_seconds', '99th percentile of the event loop delay since the server started', () => {
+        return eventLoopDelay.percentile(99) / 1e9;
+    }),
+    eventLoopLagMax: registry.gauge('socdp8_event_loop_lag_max_seconds', 'Maximum event loop delay since the server started', () => {
+        return eventLoopDelay.max / 1e9;
+    }),
+
+    socketMessages: registry.counter('socdp8_socket_messages_total', 'Messages emitted to socket.io clients by event'),
+
+    saveDuration: registry.histogram('socdp8_save_duration_seconds', 'Duration of saving the active system',
+        [0.01, 0.05, 0.1, 0.5, 1, 5, 10]),
+};
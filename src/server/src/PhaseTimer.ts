@@ -0,0 +1,37 @@
+/*
+ *   SoCDP8 - A PDP-8/I implementation on a SoC
+ *   Copyright (C) 2019 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Measures the duration of consecutive phases of a longer operation
+export class PhaseTimer {
+    private phases: { name: string, ms: number }[] = [];
+    private readonly start = process.hrtime.bigint();
+    private last = this.start;
+
+    // Ends the current phase
+    public mark(name: string) {
+        const now = process.hrtime.bigint();
+        this.phases.push({ name, ms: Number(now - this.last) / 1e6 });
+        this.last = now;
+    }
+
+    public report(): string {
+        const total = Number(this.last - this.start) / 1e6;
+        const phases = this.phases.map(p => `${p.name} ${p.ms.toFixed(1)}`).join(', ');
+        return `${total.toFixed(1)} ms (${phases})`;
+    }
+}
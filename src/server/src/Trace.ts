@@ -0,0 +1,172 @@
+/*
+ *   SoCDP8 - A PDP-8/I implementation on a SoC
+ *   Copyright (C) 2019 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+import { DeviceID } from './types/PeripheralTypes';
+
+// Structured tracing for the peripheral hot paths. Events are stored in a binary
+// ring buffer so that recording costs a few typed array writes and no I/O.
+// The level is taken from the environment variable SOCDP8_TRACE:
+//  off:     nothing is recorded
+//  record:  events are recorded into the ring buffer (default)
+//  console: events are additionally printed, this slows down the peripherals
+export enum TraceLevel {
+    OFF     = 0,
+    RECORD  = 1,
+    CONSOLE = 2,
+}
+
+export interface ChromeTraceEvent {
+    name: string;
+    ph: string;
+    ts: number;
+    dur?: number;
+    pid: number;
+    tid: number;
+    s?: string;
+    args?: { [key: string]: any };
+}
+
+class Tracer {
+    private readonly CAPACITY = 64 * 1024;
+    private readonly NO_ARG = -1;
+
+    public level: TraceLevel;
+
+    private ops: string[] = [];
+    private opIds = new Map<string, number>();
+
+    // ring buffer, times are in microseconds since the start of the server
+    private timestamps = new Float64Array(this.CAPACITY);
+    private durations = new Float64Array(this.CAPACITY);
+    private devices = new Uint8Array(this.CAPACITY);
+    private opCodes = new Uint16Array(this.CAPACITY);
+    private args = new Int32Array(this.CAPACITY);
+    private next = 0;
+    private count = 0;
+
+    private readonly epoch = process.hrtime.bigint();
+
+    constructor() {
+        this.level = this.parseLevel(process.env.SOCDP8_TRACE);
+    }
+
+    public get enabled(): boolean {
+        return this.level != TraceLevel.OFF;
+    }
+
+    // Returns the id of an operation name, call once and keep the result
+    public op(name: string): number {
+        let id = this.opIds.get(name);
+        if (id === undefined) {
+            id = this.ops.length;
+            this.ops.push(name);
+            this.opIds.set(name, id);
+        }
+        return id;
+    }
+
+    public now(): number {
+        return Number(process.hrtime.bigint() - this.epoch) / 1000;
+    }
+
+    // Records an event without duration, arg is e.g. a block number or a character
+    public event(dev: DeviceID, op: number, arg = this.NO_ARG) {
+        if (this.enabled) {
+            this.record(dev, op, arg, this.now(), 0);
+        }
+    }
+
+    // Records an operation that started at the given time from now()
+    public complete(dev: DeviceID, op: number, arg: number, start: number) {
+        if (this.enabled) {
+            const now = this.now();
+            this.record(dev, op, arg, start, now - start);
+        }
+    }
+
+    public clear() {
+        this.next = 0;
+        this.count = 0;
+    }
+
+    public toChromeTrace(): { traceEvents: ChromeTraceEvent[], displayTimeUnit: string } {
+        const events: ChromeTraceEvent[] = [];
+        const seenDevices = new Set<number>();
+
+        const first = (this.next - this.count + this.CAPACITY) % this.CAPACITY;
+        for (let n = 0; n < this.count; n++) {
+            const i = (first + n) % this.CAPACITY;
+            const dev = this.devices[i];
+            seenDevices.add(dev);
+
+            const event: ChromeTraceEvent = {
+                name: this.ops[this.opCodes[i]],
+                ph: 'X',
+                ts: this.timestamps[i],
+                dur: this.durations[i],
+                pid: 1,
+                tid: dev,
+            };
+            if (this.durations[i] == 0) {
+                event.ph = 'i';
+                event.s = 't';
+                delete event.dur;
+            }
+            if (this.args[i] != this.NO_ARG) {
+                event.args = { arg: this.args[i] };
+            }
+            events.push(event);
+        }
+
+        for (const dev of seenDevices) {
+            events.push({ name: 'thread_name', ph: 'M', ts: 0, pid: 1, tid: dev, args: { name: DeviceID[dev] ?? `${dev}` } });
+        }
+
+        return { traceEvents: events, displayTimeUnit: 'ms' };
+    }
+
+    private record(dev: DeviceID, op: number, arg: number, ts: number, dur: number) {
+        const i = this.next;
+        this.timestamps[i] = ts;
+        this.durations[i] = dur;
+        this.devices[i] = dev;
+        this.opCodes[i] = op;
+        this.args[i] = arg;
+
+        this.next = (i + 1) % this.CAPACITY;
+        if (this.count < this.CAPACITY) {
+            this.count++;
+        }
+
+        if (this.level == TraceLevel.CONSOLE) {
+            const argStr = arg != this.NO_ARG ? ` ${arg}` : '';
+            const durStr = dur ? ` (${dur.toFixed(0)} us)` : '';
+            console.log(`${DeviceID[dev]}: ${this.ops[op]}${argStr}${durStr}`);
+        }
+    }
+
+    private parseLevel(str?: string): TraceLevel {
+        switch (str) {
+            case 'off':     return TraceLevel.OFF;
+            case 'console': return TraceLevel.CONSOLE;
+            default:        return TraceLevel.RECORD;
+        }
+    }
+}
+
+export const tracer = new Tracer();
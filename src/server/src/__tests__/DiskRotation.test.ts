@@ -0,0 +1,43 @@
+/*
+ *   SoCDP8 - A PDP-8/I implementation on a SoC
+ *   Copyright (C) 2019 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+import { test } from 'node:test';
+import * as assert from 'node:assert';
+import { DiskRotation } from '../drivers/IO/DiskRotation';
+
+test('DiskRotation waits whole cycles for the RF08', () => {
+    const rotation = new DiskRotation(2048, 16);
+
+    for (const cycles of [0, 1, 7, 12345, 0xFFFFFFFF]) {
+        for (const addr of [0, 1, 3, 2047, 0o3777777]) {
+            const latency = rotation.latencyCycles(cycles, addr);
+            assert.ok(Number.isInteger(latency));
+            assert.ok(latency >= 0 && latency <= Math.ceil(2048 * 16 / 1.5));
+        }
+    }
+
+    // 16 us per word is 10.67 cycles
+    assert.strictEqual(rotation.wordsToCycles(1), 11);
+    assert.strictEqual(rotation.wordsToCycles(3), 32);
+});
+
+test('DiskRotation latency reaches the requested word', () => {
+    const rotation = new DiskRotation(2048, 66);
+    const latency = rotation.latencyCycles(1000, 100);
+    assert.strictEqual(rotation.latencyCycles(1000 + latency, 100), 0);
+});
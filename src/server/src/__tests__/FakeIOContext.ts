@@ -0,0 +1,58 @@
+/*
+ *   SoCDP8 - A PDP-8/I implementation on a SoC
+ *   Copyright (C) 2019 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+import { DataBreakBurstReply, DataBreakReply, DataBreakRequest } from '../drivers/IO/DataBreak';
+import { CYCLE_TIME_US, DeviceRegister, IOContext } from '../drivers/IO/Peripheral';
+import { RegisterEventStream } from '../drivers/IO/RegisterEvent';
+import { PeripheralInAction } from '../types/PeripheralAction';
+
+// I/O context without hardware, the cycle counter runs at nominal speed
+export class FakeIOContext implements IOContext {
+    public readonly regs: number[] = new Array(16).fill(0);
+    public readonly events: PeripheralInAction[] = [];
+    private readonly start = process.hrtime.bigint();
+
+    public readRegister(reg: DeviceRegister): number {
+        return this.regs[reg];
+    }
+
+    public writeRegister(reg: DeviceRegister, value: number): void {
+        this.regs[reg] = value;
+    }
+
+    public async dataBreak(req: DataBreakRequest): Promise<DataBreakReply> {
+        throw Error('No data breaks without hardware');
+    }
+
+    public async dataBreakBurst(req: DataBreakRequest, data: Uint16Array): Promise<DataBreakBurstReply> {
+        throw Error('No data breaks without hardware');
+    }
+
+    public watchRegisters(regs: DeviceRegister[]): RegisterEventStream {
+        return new RegisterEventStream();
+    }
+
+    public readCycleCounter(): number {
+        const us = Number(process.hrtime.bigint() - this.start) / 1000;
+        return Math.floor(us / CYCLE_TIME_US) >>> 0;
+    }
+
+    public emitEvent(action: PeripheralInAction): void {
+        this.events.push(action);
+    }
+}
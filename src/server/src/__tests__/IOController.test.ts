@@ -0,0 +1,54 @@
+/*
+ *   SoCDP8 - A PDP-8/I implementation on a SoC
+ *   Copyright (C) 2019 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+import { test } from 'node:test';
+import * as assert from 'node:assert';
+import { IOController } from '../drivers/IO/IOController';
+import { DeviceRegister } from '../drivers/IO/Peripheral';
+import { DeviceID } from '../types/PeripheralTypes';
+
+// register window of the io_controller, see io_controller.vhd for the layout
+const SYS_REG_MAX_DEV = 1 * 4;
+const EVT_REG_STATUS = (1 << 13) | (63 * 64 + 2 * 4);
+const EVT_STATUS_OVERFLOW = 1 << 8;
+
+function peripheralRegAddr(devId: DeviceID, reg: DeviceRegister): number {
+    return (1 << 12) | (devId * 64 + reg * 4);
+}
+
+test('register watches see the final value after a FIFO overflow', async () => {
+    const mem = Buffer.alloc(16384);
+    mem.writeUInt32LE(16, SYS_REG_MAX_DEV);
+    const io = new IOController(mem);
+
+    const devId = DeviceID.DEV_ID_TC08;
+    const stream = io.watchRegisters(devId, [DeviceRegister.REG_A, DeviceRegister.REG_B]);
+
+    // the IOTs changed register A but their events didn't fit into the FIFO
+    mem.writeUInt32LE(0o4321, peripheralRegAddr(devId, DeviceRegister.REG_A));
+    mem.writeUInt32LE(EVT_STATUS_OVERFLOW, EVT_REG_STATUS);
+
+    assert.strictEqual(io.readRegisterEvents(), 1);
+    const res = await stream.next();
+    assert.strictEqual(res.done, false);
+    assert.strictEqual(res.value.reg, DeviceRegister.REG_A);
+    assert.strictEqual(res.value.value, 0o4321);
+    assert.strictEqual(stream.pending, 0);
+
+    io.closeRegisterWatches();
+});
@@ -0,0 +1,40 @@
+/*
+ *   SoCDP8 - A PDP-8/I implementation on a SoC
+ *   Copyright (C) 2019 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+import { test } from 'node:test';
+import * as assert from 'node:assert';
+import { CharMeter } from '../drivers/IO/PaperTape';
+import { FakeIOContext } from './FakeIOContext';
+
+// characters per second of a serial line with 10 bits per character
+for (const baud of [9600, 19200]) {
+    test(`CharMeter meters characters at ${baud} baud`, async () => {
+        const io = new FakeIOContext();
+        const meter = new CharMeter(() => io.readCycleCounter());
+        meter.setRate(baud / 10);
+
+        let chars = 0;
+        for (let i = 0; i < 100 && chars < 4; i++) {
+            await meter.idle();
+            if (meter.tryTake()) {
+                chars++;
+            }
+        }
+        assert.strictEqual(chars, 4);
+    });
+}
@@ -0,0 +1,69 @@
+/*
+ *   SoCDP8 - A PDP-8/I implementation on a SoC
+ *   Copyright (C) 2019 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+import { test } from 'node:test';
+import * as assert from 'node:assert';
+import { Peripheral } from '../drivers/IO/Peripheral';
+import { DeviceID, PeripheralConfiguration } from '../types/PeripheralTypes';
+import { sleepUs } from '../sleep';
+import { FakeIOContext } from './FakeIOContext';
+
+class TimedPeripheral extends Peripheral {
+    public getBusConnections(): number[] {
+        return [];
+    }
+
+    public async run(): Promise<void> {
+    }
+
+    public getConfiguration(): PeripheralConfiguration {
+        throw Error('Not configurable');
+    }
+
+    public reconfigure(conf: PeripheralConfiguration): void {
+    }
+
+    public wait(cycles: number): Promise<void> {
+        return this.waitCycles(cycles);
+    }
+}
+
+test('sleepUs accepts fractional durations', async () => {
+    await sleepUs(260.4166666666667);
+    await sleepUs(1000.5);
+});
+
+test('waitCycles waits for an odd number of cycles', async () => {
+    const io = new FakeIOContext();
+    const perph = new TimedPeripheral(DeviceID.DEV_ID_PT08);
+    perph.setIOContext(io);
+
+    const start = io.readCycleCounter();
+    await perph.wait(7);
+    assert.ok(io.readCycleCounter() - start >= 7);
+});
+
+test('waitCycles rounds up fractional cycle counts', async () => {
+    const io = new FakeIOContext();
+    const perph = new TimedPeripheral(DeviceID.DEV_ID_PT08);
+    perph.setIOContext(io);
+
+    const start = io.readCycleCounter();
+    await perph.wait(10.67);
+    assert.ok(io.readCycleCounter() - start >= 11);
+});
@@ -0,0 +1,41 @@
+/*
+ *   SoCDP8 - A PDP-8/I implementation on a SoC
+ *   Copyright (C) 2019 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+import { test } from 'node:test';
+import * as assert from 'node:assert';
+import { DeviceRegister } from '../drivers/IO/Peripheral';
+import { LP08 } from '../peripherals/LP08';
+import { DeviceID } from '../types/PeripheralTypes';
+import { FakeIOContext } from './FakeIOContext';
+
+test('restoring a snapshot only writes the state registers', () => {
+    const io = new FakeIOContext();
+    const lp08 = new LP08({ id: DeviceID.DEV_ID_LP08 }, '/nonexistent');
+    lp08.setIOContext(io);
+
+    lp08.restoreSnapshot({
+        regs: [
+            [DeviceRegister.REG_A, 0o100101],
+            [DeviceRegister.REG_B, 3],
+            [DeviceRegister.REG_C, 1],
+        ],
+    });
+
+    assert.strictEqual(io.regs[DeviceRegister.REG_A], 0);
+    assert.strictEqual(io.regs[DeviceRegister.REG_B], 3);
+    assert.strictEqual(io.regs[DeviceRegister.REG_C], 0);
+});
@@ -17,17 +17,31 @@
  */
 
 import { LampState } from "./LampState";
-import { SW_OVERRIDE_MASK, LAMP_OVERRIDE_MASK, LampGroupIndex, SwitchIndex, LampBrightnessIndex } from "./ConsoleConstants";
+import {
+    SW_OVERRIDE_MASK, LAMP_OVERRIDE_MASK, LampGroupIndex, SwitchIndex, LampBrightnessIndex, ConsoleRegister, PulseKey,
+    KEY_PULSE_BUSY_MASK, KEY_PULSE_FILL_SHIFT, KEY_PULSE_FILL_MASK, KEY_PULSE_SWITCHES_MASK, KEY_PULSE_SWR_SHIFT,
+    KEY_PULSE_DF_SHIFT, KEY_PULSE_IF_SHIFT, EVENT_IRQ_ENABLE_MASK, SWITCH_EVENT_VALID_MASK, SWITCH_EVENT_INDEX_MASK, SWITCH_EVENT_STATE_MASK,
+} from "./ConsoleConstants";
 import { SwitchState, LampBrightness } from "../../types/ConsoleTypes";
 
+// Edge of a physical switch: 0-2 DF, 3-5 IF, 6-17 SR (bit 0 first), 18-25 START, LOAD, DEP, EXAM, CONT, STOP, SING STEP, SING INST
+export interface SwitchEvent {
+    index: number;
+    state: boolean;
+}
+
 export class Console {
     private map: Buffer;
+    // registers with side effects must be accessed as whole words, Buffer accesses are bytewise
+    private regs: Uint32Array;
     private overridenSwitches: SwitchState;
 
     public constructor(map: Buffer) {
         this.map = map;
+        this.regs = new Uint32Array(map.buffer, map.byteOffset, map.length / 4);
         this.setSwitchOverride(false);
         this.overridenSwitches = this.readSwitches();
+        this.writeSwitches(this.overridenSwitches, true);
     }
 
     public isSwitchOverridden(): boolean {
@@ -101,19 +115,70 @@ export class Console {
         return state;
     }
 
-    public writeSwitches(switches: SwitchState): void {
-        this.writeSwitch(SwitchIndex.DATA_FIELD, switches.dataField);
-        this.writeSwitch(SwitchIndex.INST_FIELD, switches.instField);
-        this.writeSwitch(SwitchIndex.SWR, switches.swr);
-        this.writeSwitch(SwitchIndex.START, switches.start);
-        this.writeSwitch(SwitchIndex.LOAD, switches.load);
-        this.writeSwitch(SwitchIndex.DEP, switches.dep);
-        this.writeSwitch(SwitchIndex.EXAM, switches.exam);
-        this.writeSwitch(SwitchIndex.CONT, switches.cont);
-        this.writeSwitch(SwitchIndex.STOP, switches.stop);
-        this.writeSwitch(SwitchIndex.SING_STEP, switches.singStep);
-        this.writeSwitch(SwitchIndex.SING_INST, switches.singInst);
-        this.overridenSwitches = switches;
+    // Only the registers that changed are written unless all are forced
+    public writeSwitches(switches: SwitchState, force = false): void {
+        const old = this.overridenSwitches;
+        const update = (sw: SwitchIndex, value: number, oldValue: number) => {
+            if (force || value != oldValue) {
+                this.writeSwitch(sw, value);
+            }
+        };
+
+        update(SwitchIndex.DATA_FIELD, switches.dataField, old.dataField);
+        update(SwitchIndex.INST_FIELD, switches.instField, old.instField);
+        update(SwitchIndex.SWR, switches.swr, old.swr);
+        update(SwitchIndex.START, switches.start, old.start);
+        update(SwitchIndex.LOAD, switches.load, old.load);
+        update(SwitchIndex.DEP, switches.dep, old.dep);
+        update(SwitchIndex.EXAM, switches.exam, old.exam);
+        update(SwitchIndex.CONT, switches.cont, old.cont);
+        update(SwitchIndex.STOP, switches.stop, old.stop);
+        update(SwitchIndex.SING_STEP, switches.singStep, old.singStep);
+        update(SwitchIndex.SING_INST, switches.singInst, old.singInst);
+        this.overridenSwitches = { ...switches };
+    }
+
+    // Queues a press and release of a momentary key, timed by the console.
+    // Pulses work with and without switch override. If switches are given, the console
+    // sets them for the duration of the pulse, this is how panel macros are executed.
+    public pulseKey(key: PulseKey, switches?: { swr: number, dataField: number, instField: number }): void {
+        let cmd: number = key;
+        if (switches) {
+            cmd |= KEY_PULSE_SWITCHES_MASK |
+                ((switches.swr & 0o7777) << KEY_PULSE_SWR_SHIFT) |
+                ((switches.dataField & 0o7) << KEY_PULSE_DF_SHIFT) |
+                ((switches.instField & 0o7) << KEY_PULSE_IF_SHIFT);
+        }
+        this.regs[ConsoleRegister.KEY_PULSE] = cmd;
+    }
+
+    // Number of pulses that are waiting, not including the current one
+    public getPulseQueueFill(): number {
+        return (this.regs[ConsoleRegister.KEY_PULSE] >> KEY_PULSE_FILL_SHIFT) & KEY_PULSE_FILL_MASK;
+    }
+
+    public isPulseBusy(): boolean {
+        return (this.regs[ConsoleRegister.KEY_PULSE] & KEY_PULSE_BUSY_MASK) != 0;
+    }
+
+    public setEventIrq(enable: boolean): void {
+        this.regs[ConsoleRegister.EVENT_IRQ] = enable ? EVENT_IRQ_ENABLE_MASK : 0;
+    }
+
+    // Removes all queued edges of the physical switches
+    public readSwitchEvents(): SwitchEvent[] {
+        const events: SwitchEvent[] = [];
+        while (true) {
+            const ev = this.regs[ConsoleRegister.SWITCH_EVENT];
+            if ((ev & SWITCH_EVENT_VALID_MASK) == 0) {
+                break;
+            }
+            events.push({
+                index: ev & SWITCH_EVENT_INDEX_MASK,
+                state: (ev & SWITCH_EVENT_STATE_MASK) != 0,
+            });
+        }
+        return events;
     }
 
     private readLamp(lamp: LampGroupIndex): number {
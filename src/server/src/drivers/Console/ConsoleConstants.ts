@@ -70,3 +70,33 @@ export enum LampBrightnessIndex {
 
 export const LAMP_OVERRIDE_MASK = 2;
 export const SW_OVERRIDE_MASK = 1;
+
+export enum ConsoleRegister {
+    KEY_PULSE =     26,
+    SWITCH_EVENT =  27,
+    EVENT_IRQ =     28,
+}
+
+// Momentary keys that the console can press and release on its own
+export enum PulseKey {
+    START = 1,
+    LOAD =  2,
+    DEP =   3,
+    EXAM =  4,
+    CONT =  5,
+    STOP =  6,
+}
+
+export const KEY_PULSE_DEPTH = 8;
+export const KEY_PULSE_BUSY_MASK = 1;
+export const KEY_PULSE_FILL_SHIFT = 4;
+export const KEY_PULSE_FILL_MASK = 0xF;
+export const KEY_PULSE_SWITCHES_MASK = 1 << 3;
+export const KEY_PULSE_SWR_SHIFT = 4;
+export const KEY_PULSE_DF_SHIFT = 16;
+export const KEY_PULSE_IF_SHIFT = 19;
+export const EVENT_IRQ_ENABLE_MASK = 1;
+export const SWITCH_EVENT_VALID_MASK = 0x80000000;
+export const SWITCH_EVENT_INDEX_MASK = 0x1F;
+export const SWITCH_EVENT_STATE_MASK = 0x100;
+
@@ -21,8 +21,12 @@ import { DataBreakRequest, DataBreakReply } from "../IO/DataBreak";
 export class CoreMemory {
     private buf: Buffer;
 
+    // each word occupies 32 bits, the data is in the lower half
+    private words: Uint16Array;
+
     public constructor(memBuf: Buffer) {
         this.buf = memBuf;
+        this.words = new Uint16Array(memBuf.buffer, memBuf.byteOffset, memBuf.length / 2);
     }
 
     public getWordCount(): number {
@@ -54,12 +58,30 @@ export class CoreMemory {
         }
     }
 
-    public writeData(addr: number, data: number[]) {
-        for (let i = 0; i < data.length; i++) {
-            this.pokeWord(addr + i, data[i]);
+    public writeData(addr: number, data: ArrayLike<number>) {
+        if (addr < 0 || addr + data.length > this.getWordCount()) {
+            throw Error(`Invalid core range ${addr}+${data.length}`);
+        }
+
+        const words = this.words;
+        for (let i = 0, j = addr * 2; i < data.length; i++, j += 2) {
+            words[j] = data[i] & 0o7777;
         }
     }
 
+    public readData(addr: number, length: number): Uint16Array {
+        if (addr < 0 || addr + length > this.getWordCount()) {
+            throw Error(`Invalid core range ${addr}+${length}`);
+        }
+
+        const res = new Uint16Array(length);
+        const words = this.words;
+        for (let i = 0, j = addr * 2; i < length; i++, j += 2) {
+            res[i] = words[j];
+        }
+        return res;
+    }
+
     public clear(): void {
         const numWords = this.getWordCount();
         for (let i = 0; i < numWords; i++) {
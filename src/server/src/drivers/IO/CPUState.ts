@@ -0,0 +1,58 @@
+/*
+ *   SoCDP8 - A PDP-8/I implementation on a SoC
+ *   Copyright (C) 2019 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Complete state of the CPU as exposed by the snapshot registers, see io_controller.vhd
+export interface CPUState {
+    ac: number;
+    link: boolean;
+    mq: number;
+    pc: number;
+    ma: number;
+    mb: number;
+    sc: number;
+    skip: boolean;
+
+    instField: number;
+    instBuffer: number;
+    dataField: number;
+    saveField: number;
+    userField: boolean;
+    userBuffer: boolean;
+    saveUserField: boolean;
+
+    ion: boolean;
+    ionDelay: boolean;
+    intInhibit: boolean;
+    userInterrupt: boolean;
+
+    deferred: boolean;
+    majorState: number;
+    instruction: number;
+    eaeInstruction: number;
+
+    // read only
+    run: boolean;
+    pause: boolean;
+    timeState: number;
+}
+
+// Values of the major_state and time_state_auto enumerations in socdp8_package.vhd
+export const MAJOR_STATE_NONE = 0;
+export const MAJOR_STATE_FETCH = 1;
+export const MAJOR_STATE_BREAK = 6; // highest major state
+export const TIME_STATE_TS4 = 3;
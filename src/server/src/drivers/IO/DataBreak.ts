@@ -30,3 +30,15 @@ export interface DataBreakReply {
     mb: number;
     wordCountOverflow: boolean;
 }
+
+// Words that fit into the burst buffer of the I/O controller
+export const DATA_BREAK_BURST_SIZE = 256;
+
+// A burst transfers consecutive words through the data break slot of a device without a round trip per word.
+// The request is the template for all words, its address is incremented after each word. A three cycle burst
+// ends early when the word count overflows.
+export interface DataBreakBurstReply {
+    // number of words that were transferred
+    count: number;
+    wordCountOverflow: boolean;
+}
@@ -16,7 +16,13 @@
  *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
-export interface Disk {
-    readBlock(block: number): Uint16Array;
-    writeBlock(block: number, data: Uint16Array): void;
+// Devices whose media can be imported and exported as a whole, one image per unit
+export interface ImageDevice {
+    readImage(unit: number): Promise<Uint8Array>;
+    writeImage(unit: number, data: Uint8Array): Promise<void>;
+}
+
+export interface Disk extends ImageDevice {
+    readBlock(block: number): Promise<Uint16Array>;
+    writeBlock(block: number, data: Uint16Array): Promise<void>;
 }
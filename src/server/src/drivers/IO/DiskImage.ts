@@ -0,0 +1,139 @@
+/*
+ *   SoCDP8 - A PDP-8/I implementation on a SoC
+ *   Copyright (C) 2019 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+import { promises } from 'fs';
+import { readContainer } from './ImageContainer';
+import { ImageStore } from './ImageStore';
+
+// A disk image file that is only read when the device is first accessed.
+// The image itself lives in the image store, the system directory only keeps a reference
+// next to the given raw file name (.ref instead of .dat). Containers (.img) and raw images
+// from older versions are read and moved to the store when saved.
+export class DiskImage {
+    private data?: Buffer;
+    private loading?: Promise<Buffer>;
+    private readonly containerFile: string;
+    private readonly refFile: string;
+
+    // hash of the image as it is in the store
+    private hash?: string;
+
+    public constructor(private readonly file: string, private readonly size: number, private readonly store: ImageStore) {
+        const base = file.replace(/\.dat$/, '');
+        this.containerFile = base + '.img';
+        this.refFile = base + '.ref';
+    }
+
+    public isLoaded(): boolean {
+        return this.data !== undefined;
+    }
+
+    public async get(): Promise<Buffer> {
+        if (!this.data) {
+            if (!this.loading) {
+                this.loading = this.load();
+            }
+            this.data = await this.loading;
+        }
+        return this.data;
+    }
+
+    // Word view on the loaded image, writes go directly to the image
+    public async getWords(): Promise<Uint16Array> {
+        const data = await this.get();
+        return new Uint16Array(data.buffer, data.byteOffset, data.length / 2);
+    }
+
+    // Copy of the part of the image that belongs to one drive
+    public async readUnit(unit: number, unitSize: number): Promise<Uint8Array> {
+        const data = await this.get();
+        return Buffer.from(data.subarray(unit * unitSize, (unit + 1) * unitSize));
+    }
+
+    // Replaces one drive, shorter data is padded with zeros
+    public async writeUnit(unit: number, unitSize: number, src: Uint8Array): Promise<void> {
+        if (unit * unitSize >= this.size) {
+            throw Error(`Invalid unit ${unit}`);
+        }
+        const data = await this.get();
+        data.fill(0, unit * unitSize, (unit + 1) * unitSize);
+        data.set(src.subarray(0, unitSize), unit * unitSize);
+    }
+
+    // Images that were never accessed can't have changed so they're not written back,
+    // neither are images that are still the same as in the store
+    public async save(): Promise<void> {
+        if (!this.data) {
+            return;
+        }
+
+        // copied before the first await, the CPU continues while the image is stored
+        const data = Buffer.from(this.data);
+        const hash = ImageStore.hash(data);
+        if (hash == this.hash) {
+            return;
+        }
+
+        await this.store.put(data, hash);
+        this.store.ref(hash);
+
+        const tmpFile = this.refFile + '.tmp';
+        await promises.writeFile(tmpFile, hash);
+        await promises.rename(tmpFile, this.refFile);
+
+        if (this.hash) {
+            this.store.unref(this.hash);
+        }
+        this.hash = hash;
+
+        await promises.rm(this.containerFile, { force: true });
+        await promises.rm(this.file, { force: true });
+    }
+
+    private async load(): Promise<Buffer> {
+        try {
+            const hash = (await promises.readFile(this.refFile)).toString().trim();
+            const data = await this.store.get(hash, this.size);
+            this.hash = hash;
+            return data;
+        } catch (e: any) {
+            // not in the store yet, try a container
+            if (e.code != 'ENOENT') {
+                throw e;
+            }
+        }
+
+        try {
+            return await readContainer(this.containerFile, this.size);
+        } catch (e: any) {
+            // no container yet, try a raw image
+            if (e.code != 'ENOENT') {
+                throw e;
+            }
+        }
+
+        const data = Buffer.alloc(this.size);
+        try {
+            const buf = await promises.readFile(this.file);
+            buf.copy(data);
+        } catch (e) {
+            // no image yet, start with an empty disk
+        }
+        return data;
+    }
+}
@@ -0,0 +1,44 @@
+/*
+ *   SoCDP8 - A PDP-8/I implementation on a SoC
+ *   Copyright (C) 2019 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+import { CYCLE_TIME_US } from './Peripheral';
+
+// Rotational position of a fixed-head disk. The disk spins in machine time, i.e. the
+// word under the heads is derived from the CPU cycle counter, so the latency a program
+// sees only depends on how many cycles it spent since the last transfer.
+// The position is computed in microseconds and all waits are whole cycles. Only the
+// word position is modeled, there is no photocell or track index pulse.
+export class DiskRotation {
+    private readonly trackUs: number;
+
+    constructor(private readonly wordsPerTrack: number, private readonly wordTimeUs: number) {
+        this.trackUs = wordsPerTrack * wordTimeUs;
+    }
+
+    // Number of cycles until the given disk address reaches the heads
+    public latencyCycles(cycles: number, addr: number): number {
+        const targetUs = (addr % this.wordsPerTrack) * this.wordTimeUs;
+        const waitUs = (targetUs - cycles * CYCLE_TIME_US % this.trackUs + this.trackUs) % this.trackUs;
+        return Math.ceil(waitUs / CYCLE_TIME_US);
+    }
+
+    // Number of cycles the given number of words takes to pass the heads
+    public wordsToCycles(words: number): number {
+        return Math.ceil(words * this.wordTimeUs / CYCLE_TIME_US);
+    }
+}
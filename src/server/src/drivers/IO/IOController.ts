@@ -17,48 +17,160 @@
  */
 
 import { DeviceRegister } from './Peripheral';
-import { DataBreakRequest, DataBreakReply } from './DataBreak';
+import { DataBreakRequest, DataBreakReply, DataBreakBurstReply, DATA_BREAK_BURST_SIZE } from './DataBreak';
+import { RegisterEventStream } from './RegisterEvent';
+import { CPUState, TIME_STATE_TS4 } from './CPUState';
 import { sleepUs } from '../../sleep';
 import { DeviceID } from '../../types/PeripheralTypes';
+import { metrics } from '../../Metrics';
+import { Breakpoint, BREAKPOINT_COUNT, BREAKPOINT_TYPES } from '../../types/Breakpoint';
 
 export interface CPUExtensions {
     eae: boolean;
     kt8i: boolean;
+    fastEae: boolean;
     maxMemField: number;
 }
 
+// Last values of the watched registers of a device that were passed to its stream
+interface RegisterWatch {
+    stream: RegisterEventStream;
+    values: Map<DeviceRegister, number>;
+}
+
 export class IOController {
     // system registers
     private readonly SYS_REG_CONFIG = 0;
     private readonly SYS_REG_MAX_DEV = 1;
     private readonly SYS_REG_DEV_ATTN = 2;
-    private readonly SYS_REG_BRK_DATA = 3;
-    private readonly SYS_REG_BRK_CTRL = 4;
+    // 3 and 4 are the data break registers of DEV_ID_NULL, we use the slots of the devices instead
+    private readonly SYS_REG_CPU_STATE = 5; // 5 to 8
+    private readonly SYS_REG_CPU_CTRL = 9;
+    private readonly SYS_REG_CPU_CYCLES = 10;
+    private readonly SYS_REG_BP_CONFIG = 11; // 11 to 14
+    private readonly SYS_REG_BP_HITS = 15;
+
+    // breakpoint configuration word
+    private readonly BP_FIELD_SHIFT = 12;
+    private readonly BP_TYPE_SHIFT = 16;
+    private readonly BP_TYPE_MASK = 7;
+    private readonly BP_HALT = 1 << 20;
+    private readonly BP_IRQ = 1 << 21;
 
     private readonly NUM_DEV_REGS = 16;
 
+    // data break slot registers, one slot per device
+    private readonly BRK_REG_DATA = 0;
+    private readonly BRK_REG_CTRL = 1;
+    private readonly BRK_REG_PRIORITY = 2;
+    private readonly BRK_REG_BURST = 3;
+    private readonly BURST_START = 1 << 15;
+    private readonly BURST_RUNNING = 1 << 15;
+    private readonly BURST_BUFFER_ROW = 192;
+    // polls without a transferred word before a burst is given up
+    private readonly BURST_MAX_IDLE_POLLS = 10;
+
+    // register event FIFO, in the data break window
+    private readonly EVT_ROW = 63;
+    private readonly EVT_REG_HEAD = 0;
+    private readonly EVT_REG_CYCLE = 1;
+    private readonly EVT_REG_STATUS = 2;
+    private readonly EVT_HEAD_VALID = 1 << 31;
+    private readonly EVT_STATUS_OVERFLOW = 1 << 8;
+    private readonly EVT_MAX_REG = 7;
+
     // mapping table rows
     private readonly TBL_MAPPING_DEV_ID = 0;
 
     private readonly NUM_BUS_IDS = 64;
 
     private readonly maxDevices: number;
-    private brkBusy = false;
+    // a slot can only hold one request, so requests of the same device are serialized
+    private readonly brkBusy = new Set<DeviceID>();
+    // there is only one burst buffer
+    private burstBusy = false;
+
+    private readonly watches = new Map<DeviceID, RegisterWatch>();
+
+    // registers with side effects must be accessed as whole words, Buffer accesses are bytewise
+    private readonly regs: Uint32Array;
 
     public constructor(private ioMem: Buffer) {
+        this.regs = new Uint32Array(ioMem.buffer, ioMem.byteOffset, ioMem.length / 4);
         this.maxDevices = this.readSystemRegister(this.SYS_REG_MAX_DEV);
 
         this.clearDeviceTable();
 
         // clear pending data breaks
-        this.writeSystemRegister(this.SYS_REG_BRK_CTRL, 0);
+        for (let i = 0; i < this.maxDevices; i++) {
+            this.writeBreakRegister(i, this.BRK_REG_CTRL, 0);
+        }
+
+        // breakpoints of a previous server instance would stop the CPU without anyone noticing
+        for (let i = 0; i < BREAKPOINT_COUNT; i++) {
+            this.setBreakpoint(i, null);
+        }
+        this.clearBreakpointHits([0, 1, 2, 3]);
+    }
+
+    public setBreakpoint(slot: number, bp: Breakpoint | null) {
+        let word = 0;
+        if (bp) {
+            word = (BREAKPOINT_TYPES.indexOf(bp.type) + 1) << this.BP_TYPE_SHIFT;
+            word |= bp.value;
+            if (bp.type != 'ac' && bp.type != 'iot') {
+                word |= bp.field << this.BP_FIELD_SHIFT;
+            }
+            if (bp.halt) {
+                word |= this.BP_HALT;
+            }
+            if (bp.notify) {
+                word |= this.BP_IRQ;
+            }
+        }
+        this.writeSystemRegister(this.SYS_REG_BP_CONFIG + slot, word);
+    }
+
+    public getBreakpoint(slot: number): Breakpoint | null {
+        const word = this.readSystemRegister(this.SYS_REG_BP_CONFIG + slot);
+        const type = (word >> this.BP_TYPE_SHIFT) & this.BP_TYPE_MASK;
+        if (type == 0 || type > BREAKPOINT_TYPES.length) {
+            return null;
+        }
+
+        return {
+            type: BREAKPOINT_TYPES[type - 1],
+            field: (word >> this.BP_FIELD_SHIFT) & 7,
+            value: word & 0o7777,
+            halt: (word & this.BP_HALT) != 0,
+            notify: (word & this.BP_IRQ) != 0,
+        };
+    }
+
+    public readBreakpointHits(): boolean[] {
+        const hits = this.readSystemRegister(this.SYS_REG_BP_HITS);
+        const res: boolean[] = [];
+        for (let i = 0; i < BREAKPOINT_COUNT; i++) {
+            res.push((hits & (1 << i)) != 0);
+        }
+        return res;
+    }
+
+    // The hits of breakpoints with notify keep the interrupt active until they're cleared
+    public clearBreakpointHits(slots: number[]) {
+        let mask = 0;
+        for (const slot of slots) {
+            mask |= 1 << slot;
+        }
+        this.writeSystemRegister(this.SYS_REG_BP_HITS, mask);
     }
 
     public configureExtensions(ext: CPUExtensions) {
         this.writeSystemRegister(this.SYS_REG_CONFIG,
                 (ext.maxMemField & 7) |
                 (ext.eae ? (1 << 3) : 0) |
-                (ext.kt8i ? (1 << 4) : 0)
+                (ext.kt8i ? (1 << 4) : 0) |
+                (ext.fastEae ? (1 << 6) : 0)
         );
     }
 
@@ -67,7 +179,8 @@ export class IOController {
         return {
             maxMemField: conf & 0o7,
             eae: (conf & (1 << 3)) != 0,
-            kt8i: (conf & (1 << 4)) != 0
+            kt8i: (conf & (1 << 4)) != 0,
+            fastEae: (conf & (1 << 6)) != 0
         };
     }
 
@@ -88,7 +201,7 @@ export class IOController {
     }
 
     public registerPeripheral(busIds: number[], devId: DeviceID): void {
-        this.writePeripheralReg(devId, DeviceRegister.REG_ENABLED, 1);
+        this.updateEnableRegister(devId, 0xFF00, 1);
 
         // connect peripheral to bus at desired locations
         for (const busId of busIds) {
@@ -96,51 +209,341 @@ export class IOController {
         }
     }
 
-    public async doDataBreak(req: DataBreakRequest): Promise<DataBreakReply> {
-        while (this.brkBusy) {
-            await sleepUs(10);
+    // Reports the changes of the given registers that are caused by IOTs of the device. Changes made by
+    // the host are not reported. A device has only one stream, watching again closes the previous one.
+    public watchRegisters(devId: DeviceID, regs: DeviceRegister[]): RegisterEventStream {
+        let mask = 0;
+        for (const reg of regs) {
+            if (reg < DeviceRegister.REG_A || reg > this.EVT_MAX_REG) {
+                throw Error(`Register ${reg} can't be watched`);
+            }
+            mask |= 1 << reg;
         }
-        this.brkBusy = true;
 
-        try {
-            // wait for old pending requests to finish
-            await this.waitDataBreakReady();
-        } catch (e) {
-            // remove pending requests
-            console.warn('Removed pending BRK');
-            this.writeSystemRegister(this.SYS_REG_BRK_CTRL, 0);
+        this.watches.get(devId)?.stream.close();
+        const stream = new RegisterEventStream();
+        const values = new Map<DeviceRegister, number>();
+        for (const reg of regs) {
+            values.set(reg, this.readPeripheralReg(devId, reg));
         }
+        this.watches.set(devId, { stream, values });
 
-        const requestWord: number = this.encodeDataBreak(req);
-        this.writeSystemRegister(this.SYS_REG_BRK_DATA, requestWord);
-        this.writeSystemRegister(this.SYS_REG_BRK_CTRL, 1);
+        this.updateEnableRegister(devId, 0x00FF, mask << 8);
+        return stream;
+    }
 
-        this.brkBusy = false;
+    public closeRegisterWatches() {
+        for (const [devId, watch] of this.watches) {
+            this.updateEnableRegister(devId, 0x00FF, 0);
+            watch.stream.close();
+        }
+        this.watches.clear();
+    }
 
-        try {
-            await this.waitDataBreakReady();
-        } catch (e) {
-            // data break was not accepted, remove request
-            this.writeSystemRegister(this.SYS_REG_BRK_CTRL, 0);
-            throw e;
+    // Passes the events in the FIFO to the streams, returns the number of events
+    public readRegisterEvents(): number {
+        let count = 0;
+        while (true) {
+            const head = this.readBreakRegister(this.EVT_ROW, this.EVT_REG_HEAD);
+            if ((head & this.EVT_HEAD_VALID) == 0) {
+                break;
+            }
+            const cycle = this.readBreakRegister(this.EVT_ROW, this.EVT_REG_CYCLE) >>> 0;
+            this.writeBreakRegister(this.EVT_ROW, this.EVT_REG_STATUS, 1);
+
+            const devId: DeviceID = (head >> 20) & 0xFF;
+            const watch = this.watches.get(devId);
+            if (watch) {
+                const reg: DeviceRegister = (head >> 16) & 0xF;
+                const value = head & 0xFFFF;
+                watch.values.set(reg, value);
+                watch.stream.push({ devId, reg, value, cycle });
+            }
+            count++;
+        }
+
+        if (this.readBreakRegister(this.EVT_ROW, this.EVT_REG_STATUS) & this.EVT_STATUS_OVERFLOW) {
+            console.warn('Register event FIFO overflow');
+            this.writeBreakRegister(this.EVT_ROW, this.EVT_REG_STATUS, 2);
+            count += this.resyncRegisterWatches();
         }
 
-        const replyWord = this.readSystemRegister(this.SYS_REG_BRK_DATA);
-        if ((replyWord & (1 << 13)) == 0) {
-            throw new Error(`Data break request denied, reply: ${replyWord.toString(8)}`);
+        return count;
+    }
+
+    // Events were dropped, so every watched register whose value differs from the last reported one
+    // gets an event with its current value. Changes after clearing the overflow are in the FIFO again.
+    private resyncRegisterWatches(): number {
+        const cycle = this.readCPUCycles();
+        let count = 0;
+        for (const [devId, watch] of this.watches) {
+            for (const [reg, last] of watch.values) {
+                const value = this.readPeripheralReg(devId, reg);
+                if (value != last) {
+                    watch.values.set(reg, value);
+                    watch.stream.push({ devId, reg, value, cycle });
+                    count++;
+                }
+            }
         }
+        return count;
+    }
+
+    public readCPUState(): CPUState {
+        // see io_controller.vhd for the layout
+        const w0 = this.readSystemRegister(this.SYS_REG_CPU_STATE + 0);
+        const w1 = this.readSystemRegister(this.SYS_REG_CPU_STATE + 1);
+        const w2 = this.readSystemRegister(this.SYS_REG_CPU_STATE + 2);
+        const w3 = this.readSystemRegister(this.SYS_REG_CPU_STATE + 3);
 
         return {
-            mb: (replyWord & 0o7777),
-            wordCountOverflow: (replyWord & (1 << 12)) != 0
+            ac:             (w0 >>  0) & 0o7777,
+            link:           (w0 & (1 << 12)) != 0,
+            mq:             (w0 >> 16) & 0o7777,
+
+            pc:             (w1 >>  0) & 0o7777,
+            instField:      (w1 >> 12) & 0o7,
+            instBuffer:     (w1 >> 15) & 0o7,
+            dataField:      (w1 >> 18) & 0o7,
+            saveField:      (w1 >> 21) & 0o77,
+            userField:      (w1 & (1 << 27)) != 0,
+            userBuffer:     (w1 & (1 << 28)) != 0,
+            saveUserField:  (w1 & (1 << 29)) != 0,
+
+            ma:             (w2 >>  0) & 0o7777,
+            mb:             (w2 >> 16) & 0o7777,
+
+            sc:             (w3 >>  0) & 0o37,
+            skip:           (w3 & (1 << 5)) != 0,
+            ion:            (w3 & (1 << 6)) != 0,
+            ionDelay:       (w3 & (1 << 7)) != 0,
+            intInhibit:     (w3 & (1 << 8)) != 0,
+            userInterrupt:  (w3 & (1 << 9)) != 0,
+            deferred:       (w3 & (1 << 10)) != 0,
+            majorState:     (w3 >> 11) & 0o7,
+            instruction:    (w3 >> 14) & 0o7,
+            eaeInstruction: (w3 >> 17) & 0o7,
+            run:            (w3 & (1 << 20)) != 0,
+            pause:          (w3 & (1 << 21)) != 0,
+            timeState:      (w3 >> 22) & 0o3,
         };
     }
 
-    private async waitDataBreakReady() {
+    // Only has an effect while the CPU is halted
+    public loadCPUState(state: CPUState) {
+        const w0 =
+            ((state.ac & 0o7777) << 0) |
+            (state.link ? (1 << 12) : 0) |
+            ((state.mq & 0o7777) << 16);
+
+        const w1 =
+            ((state.pc & 0o7777) << 0) |
+            ((state.instField & 0o7) << 12) |
+            ((state.instBuffer & 0o7) << 15) |
+            ((state.dataField & 0o7) << 18) |
+            ((state.saveField & 0o77) << 21) |
+            (state.userField ? (1 << 27) : 0) |
+            (state.userBuffer ? (1 << 28) : 0) |
+            (state.saveUserField ? (1 << 29) : 0);
+
+        const w2 =
+            ((state.ma & 0o7777) << 0) |
+            ((state.mb & 0o7777) << 16);
+
+        const w3 =
+            ((state.sc & 0o37) << 0) |
+            (state.skip ? (1 << 5) : 0) |
+            (state.ion ? (1 << 6) : 0) |
+            (state.ionDelay ? (1 << 7) : 0) |
+            (state.intInhibit ? (1 << 8) : 0) |
+            (state.userInterrupt ? (1 << 9) : 0) |
+            (state.deferred ? (1 << 10) : 0) |
+            ((state.majorState & 0o7) << 11) |
+            ((state.instruction & 0o7) << 14) |
+            ((state.eaeInstruction & 0o7) << 17);
+
+        this.writeSystemRegister(this.SYS_REG_CPU_STATE + 0, w0 >>> 0);
+        this.writeSystemRegister(this.SYS_REG_CPU_STATE + 1, w1 >>> 0);
+        this.writeSystemRegister(this.SYS_REG_CPU_STATE + 2, w2 >>> 0);
+        this.writeSystemRegister(this.SYS_REG_CPU_STATE + 3, w3 >>> 0);
+        this.writeSystemRegister(this.SYS_REG_CPU_CTRL, 1);
+    }
+
+    // Requests a halt at the end of the current instruction, returns whether the CPU was running
+    public async haltCPU(): Promise<boolean> {
+        if (this.isCPUHalted()) {
+            return false;
+        }
+
+        this.writeSystemRegister(this.SYS_REG_CPU_CTRL, 2);
+        try {
+            for (let i = 0; i < 1000; i++) {
+                if (this.isCPUHalted()) {
+                    return true;
+                }
+                await sleepUs(5);
+            }
+            throw new Error('Timeout waiting for CPU halt');
+        } finally {
+            this.writeSystemRegister(this.SYS_REG_CPU_CTRL, 0);
+        }
+    }
+
+    // Continues a CPU that halted at the end of a cycle like the CONT key, but without the debounce.
+    // With step set, the CPU halts again at the end of the next instruction.
+    public continueCPU(step: boolean) {
+        this.writeSystemRegister(this.SYS_REG_CPU_CTRL, step ? 6 : 4);
+    }
+
+    public clearHaltRequest() {
+        this.writeSystemRegister(this.SYS_REG_CPU_CTRL, 0);
+    }
+
+    // Halted at the end of a cycle and not about to continue
+    public isCPUStopped(): boolean {
+        const ctrl = this.readSystemRegister(this.SYS_REG_CPU_CTRL);
+        if ((ctrl & 1) == 0 || (ctrl & 4) != 0) {
+            return false;
+        }
+        const state = this.readSystemRegister(this.SYS_REG_CPU_STATE + 3);
+        return ((state >> 22) & 3) == TIME_STATE_TS4;
+    }
+
+    public readCPUCycles(): number {
+        return this.readSystemRegister(this.SYS_REG_CPU_CYCLES) >>> 0;
+    }
+
+    public isCPUHalted(): boolean {
+        return (this.readSystemRegister(this.SYS_REG_CPU_CTRL) & 1) != 0;
+    }
+
+    // Devices with a higher priority (0 to 3) get their data breaks first if several are pending
+    public setDataBreakPriority(devId: DeviceID, priority: number) {
+        this.writeBreakRegister(devId, this.BRK_REG_PRIORITY, priority & 3);
+    }
+
+    public async doDataBreak(devId: DeviceID, req: DataBreakRequest): Promise<DataBreakReply> {
+        metrics.dataBreaks.inc();
+        const endTimer = metrics.dataBreakLatency.startTimer();
+
+        while (this.brkBusy.has(devId)) {
+            await sleepUs(10);
+        }
+        this.brkBusy.add(devId);
+
+        try {
+            try {
+                // wait for old pending requests to finish
+                await this.waitDataBreakReady(devId);
+            } catch (e) {
+                // remove pending requests
+                console.warn(`Removed pending BRK of device ${devId}`);
+                metrics.dataBreakPendingRemoved.inc();
+                this.writeBreakRegister(devId, this.BRK_REG_CTRL, 0);
+            }
+
+            const requestWord: number = this.encodeDataBreak(req);
+            this.writeBreakRegister(devId, this.BRK_REG_DATA, requestWord);
+            this.writeBreakRegister(devId, this.BRK_REG_CTRL, 1);
+
+            try {
+                await this.waitDataBreakReady(devId);
+            } catch (e) {
+                // data break was not accepted, remove request
+                this.writeBreakRegister(devId, this.BRK_REG_CTRL, 0);
+                metrics.dataBreakTimeouts.inc();
+                throw e;
+            }
+
+            const replyWord = this.readBreakRegister(devId, this.BRK_REG_DATA);
+            endTimer();
+            if ((replyWord & (1 << 13)) == 0) {
+                throw new Error(`Data break request denied, reply: ${replyWord.toString(8)}`);
+            }
+
+            return {
+                mb: (replyWord & 0o7777),
+                wordCountOverflow: (replyWord & (1 << 12)) != 0
+            };
+        } finally {
+            this.brkBusy.delete(devId);
+        }
+    }
+
+    public async doDataBreakBurst(devId: DeviceID, req: DataBreakRequest, data: Uint16Array): Promise<DataBreakBurstReply> {
+        if (data.length > DATA_BREAK_BURST_SIZE) {
+            throw Error(`Data break bursts are limited to ${DATA_BREAK_BURST_SIZE} words`);
+        }
+        metrics.dataBreaks.inc(data.length);
+
+        while (this.burstBusy || this.brkBusy.has(devId)) {
+            await sleepUs(10);
+        }
+        this.burstBusy = true;
+        this.brkBusy.add(devId);
+
+        try {
+            try {
+                await this.waitDataBreakReady(devId);
+            } catch (e) {
+                console.warn(`Removed pending BRK of device ${devId}`);
+                metrics.dataBreakPendingRemoved.inc();
+                this.writeBreakRegister(devId, this.BRK_REG_CTRL, 0);
+            }
+
+            if (req.isWrite) {
+                for (let i = 0; i < data.length; i++) {
+                    this.regs[this.getBurstBufferAddr(i) / 4] = data[i] & 0o7777;
+                }
+            }
+            this.writeBreakRegister(devId, this.BRK_REG_DATA, this.encodeDataBreak(req));
+            this.writeBreakRegister(devId, this.BRK_REG_BURST, this.BURST_START | data.length);
+
+            // the burst runs at the speed of the CPU, so it's only given up if it doesn't make progress
+            let count = 0;
+            let idlePolls = 0;
+            while (true) {
+                const status = this.readBreakRegister(devId, this.BRK_REG_BURST);
+                const transferred = status & 0x1FF;
+                if ((status & this.BURST_RUNNING) == 0) {
+                    count = transferred;
+                    break;
+                }
+
+                if (transferred != count) {
+                    count = transferred;
+                    idlePolls = 0;
+                } else if (++idlePolls > this.BURST_MAX_IDLE_POLLS) {
+                    this.writeBreakRegister(devId, this.BRK_REG_BURST, 0);
+                    this.writeBreakRegister(devId, this.BRK_REG_CTRL, 0);
+                    metrics.dataBreakTimeouts.inc();
+                    throw new Error(`Data break burst stalled after ${count} of ${data.length} words`);
+                }
+                await sleepUs(20);
+            }
+
+            if (!req.isWrite) {
+                for (let i = 0; i < count; i++) {
+                    data[i] = this.regs[this.getBurstBufferAddr(i) / 4] & 0o7777;
+                }
+            }
+
+            const replyWord = this.readBreakRegister(devId, this.BRK_REG_DATA);
+            return {
+                count: count,
+                wordCountOverflow: (replyWord & (1 << 12)) != 0
+            };
+        } finally {
+            this.brkBusy.delete(devId);
+            this.burstBusy = false;
+        }
+    }
+
+    private async waitDataBreakReady(devId: DeviceID) {
         let controlWord = 0;
 
         for (let i = 0; i < 10; i++) {
-            controlWord = this.readSystemRegister(this.SYS_REG_BRK_CTRL);
+            controlWord = this.readBreakRegister(devId, this.BRK_REG_CTRL);
             if (controlWord == 1) {
                 return;
             }
@@ -178,29 +581,53 @@ export class IOController {
     }
 
     private readSystemRegister(reg: number) {
-        return this.ioMem.readUInt32LE(this.getMappingTableAddr(0, reg));
+        return this.regs[this.getMappingTableAddr(0, reg) / 4];
     }
 
     private writeSystemRegister(reg: number, val: number) {
-        return this.ioMem.writeUInt32LE(val, this.getMappingTableAddr(0, reg));
+        this.regs[this.getMappingTableAddr(0, reg) / 4] = val >>> 0;
     }
 
     private writeMappingTable(busId: number, reg: number, val: number) {
-        this.ioMem.writeUInt16LE(val, this.getMappingTableAddr(busId, reg));
+        this.regs[this.getMappingTableAddr(busId, reg) / 4] = val & 0xFFFF;
     }
 
     public readPeripheralReg(devId: number, reg: number): number {
-        return this.ioMem.readUInt16LE(this.getPeripheralRegAddr(devId, reg));
+        return this.regs[this.getPeripheralRegAddr(devId, reg) / 4] & 0xFFFF;
     }
 
     public writePeripheralReg(devId: number, reg: number,  data: number): void {
-        this.ioMem.writeUInt16LE(data, this.getPeripheralRegAddr(devId, reg));
+        // a bytewise write would be seen as two writes, e.g. popping a FIFO twice
+        this.regs[this.getPeripheralRegAddr(devId, reg) / 4] = data & 0xFFFF;
     }
 
     private getPeripheralRegAddr(devId: number, devReg: number): number {
         return (1 << 12) | (devId * (16 * 4) + devReg * 4);
     }
 
+    // The enable bit is in the lower byte of the enable register and the watch mask in the upper byte,
+    // so the register is only changed by read-modify-write to keep the other half
+    private updateEnableRegister(devId: DeviceID, keep: number, set: number) {
+        const ctrl = this.readPeripheralReg(devId, DeviceRegister.REG_ENABLED);
+        this.writePeripheralReg(devId, DeviceRegister.REG_ENABLED, (ctrl & keep) | set);
+    }
+
+    private readBreakRegister(devId: number, reg: number): number {
+        return this.regs[this.getBreakRegAddr(devId, reg) / 4];
+    }
+
+    private writeBreakRegister(devId: number, reg: number, val: number) {
+        this.regs[this.getBreakRegAddr(devId, reg) / 4] = val >>> 0;
+    }
+
+    private getBreakRegAddr(devId: number, reg: number): number {
+        return (1 << 13) | (devId * (16 * 4) + reg * 4);
+    }
+
+    private getBurstBufferAddr(index: number): number {
+        return (this.BURST_BUFFER_ROW * 16 + index) * 4;
+    }
+
     private getMappingTableAddr(busId: number, reg: number): number {
         return busId * (16 * 4) + reg * 4;
     }
@@ -0,0 +1,149 @@
+/*
+ *   SoCDP8 - A PDP-8/I implementation on a SoC
+ *   Copyright (C) 2019 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+import { promises } from 'fs';
+import { promisify } from 'util';
+import { deflate, inflate } from 'zlib';
+
+const deflateAsync = promisify(deflate);
+const inflateAsync = promisify(inflate);
+
+// Sparse image container for disk images. Layout, all numbers little endian:
+//  0: magic "SOCDP8IM"
+//  8: version (u16), reserved (u16)
+// 12: block size in bytes (u32)
+// 16: image size in bytes (u32)
+// 20: number of blocks (u32)
+// 24: reserved (8 bytes)
+// 32: block index, one entry of offset (u32) and length (u32) per block
+// followed by the extents. Blocks that only contain zeros have offset 0 and are not stored,
+// deflate compressed extents have the top bit of the length set.
+const MAGIC = 'SOCDP8IM';
+const VERSION = 1;
+const HEADER_SIZE = 32;
+const INDEX_ENTRY_SIZE = 8;
+const COMPRESSED = 0x80000000;
+export const CONTAINER_BLOCK_SIZE = 4096;
+
+// Reads a container into a buffer of the given size, only allocated blocks are read
+export async function readContainer(file: string, size: number): Promise<Buffer> {
+    const fh = await promises.open(file, 'r');
+    try {
+        const header = Buffer.alloc(HEADER_SIZE);
+        await fh.read(header, 0, HEADER_SIZE, 0);
+        if (header.toString('ascii', 0, 8) != MAGIC || header.readUInt16LE(8) != VERSION) {
+            throw Error(`${file} is not a supported image container`);
+        }
+
+        const blockSize = header.readUInt32LE(12);
+        const blockCount = header.readUInt32LE(20);
+
+        const index = Buffer.alloc(blockCount * INDEX_ENTRY_SIZE);
+        await fh.read(index, 0, index.length, HEADER_SIZE);
+
+        const data = Buffer.alloc(size);
+        for (let i = 0; i < blockCount; i++) {
+            const offset = index.readUInt32LE(i * INDEX_ENTRY_SIZE);
+            const length = index.readUInt32LE(i * INDEX_ENTRY_SIZE + 4);
+            const start = i * blockSize;
+            if (offset == 0 || start >= size) {
+                continue;
+            }
+
+            const extent = Buffer.alloc(length & ~COMPRESSED);
+            await fh.read(extent, 0, extent.length, offset);
+            const block = (length & COMPRESSED) ? await inflateAsync(extent) : extent;
+            block.copy(data, start, 0, Math.min(block.length, size - start));
+        }
+        return data;
+    } finally {
+        await fh.close();
+    }
+}
+
+// Writes the data as container, replacing the file atomically
+export async function writeContainer(file: string, data: Buffer): Promise<void> {
+    const blockCount = Math.ceil(data.length / CONTAINER_BLOCK_SIZE);
+
+    const header = Buffer.alloc(HEADER_SIZE);
+    header.write(MAGIC, 0, 'ascii');
+    header.writeUInt16LE(VERSION, 8);
+    header.writeUInt32LE(CONTAINER_BLOCK_SIZE, 12);
+    header.writeUInt32LE(data.length, 16);
+    header.writeUInt32LE(blockCount, 20);
+
+    const index = Buffer.alloc(blockCount * INDEX_ENTRY_SIZE);
+    const extents: Buffer[] = [];
+    let offset = HEADER_SIZE + index.length;
+
+    for (let i = 0; i < blockCount; i++) {
+        const block = data.subarray(i * CONTAINER_BLOCK_SIZE, (i + 1) * CONTAINER_BLOCK_SIZE);
+        if (isZero(block)) {
+            continue;
+        }
+
+        const compressed = await deflateAsync(block);
+        const useCompressed = compressed.length < block.length;
+        const extent = useCompressed ? compressed : Buffer.from(block);
+
+        index.writeUInt32LE(offset, i * INDEX_ENTRY_SIZE);
+        index.writeUInt32LE((extent.length | (useCompressed ? COMPRESSED : 0)) >>> 0, i * INDEX_ENTRY_SIZE + 4);
+        extents.push(extent);
+        offset += extent.length;
+    }
+
+    const tmpFile = file + '.tmp';
+    await promises.writeFile(tmpFile, Buffer.concat([header, index, ...extents]));
+    await promises.rename(tmpFile, file);
+}
+
+function isZero(block: Buffer): boolean {
+    for (let i = 0; i < block.length; i++) {
+        if (block[i] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Converts between raw images and containers: node ImageContainer.js in.dat out.img or in.img out.dat
+async function main(args: string[]) {
+    if (args.length != 2) {
+        console.log('Usage: ImageContainer <in> <out>, the direction is taken from the .img extension');
+        process.exit(1);
+    }
+
+    const [input, output] = args;
+    if (input.endsWith('.img')) {
+        const fh = await promises.open(input, 'r');
+        const header = Buffer.alloc(HEADER_SIZE);
+        await fh.read(header, 0, HEADER_SIZE, 0);
+        await fh.close();
+        const data = await readContainer(input, header.readUInt32LE(16));
+        await promises.writeFile(output, data);
+    } else {
+        await writeContainer(output, await promises.readFile(input));
+    }
+}
+
+if (require.main === module) {
+    main(process.argv.slice(2)).catch(e => {
+        console.error(e);
+        process.exit(1);
+    });
+}
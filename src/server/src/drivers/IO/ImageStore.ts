@@ -0,0 +1,152 @@
+/*
+ *   SoCDP8 - A PDP-8/I implementation on a SoC
+ *   Copyright (C) 2019 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+import { mkdirSync, readdirSync, readFileSync, promises } from 'fs';
+import { createHash } from 'crypto';
+import { readContainer, writeContainer } from './ImageContainer';
+
+// Content addressed store for the disk images of all systems. Each image is kept once as
+// container named by the SHA-256 of its raw data, systems only keep a reference to it.
+// refs.json counts the references so that images can be removed when no system uses them.
+// Unreferenced images are kept as cache so that uploading a well-known image again is free.
+export class ImageStore {
+    private readonly MAX_UNREFERENCED = 16;
+    private readonly dir: string;
+    private readonly refFile: string;
+    private images = new Set<string>();
+    private refs = new Map<string, number>();
+    private storing = new Map<string, Promise<void>>();
+    private writing: Promise<void> = Promise.resolve();
+
+    public constructor(dataDir: string) {
+        this.dir = dataDir + '/images';
+        this.refFile = this.dir + '/refs.json';
+        mkdirSync(this.dir, {recursive: true});
+
+        for (const file of readdirSync(this.dir)) {
+            const match = file.match(/^([0-9a-f]{64})\.img$/);
+            if (match) {
+                this.images.add(match[1]);
+            }
+        }
+
+        try {
+            const refs = JSON.parse(readFileSync(this.refFile).toString()) as Record<string, number>;
+            for (const [hash, count] of Object.entries(refs)) {
+                if (this.images.has(hash) && count > 0) {
+                    this.refs.set(hash, count);
+                }
+            }
+        } catch (e) {
+            // no references yet
+        }
+    }
+
+    public static hash(data: Uint8Array): string {
+        return createHash('sha256').update(data).digest('hex');
+    }
+
+    public has(hash: string): boolean {
+        return this.images.has(hash);
+    }
+
+    // Stores the image unless it's already known, returns the hash
+    public async put(data: Uint8Array, hash = ImageStore.hash(data)): Promise<string> {
+        if (this.images.has(hash)) {
+            return hash;
+        }
+
+        let storing = this.storing.get(hash);
+        if (!storing) {
+            storing = writeContainer(this.imageFile(hash), Buffer.from(data.buffer, data.byteOffset, data.length));
+            this.storing.set(hash, storing);
+        }
+
+        try {
+            await storing;
+        } finally {
+            this.storing.delete(hash);
+        }
+
+        this.images.add(hash);
+        this.queue(() => this.prune());
+        return hash;
+    }
+
+    // Reads an image into a new buffer of the given size
+    public async get(hash: string, size: number): Promise<Buffer> {
+        if (!this.images.has(hash)) {
+            throw Error(`Unknown image ${hash}`);
+        }
+        return await readContainer(this.imageFile(hash), size);
+    }
+
+    public ref(hash: string) {
+        this.refs.set(hash, (this.refs.get(hash) ?? 0) + 1);
+        this.queue(() => this.saveRefs());
+    }
+
+    public unref(hash: string) {
+        const count = (this.refs.get(hash) ?? 0) - 1;
+        if (count > 0) {
+            this.refs.set(hash, count);
+        } else {
+            this.refs.delete(hash);
+        }
+        this.queue(() => this.saveRefs());
+        this.queue(() => this.prune());
+    }
+
+    // Reference counts and removals are written in the background, in order
+    private queue(op: () => Promise<void>) {
+        this.writing = this.writing.then(op).catch(e => console.error('Image store:', e));
+    }
+
+    private async saveRefs() {
+        const tmpFile = this.refFile + '.tmp';
+        await promises.writeFile(tmpFile, JSON.stringify(Object.fromEntries(this.refs), null, 2));
+        await promises.rename(tmpFile, this.refFile);
+    }
+
+    // Removes the least recently stored images that no system references
+    private async prune() {
+        const unused = [...this.images].filter(hash => !this.refs.has(hash));
+        if (unused.length <= this.MAX_UNREFERENCED) {
+            return;
+        }
+
+        const ages = await Promise.all(unused.map(async hash => {
+            const stat = await promises.stat(this.imageFile(hash));
+            return { hash, mtime: stat.mtimeMs };
+        }));
+        ages.sort((a, b) => a.mtime - b.mtime);
+
+        for (const { hash } of ages.slice(0, ages.length - this.MAX_UNREFERENCED)) {
+            // could have been referenced while we were looking
+            if (this.refs.has(hash)) {
+                continue;
+            }
+            this.images.delete(hash);
+            await promises.rm(this.imageFile(hash), { force: true });
+        }
+    }
+
+    private imageFile(hash: string): string {
+        return `${this.dir}/${hash}.img`;
+    }
+}
@@ -0,0 +1,198 @@
+/*
+ *   SoCDP8 - A PDP-8/I implementation on a SoC
+ *   Copyright (C) 2019 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+import { promises } from 'fs';
+import { CYCLE_TIME_US } from './Peripheral';
+import { sleepMs, sleepUs } from '../../sleep';
+
+// Shared paper tape engine for the PT08 and PC04 readers and punches
+
+// Meters characters at the rate of a serial line. Tokens are refilled from the CPU cycle counter
+// so a tape is read at the same speed relative to the program no matter how often we poll.
+export class CharMeter {
+    // allows catching up after the event loop was blocked without exceeding the rate on average
+    private readonly BURST = 8;
+    private usPerChar = 1;
+    private cyclesPerChar = 1;
+    private tokens = 0;
+    private lastCycles: number;
+
+    public constructor(private readonly readCycleCounter: () => number) {
+        this.lastCycles = readCycleCounter();
+    }
+
+    public setRate(charsPerSecond: number) {
+        this.usPerChar = 1000000 / charsPerSecond;
+        // whole cycles and microseconds, the waits can't take fractions
+        this.cyclesPerChar = Math.max(Math.round(this.usPerChar / CYCLE_TIME_US), 1);
+    }
+
+    // Waits before polling again, fast lines are polled more than once per character
+    // because the CPU has to take each character before the next one can be transferred
+    public async idle(): Promise<void> {
+        if (this.usPerChar >= 2000) {
+            await sleepMs(1);
+        } else {
+            await sleepUs(Math.ceil(this.usPerChar / 2));
+        }
+    }
+
+    // Takes a token if one is available
+    public tryTake(): boolean {
+        const now = this.readCycleCounter();
+        const elapsed = (now - this.lastCycles) >>> 0;
+        this.lastCycles = now;
+
+        this.tokens = Math.min(this.tokens + elapsed / this.cyclesPerChar, this.BURST);
+        if (this.tokens >= 1) {
+            this.tokens--;
+            return true;
+        }
+        return false;
+    }
+}
+
+// Calls a function at most once per interval, a call that is suppressed is made when the interval ends
+export class Throttle {
+    private lastCall = 0;
+    private timer?: NodeJS.Timeout;
+
+    public constructor(private readonly intervalMs: number, private readonly func: () => void) {
+    }
+
+    public trigger() {
+        if (this.timer) {
+            return;
+        }
+
+        const wait = this.lastCall + this.intervalMs - Date.now();
+        if (wait <= 0) {
+            this.call();
+        } else {
+            this.timer = setTimeout(() => this.call(), wait);
+        }
+    }
+
+    private call() {
+        this.timer = undefined;
+        this.lastCall = Date.now();
+        this.func();
+    }
+}
+
+// Tape in a reader, the position is reported a few times per second
+export class TapeReader {
+    private readonly POS_INTERVAL_MS = 250;
+    private data = new Uint8Array(0);
+    private pos = 0;
+    private readonly posReport: Throttle;
+
+    public constructor(onPosition: (pos: number) => void) {
+        this.posReport = new Throttle(this.POS_INTERVAL_MS, () => onPosition(this.pos));
+    }
+
+    public load(data: Uint8Array) {
+        this.data = data;
+        this.pos = 0;
+    }
+
+    public next(): number | null {
+        if (this.pos >= this.data.length) {
+            return null;
+        }
+
+        const data = this.data[this.pos++];
+        this.posReport.trigger();
+        return data;
+    }
+}
+
+// Punch that collects the output in memory and appends it to a file. Listeners get the punched
+// characters in batches, the first character after a pause is passed on immediately so that
+// terminal output stays responsive.
+export class TapePunch {
+    private readonly FLUSH_INTERVAL_MS = 50;
+    private buffer = new Uint8Array(4096);
+    private fill = 0;
+    private fileFill = 0;
+    private eventFill = 0;
+    private writing?: Promise<void>;
+    private readonly flush: Throttle;
+
+    public constructor(private readonly file: string, private readonly onPunch: (chars: number[]) => void) {
+        this.flush = new Throttle(this.FLUSH_INTERVAL_MS, () => this.onFlush());
+    }
+
+    // Starts a new punch file
+    public async reset(): Promise<void> {
+        await this.writing;
+        this.fill = 0;
+        this.fileFill = 0;
+        this.eventFill = 0;
+        await promises.writeFile(this.file, new Uint8Array(0));
+    }
+
+    public punch(data: number) {
+        if (this.fill == this.buffer.length) {
+            this.compact();
+        }
+        this.buffer[this.fill++] = data;
+        this.flush.trigger();
+    }
+
+    // Drops the parts that were written to the file and passed on, grows the buffer if it's still full
+    private compact() {
+        const done = Math.min(this.fileFill, this.eventFill);
+        let target = this.buffer;
+        if (this.fill - done > this.buffer.length / 2) {
+            target = new Uint8Array(this.buffer.length * 2);
+        }
+        target.set(this.buffer.subarray(done, this.fill));
+        this.buffer = target;
+        this.fill -= done;
+        this.fileFill -= done;
+        this.eventFill -= done;
+    }
+
+    private onFlush() {
+        if (this.eventFill < this.fill) {
+            this.onPunch(Array.from(this.buffer.subarray(this.eventFill, this.fill)));
+            this.eventFill = this.fill;
+        }
+
+        if (!this.writing && this.fileFill < this.fill) {
+            this.writing = this.writeFile();
+        }
+    }
+
+    private async writeFile() {
+        try {
+            while (this.fileFill < this.fill) {
+                // copy and count because the buffer can be compacted while the write is running
+                const count = this.fill - this.fileFill;
+                await promises.appendFile(this.file, this.buffer.slice(this.fileFill, this.fill));
+                this.fileFill += count;
+            }
+        } catch (e) {
+            console.error(`Punch: Couldn't write ${this.file}`, e);
+            this.fileFill = this.fill;
+        } finally {
+            this.writing = undefined;
+        }
+    }
+}
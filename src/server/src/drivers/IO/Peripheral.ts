@@ -16,9 +16,14 @@
  *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
-import { DataBreakRequest, DataBreakReply } from "./DataBreak";
+import { DataBreakRequest, DataBreakReply, DataBreakBurstReply } from "./DataBreak";
+import { RegisterEventStream } from "./RegisterEvent";
 import { PeripheralConfiguration, DeviceID } from '../../types/PeripheralTypes';
 import { PeripheralInAction, PeripheralOutAction } from "../../types/PeripheralAction";
+import { sleepMs, sleepUs } from "../../sleep";
+
+// Nominal duration of a PDP-8/I memory cycle, the unit of the CPU cycle counter
+export const CYCLE_TIME_US = 1.5;
 
 export enum DeviceRegister {
     REG_ENABLED     = 0,
@@ -45,9 +50,27 @@ export interface IOContext {
     writeRegister(reg: DeviceRegister, value: number): void;
     dataBreak(req: DataBreakRequest): Promise<DataBreakReply>;
 
+    // Up to DATA_BREAK_BURST_SIZE words in one burst, the data of the request is ignored. The words to write
+    // into memory are taken from data, for reads data receives the words from memory.
+    dataBreakBurst(req: DataBreakRequest, data: Uint16Array): Promise<DataBreakBurstReply>;
+
+    // Changes of the given registers by IOTs, the stream ends when the system is stopped
+    watchRegisters(regs: DeviceRegister[]): RegisterEventStream;
+
+    // Free-running 32 bit counter of executed memory cycles
+    readCycleCounter(): number;
+
     emitEvent(action: PeripheralInAction): void;
 }
 
+// State of a device in a machine snapshot
+export interface PeripheralSnapshot {
+    regs: [DeviceRegister, number][];
+
+    // whatever the driver needs to continue, e.g. head positions
+    driver?: unknown;
+}
+
 export abstract class Peripheral {
     private keepRunning = true;
     private ctx?: IOContext;
@@ -80,9 +103,34 @@ export abstract class Peripheral {
     public abstract getConfiguration(): PeripheralConfiguration;
     public abstract reconfigure(conf: PeripheralConfiguration): void;
 
+    // Called while the CPU is halted, but the CPU continues at the first await.
+    // So the state has to be copied before that.
     public async saveState(): Promise<void> {
     }
 
+    // Registers that only hold state and can be written back when a snapshot is restored.
+    // FIFOs and registers that start something when written must not be listed.
+    protected getStateRegisters(): DeviceRegister[] {
+        return [];
+    }
+
+    // Called while the CPU is halted, like saveState
+    public saveSnapshot(): PeripheralSnapshot {
+        return {
+            regs: this.getStateRegisters().map((reg): [DeviceRegister, number] => [reg, this.io.readRegister(reg)]),
+        };
+    }
+
+    // Called before run() when the system is restored from a snapshot
+    public restoreSnapshot(snapshot: PeripheralSnapshot): void {
+        const stateRegs = this.getStateRegisters();
+        for (const [reg, value] of snapshot.regs) {
+            if (stateRegs.includes(reg)) {
+                this.io.writeRegister(reg, value);
+            }
+        }
+    }
+
     public stop(): void {
         this.keepRunning = false;
     }
@@ -122,4 +170,32 @@ export abstract class Peripheral {
     protected get keepAlive(): boolean {
         return this.keepRunning;
     }
+
+    // Waits until the CPU executed the given number of memory cycles. Device timing based on
+    // this stays consistent with the program when the CPU is slowed down, stalled or halted.
+    // Fractional cycle counts are rounded up, the counter only counts whole cycles.
+    protected async waitCycles(cycles: number): Promise<void> {
+        cycles = Math.ceil(cycles);
+        const io = this.io;
+        const start = io.readCycleCounter();
+
+        while (this.keepAlive) {
+            const elapsed = (io.readCycleCounter() - start) >>> 0;
+            if (elapsed >= cycles) {
+                return;
+            }
+
+            // sleep for the remaining time at nominal speed but check regularly in case the CPU is faster
+            const remainingUs = (cycles - elapsed) * CYCLE_TIME_US;
+            if (remainingUs > 1000) {
+                await sleepMs(Math.min(Math.floor(remainingUs / 1000), 10));
+            } else {
+                await sleepUs(Math.ceil(remainingUs));
+            }
+        }
+    }
+
+    protected async waitMachineUs(us: number): Promise<void> {
+        await this.waitCycles(Math.ceil(us / CYCLE_TIME_US));
+    }
 }
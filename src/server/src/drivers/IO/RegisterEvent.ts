@@ -0,0 +1,90 @@
+/*
+ *   SoCDP8 - A PDP-8/I implementation on a SoC
+ *   Copyright (C) 2019 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+import { DeviceID } from '../../types/PeripheralTypes';
+import { DeviceRegister } from './Peripheral';
+
+// A device register that was changed by an IOT, see io_controller.vhd
+export interface RegisterEvent {
+    devId: DeviceID;
+    reg: DeviceRegister;
+    value: number;
+
+    // CPU cycle counter when the change was detected
+    cycle: number;
+}
+
+// Queue of the register events of one device that can be consumed with for await.
+// The iteration ends when the stream is closed.
+export class RegisterEventStream implements AsyncIterableIterator<RegisterEvent> {
+    private queue: RegisterEvent[] = [];
+    private waiter?: (res: IteratorResult<RegisterEvent>) => void;
+    private closed = false;
+
+    public push(event: RegisterEvent) {
+        if (this.closed) {
+            return;
+        }
+
+        if (this.waiter) {
+            const waiter = this.waiter;
+            this.waiter = undefined;
+            waiter({ value: event, done: false });
+        } else {
+            this.queue.push(event);
+        }
+    }
+
+    // Number of events that were received but not consumed yet
+    public get pending(): number {
+        return this.queue.length;
+    }
+
+    public close() {
+        this.closed = true;
+        this.queue = [];
+        if (this.waiter) {
+            const waiter = this.waiter;
+            this.waiter = undefined;
+            waiter({ value: undefined, done: true });
+        }
+    }
+
+    public next(): Promise<IteratorResult<RegisterEvent>> {
+        const event = this.queue.shift();
+        if (event) {
+            return Promise.resolve({ value: event, done: false });
+        }
+
+        if (this.closed) {
+            return Promise.resolve({ value: undefined, done: true });
+        }
+
+        return new Promise(resolve => this.waiter = resolve);
+    }
+
+    public async return(): Promise<IteratorResult<RegisterEvent>> {
+        this.close();
+        return { value: undefined, done: true };
+    }
+
+    public [Symbol.asyncIterator](): AsyncIterableIterator<RegisterEvent> {
+        return this;
+    }
+}
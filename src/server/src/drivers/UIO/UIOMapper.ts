@@ -16,10 +16,38 @@
  *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
-import { readdirSync, readFileSync, openSync, closeSync } from 'fs';
+import { readdirSync, readFileSync, openSync, closeSync, read, writeSync } from 'fs';
 import { O_SYNC, O_RDWR } from 'constants';
+import { promisify } from 'util';
 const mmap = require("mmap-io");
 
+const readAsync = promisify(read);
+
+// Interrupt of a UIO device. The kernel masks the interrupt when it fires,
+// so it has to be enabled again before waiting for the next one.
+export class UIOInterrupt {
+    public constructor(private readonly fd: number) {
+    }
+
+    public enable(): void {
+        const buf = Buffer.alloc(4);
+        buf.writeUInt32LE(1, 0);
+        writeSync(this.fd, buf);
+    }
+
+    // Resolves with the total interrupt count, fails if the device has no interrupt.
+    // The read blocks a thread of the libuv pool while waiting.
+    public async wait(): Promise<number> {
+        const buf = Buffer.alloc(4);
+        await readAsync(this.fd, buf, 0, 4, null);
+        return buf.readUInt32LE(0);
+    }
+
+    public close(): void {
+        closeSync(this.fd);
+    }
+}
+
 export class UIOMapper {
     private SYS_PATH = "/sys/class/uio/";
 
@@ -31,6 +59,12 @@ export class UIOMapper {
         return buffer;
     }
 
+    public openInterrupt(name: string): UIOInterrupt {
+        let uioName = this.findUIO(name);
+        let fd = openSync('/dev/' + uioName, O_RDWR);
+        return new UIOInterrupt(fd);
+    }
+
     private findUIO(name: string): string {
         const basePath = this.SYS_PATH;
         let uioDir = readdirSync(basePath);
@@ -0,0 +1,215 @@
+/*
+ *   SoCDP8 - A PDP-8/I implementation on a SoC
+ *   Copyright (C) 2019 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+import { randomBytes } from 'crypto';
+import { promisify } from 'util';
+import { deflate, inflate } from 'zlib';
+import { SoCDP8 } from './SoCDP8';
+import { ImageStore } from '../drivers/IO/ImageStore';
+import { DeviceID } from '../types/PeripheralTypes';
+import { crc32, IMAGE_CHUNK_SIZE, ImageChunk, ImageCompression, ImageTransferInfo, ImageTransferRequest } from '../types/ImageTransfer';
+
+const deflateAsync = promisify(deflate);
+const inflateAsync = promisify(inflate);
+
+interface Transfer {
+    transferId: string;
+    id: DeviceID;
+    unit: number;
+    direction: 'upload' | 'download';
+    compression: ImageCompression;
+
+    // the image being assembled for uploads, a snapshot of the image for downloads
+    data: Uint8Array;
+    snapshotId?: string;
+    received: boolean[];
+    lastUse: number;
+}
+
+// Keeps the state of chunked image transfers, see types/ImageTransfer.ts for the protocol.
+// Transfers are not bound to a socket so that a client can resume after reconnecting.
+export class ImageTransferManager {
+    private readonly TRANSFER_TIMEOUT_MS = 10 * 60 * 1000;
+    private readonly MAX_IMAGE_SIZE = 16 * 1024 * 1024;
+    private transfers = new Map<string, Transfer>();
+
+    constructor(private readonly pdp8: SoCDP8, private readonly images: ImageStore) {
+    }
+
+    public async open(req: ImageTransferRequest): Promise<ImageTransferInfo> {
+        this.expireTransfers();
+
+        if (req.transferId) {
+            const transfer = this.transfers.get(req.transferId);
+            if (transfer && transfer.id == req.id && transfer.unit == req.unit && transfer.direction == req.direction) {
+                if (req.snapshotId && req.snapshotId != transfer.snapshotId) {
+                    throw Error(`Transfer ${req.transferId} has a different snapshot`);
+                }
+                transfer.lastUse = Date.now();
+                return this.describe(transfer);
+            }
+            // unknown or expired, start over
+        }
+
+        let data: Uint8Array;
+        let snapshotId: string | undefined;
+        let complete = req.direction == 'download';
+        if (req.direction == 'upload') {
+            if (req.size === undefined || req.size < 0 || req.size > this.MAX_IMAGE_SIZE) {
+                throw Error(`Invalid image size ${req.size}`);
+            }
+            if (req.hash && this.images.has(req.hash)) {
+                // known image, no chunks need to be sent
+                data = await this.images.get(req.hash, req.size);
+                complete = true;
+            } else {
+                data = new Uint8Array(req.size);
+            }
+        } else {
+            data = await this.pdp8.readPeripheralImage(req.id, req.unit);
+            snapshotId = ImageStore.hash(data);
+
+            // a new snapshot can only continue a download if the image didn't change in between
+            if (req.snapshotId && req.snapshotId != snapshotId) {
+                throw Error(`Image changed since the download started`);
+            }
+        }
+
+        const chunkCount = Math.ceil(data.length / IMAGE_CHUNK_SIZE);
+        const transfer: Transfer = {
+            transferId: randomBytes(8).toString('hex'),
+            id: req.id,
+            unit: req.unit,
+            direction: req.direction,
+            compression: req.compression,
+            data: data,
+            snapshotId: snapshotId,
+            received: new Array(chunkCount).fill(complete),
+            lastUse: Date.now(),
+        };
+        this.transfers.set(transfer.transferId, transfer);
+
+        return this.describe(transfer);
+    }
+
+    public async writeChunk(chunk: ImageChunk): Promise<void> {
+        const transfer = this.getTransfer(chunk.transferId, 'upload');
+        const [start, end] = this.chunkRange(transfer, chunk.index);
+
+        let data = new Uint8Array(chunk.data);
+        if (transfer.compression == 'deflate') {
+            // a chunk never inflates to more than its share of the image
+            data = await inflateAsync(data, { maxOutputLength: end - start });
+        }
+
+        if (data.length != end - start) {
+            throw Error(`Chunk ${chunk.index} has ${data.length} bytes, expected ${end - start}`);
+        }
+
+        if (crc32(data) != chunk.crc) {
+            throw Error(`Checksum error in chunk ${chunk.index}`);
+        }
+
+        transfer.data.set(data, start);
+        transfer.received[chunk.index] = true;
+    }
+
+    public async readChunk(transferId: string, index: number): Promise<ImageChunk> {
+        const transfer = this.getTransfer(transferId, 'download');
+        const [start, end] = this.chunkRange(transfer, index);
+
+        const raw = transfer.data.subarray(start, end);
+        let data: Uint8Array = raw;
+        if (transfer.compression == 'deflate') {
+            data = await deflateAsync(raw);
+        }
+
+        return { transferId, index, crc: crc32(raw), data };
+    }
+
+    // Completes the transfer, uploads are written to the device
+    public async close(transferId: string): Promise<void> {
+        const transfer = this.transfers.get(transferId);
+        if (!transfer) {
+            throw Error(`Unknown transfer ${transferId}`);
+        }
+
+        if (transfer.direction == 'upload') {
+            const missing = this.describe(transfer).missing;
+            if (missing.length > 0) {
+                throw Error(`Transfer incomplete, ${missing.length} chunks missing`);
+            }
+            await this.pdp8.writePeripheralImage(transfer.id, transfer.unit, transfer.data);
+            await this.cacheImage(transfer.data);
+        }
+
+        this.transfers.delete(transferId);
+    }
+
+    // Keeps uploaded images in the store so that uploading them again doesn't transfer any chunks
+    private async cacheImage(data: Uint8Array) {
+        try {
+            await this.images.put(data);
+        } catch (e) {
+            console.warn(`Couldn't store uploaded image: ${e}`);
+        }
+    }
+
+    private getTransfer(transferId: string, direction: 'upload' | 'download'): Transfer {
+        const transfer = this.transfers.get(transferId);
+        if (!transfer || transfer.direction != direction) {
+            throw Error(`Unknown transfer ${transferId}`);
+        }
+        transfer.lastUse = Date.now();
+        return transfer;
+    }
+
+    private chunkRange(transfer: Transfer, index: number): [number, number] {
+        if (!Number.isInteger(index) || index < 0 || index >= transfer.received.length) {
+            throw Error(`Invalid chunk ${index}`);
+        }
+        const start = index * IMAGE_CHUNK_SIZE;
+        return [start, Math.min(start + IMAGE_CHUNK_SIZE, transfer.data.length)];
+    }
+
+    private describe(transfer: Transfer): ImageTransferInfo {
+        const missing: number[] = [];
+        transfer.received.forEach((ok, i) => {
+            if (!ok) {
+                missing.push(i);
+            }
+        });
+
+        return {
+            transferId: transfer.transferId,
+            size: transfer.data.length,
+            chunkCount: transfer.received.length,
+            missing: missing,
+            snapshotId: transfer.snapshotId,
+        };
+    }
+
+    private expireTransfers() {
+        const now = Date.now();
+        for (const [id, transfer] of this.transfers) {
+            if (now - transfer.lastUse > this.TRANSFER_TIMEOUT_MS) {
+                this.transfers.delete(id);
+            }
+        }
+    }
+}
@@ -0,0 +1,59 @@
+/*
+ *   SoCDP8 - A PDP-8/I implementation on a SoC
+ *   Copyright (C) 2019 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+import { promises } from 'fs';
+import { CPUState, MAJOR_STATE_BREAK } from '../drivers/IO/CPUState';
+import { PeripheralSnapshot } from '../drivers/IO/Peripheral';
+import { DeviceID } from '../types/PeripheralTypes';
+
+// State of the machine that is not contained in core.dat and the peripheral images
+export interface MachineSnapshot {
+    version: number;
+
+    // whether the CPU should continue after the snapshot was restored
+    running: boolean;
+
+    cpu: CPUState;
+    devices: ({ id: DeviceID } & PeripheralSnapshot)[];
+}
+
+export const SNAPSHOT_VERSION = 2;
+const SNAPSHOT_FILE = 'snapshot.json';
+
+export async function readSnapshot(dir: string): Promise<MachineSnapshot | undefined> {
+    try {
+        const json = await promises.readFile(`${dir}/${SNAPSHOT_FILE}`, 'utf-8');
+        const snapshot = JSON.parse(json) as MachineSnapshot;
+        if (snapshot.version != SNAPSHOT_VERSION) {
+            console.warn(`Ignoring snapshot with version ${snapshot.version}`);
+            return undefined;
+        }
+        const majorState = snapshot.cpu?.majorState;
+        if (!Number.isInteger(majorState) || majorState < 0 || majorState > MAJOR_STATE_BREAK) {
+            console.warn(`Ignoring snapshot with major state ${majorState}`);
+            return undefined;
+        }
+        return snapshot;
+    } catch (e) {
+        return undefined;
+    }
+}
+
+export async function writeSnapshot(dir: string, snapshot: MachineSnapshot): Promise<void> {
+    await promises.writeFile(`${dir}/${SNAPSHOT_FILE}`, JSON.stringify(snapshot, null, 4));
+}
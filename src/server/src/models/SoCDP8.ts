@@ -17,8 +17,9 @@
  */
 
 import { DeviceID } from './../types/PeripheralTypes';
-import { UIOMapper } from '../drivers/UIO/UIOMapper';
-import { Console } from '../drivers/Console/Console';
+import { UIOInterrupt, UIOMapper } from '../drivers/UIO/UIOMapper';
+import { Console, SwitchEvent } from '../drivers/Console/Console';
+import { KEY_PULSE_DEPTH, PulseKey } from '../drivers/Console/ConsoleConstants';
 import { CoreMemory } from "../drivers/CoreMemory/CoreMemory";
 import { IOController } from '../drivers/IO/IOController';
 import { Peripheral, IOContext } from '../drivers/IO/Peripheral';
@@ -30,26 +31,63 @@ import { RF08 } from '../peripherals/RF08';
 import { DF32 } from '../peripherals/DF32';
 import { KW8I } from '../peripherals/KW8I';
 import { RK08 } from '../peripherals/RK08';
-import { sleepMs } from '../sleep';
+import { RK8E } from '../peripherals/RK8E';
+import { LP08 } from '../peripherals/LP08';
+import { sleepMs, sleepUs } from '../sleep';
+import { PhaseTimer } from '../PhaseTimer';
+import { metrics } from '../Metrics';
 import { SystemConfiguration } from '../types/SystemConfiguration';
 import { PeripheralConfiguration } from '../types/PeripheralTypes';
 import { ConsoleState } from '../types/ConsoleTypes';
-import { Disk } from '../drivers/IO/Disk';
+import { Disk, ImageDevice } from '../drivers/IO/Disk';
 import { PeripheralInAction, PeripheralOutAction } from '../types/PeripheralAction';
+import { MachineSnapshot, readSnapshot, SNAPSHOT_VERSION, writeSnapshot } from './MachineSnapshot';
+import { MAJOR_STATE_FETCH, TIME_STATE_TS4 } from '../drivers/IO/CPUState';
+import { ImageStore } from '../drivers/IO/ImageStore';
+import { CoreRange, CoreSegment } from '../types/CoreSegments';
+import { parseTape, TapeLoadRequest, TapeLoadResult } from '../types/TapeFormat';
+import { checkPanelSteps, PanelMacroResult, PanelStep } from '../types/PanelMacro';
+import { Breakpoint, BREAKPOINT_COUNT, BreakpointState, checkBreakpoint } from '../types/Breakpoint';
+import { checkDebugCommands, DEBUG_DEFAULT_TIMEOUT_MS, DebugCommand, DebugRegisters, DebugReply, DebugResult, disassemble } from '../types/DebugProtocol';
 
 export interface IOListener {
     onPeripheralEvent(id: number, action: PeripheralInAction): void
+    onSwitchEvents(events: SwitchEvent[]): void
+    onBreakpointHit(state: BreakpointState): void
 }
 
+const MOMENTARY_KEYS = new Map<string, PulseKey>([
+    ['start', PulseKey.START],
+    ['load', PulseKey.LOAD],
+    ['dep', PulseKey.DEP],
+    ['exam', PulseKey.EXAM],
+    ['cont', PulseKey.CONT],
+    ['stop', PulseKey.STOP],
+]);
+
+// The fixed head disks lose data if a break is late because the disk keeps rotating,
+// the DECtape is more tolerant and the moving head disks wait for the CPU
+const DATA_BREAK_PRIORITY = new Map<DeviceID, number>([
+    [DeviceID.DEV_ID_RF08, 3],
+    [DeviceID.DEV_ID_DF32, 3],
+    [DeviceID.DEV_ID_TC08, 2],
+    [DeviceID.DEV_ID_RK08, 1],
+    [DeviceID.DEV_ID_RK8E, 1],
+]);
+
 export class SoCDP8 {
+    private readonly PULSE_POLL_MS = 10;
+    private readonly STEP_TIMEOUT_MS = 100;
+
     private cons: Console;
     private mem: CoreMemory;
     private io: IOController;
 
     private currentConf?: SystemConfiguration;
     private peripherals: Peripheral[] = [];
+    private macroRunning = false;
 
-    public constructor(private readonly dataDir: string, private ioListener: IOListener) {
+    public constructor(private readonly dataDir: string, private readonly images: ImageStore, private ioListener: IOListener) {
         const uio = new UIOMapper();
         const memBuf = uio.mapUio('socdp8_core', 'socdp8_core_mem');
         const consBuf = uio.mapUio('socdp8_console', 'socdp8_console');
@@ -58,57 +96,172 @@ export class SoCDP8 {
         this.cons = new Console(consBuf);
         this.mem = new CoreMemory(memBuf);
         this.io = new IOController(ioBuf);
+
+        this.runSwitchEventLoop(uio.openInterrupt('socdp8_console'));
+        this.runIOInterruptLoop(uio.openInterrupt('socdp8_io'));
+    }
+
+    // Passes on the edges of the physical switches as soon as the console raises its interrupt
+    private async runSwitchEventLoop(irq: UIOInterrupt) {
+        this.cons.setEventIrq(true);
+        try {
+            while (true) {
+                // the interrupt is level triggered, so events that are still queued fire right away
+                irq.enable();
+                await irq.wait();
+                const events = this.cons.readSwitchEvents();
+                if (events.length > 0) {
+                    this.ioListener.onSwitchEvents(events);
+                }
+            }
+        } catch (e) {
+            // older device trees have no console interrupt, the console is still polled
+            console.warn(`No console interrupt: ${e}`);
+            this.cons.setEventIrq(false);
+            irq.close();
+        }
+    }
+
+    // The I/O interrupt reports register events and hits of breakpoints with notify. The hits are cleared
+    // to end the interrupt, so they're only visible in the state passed to the listener.
+    private async runIOInterruptLoop(irq: UIOInterrupt) {
+        try {
+            while (true) {
+                irq.enable();
+                await irq.wait();
+                this.io.readRegisterEvents();
+
+                const state = this.readBreakpoints();
+                const notified = [];
+                for (let i = 0; i < BREAKPOINT_COUNT; i++) {
+                    if (state.hits[i] && state.breakpoints[i]?.notify) {
+                        notified.push(i);
+                    }
+                }
+                if (notified.length > 0) {
+                    this.io.clearBreakpointHits(notified);
+                    this.ioListener.onBreakpointHit(state);
+                }
+            }
+        } catch (e) {
+            console.warn(`No I/O interrupt, breakpoint hits are not reported: ${e}`);
+            irq.close();
+        }
+
+        // without the interrupt, the register events are polled
+        while (true) {
+            this.io.readRegisterEvents();
+            await sleepMs(1);
+        }
     }
 
     public async activateSystem(sys: SystemConfiguration, dir: string) {
+        const timer = new PhaseTimer();
+
+        // The images are read while the current system is being stopped
+        const files = Promise.all([
+            readSnapshot(dir),
+            promises.readFile(`${dir}/core.dat`).catch(e => {
+                console.warn('Core memory not loaded: ' + e);
+                return undefined;
+            }),
+        ]);
+
         // Stop current system
         await this.stopCPU();
-
-        // Stop current peripherals
         for (const perph of this.peripherals) {
             perph.stop();
         }
+        this.io.closeRegisterWatches();
+        timer.mark('stop');
+
+        const [snapshot, core] = await files;
+        timer.mark('read');
+
+        if (snapshot) {
+            await this.haltAtCycleEnd();
+            timer.mark('halt');
+        }
 
         // Restore config
         this.io.configureExtensions({
             eae: sys.cpuExtensions.eae,
             kt8i: sys.cpuExtensions.kt8i,
+            fastEae: sys.cpuExtensions.fastEae,
             maxMemField: sys.maxMemField
         });
 
-        // Restore peripherals
-        this.peripherals = [];
+        // Restore peripherals, their images are only loaded on first access
         this.io.clearDeviceTable();
-
-        for (const perph of sys.peripherals) {
-            const peripheral = this.createPeripheral(perph, dir);
-
-            const devId = peripheral.getDeviceID();
-
-            const ioCtx: IOContext = {
-                readRegister: reg => this.io.readPeripheralReg(devId, reg),
-                writeRegister: (reg, val) => this.io.writePeripheralReg(devId, reg, val),
-                dataBreak: req => this.io.doDataBreak(req),
-                emitEvent: action => this.ioListener.onPeripheralEvent(devId, action),
-            };
-            peripheral.setIOContext(ioCtx);
-
-            this.io.registerPeripheral(peripheral.getBusConnections(), devId);
-
-            this.peripherals.push(peripheral);
+        this.peripherals = sys.peripherals.map(conf => this.setupPeripheral(conf, dir, snapshot));
+        for (const peripheral of this.peripherals) {
             peripheral.run();
         }
+        timer.mark('peripherals');
 
         // Restore core memory
-        try {
-            const core = await promises.readFile(`${dir}/core.dat`);
-            this.mem.loadCore(new Uint16Array(core.buffer));
-        } catch (e) {
-            console.warn('Core memory not loaded: ' + e);
+        if (core) {
+            this.mem.loadCore(new Uint16Array(core.buffer, core.byteOffset, core.length / 2));
+        } else {
             this.mem.clear();
         }
+        timer.mark('core');
 
         this.currentConf = sys;
+
+        // Restore CPU registers
+        if (snapshot) {
+            this.io.loadCPUState(snapshot.cpu);
+            if (snapshot.running) {
+                await this.pressKey('cont');
+            }
+            timer.mark('cpu');
+        }
+
+        console.log(`Activated ${sys.name} in ${timer.report()}`);
+    }
+
+    private setupPeripheral(conf: PeripheralConfiguration, dir: string, snapshot?: MachineSnapshot): Peripheral {
+        const peripheral = this.createPeripheral(conf, dir);
+        const devId = peripheral.getDeviceID();
+
+        const device = DeviceID[devId];
+        const regWrites = metrics.peripheralOps.labels({ device, op: 'register-write' });
+        const dataBreaks = metrics.peripheralOps.labels({ device, op: 'data-break' });
+        const events = metrics.peripheralOps.labels({ device, op: 'event' });
+
+        const ioCtx: IOContext = {
+            readRegister: reg => this.io.readPeripheralReg(devId, reg),
+            writeRegister: (reg, val) => {
+                regWrites.inc();
+                this.io.writePeripheralReg(devId, reg, val);
+            },
+            dataBreak: req => {
+                dataBreaks.inc();
+                return this.io.doDataBreak(devId, req);
+            },
+            dataBreakBurst: (req, data) => {
+                dataBreaks.inc(data.length);
+                return this.io.doDataBreakBurst(devId, req, data);
+            },
+            watchRegisters: regs => this.io.watchRegisters(devId, regs),
+            readCycleCounter: () => this.io.readCPUCycles(),
+            emitEvent: action => {
+                events.inc();
+                this.ioListener.onPeripheralEvent(devId, action);
+            },
+        };
+        peripheral.setIOContext(ioCtx);
+
+        this.io.registerPeripheral(peripheral.getBusConnections(), devId);
+        this.io.setDataBreakPriority(devId, DATA_BREAK_PRIORITY.get(devId) ?? 0);
+
+        const savedDevice = snapshot?.devices.find(dev => dev.id == devId);
+        if (savedDevice) {
+            peripheral.restoreSnapshot(savedDevice);
+        }
+
+        return peripheral;
     }
 
     public async saveSystemState(dir: string) {
@@ -118,15 +271,36 @@ export class SoCDP8 {
 
         console.log('Saving state to ' + dir);
 
+        // The snapshot is only consistent while the CPU is halted. The peripherals copy their images
+        // before their first await, so the CPU can continue while the files are written.
+        const wasRunning = await this.stopCPU();
+
+        let saving: Promise<unknown> = Promise.resolve();
         try {
-            // Save core memory
             const memory = this.mem.dumpCore();
-            await promises.writeFile(`${dir}/core.dat`, Buffer.from(memory.buffer));
+            const snapshot: MachineSnapshot = {
+                version: SNAPSHOT_VERSION,
+                running: wasRunning,
+                cpu: this.io.readCPUState(),
+                devices: this.peripherals.map(perph => ({
+                    id: perph.getDeviceID(),
+                    ...perph.saveSnapshot(),
+                })),
+            };
 
-            // Save all peripherals
-            for (const peripheral of this.peripherals) {
-                await peripheral.saveState();
+            saving = Promise.all([
+                promises.writeFile(`${dir}/core.dat`, Buffer.from(memory.buffer)),
+                writeSnapshot(dir, snapshot),
+                ...this.peripherals.map(peripheral => peripheral.saveState()),
+            ]);
+        } finally {
+            if (wasRunning) {
+                await this.pressKey('cont');
             }
+        }
+
+        try {
+            await saving;
         } catch (e) {
             console.warn('Error saving state: ' + e);
         }
@@ -134,24 +308,59 @@ export class SoCDP8 {
         console.log('State saved');
     }
 
-    private async stopCPU() {
-        const isRunning = this.readConsoleState().lamps.run;
-        if (!isRunning) {
+    private async stopCPU(): Promise<boolean> {
+        return await this.io.haltCPU();
+    }
+
+    // Registers can only be restored when the CPU halted at the end of a cycle, i.e. in TS4.
+    // After power-up, the timing is in TS1 instead. A CPU that never ran has no state to keep,
+    // so it executes a single HLT to get there. Otherwise, an EXAM cycle is used: it leaves AC,
+    // L, the flags and the interrupt state alone, and the registers it changes are restored.
+    private async haltAtCycleEnd() {
+        const state = this.io.readCPUState();
+        if (state.timeState == TIME_STATE_TS4 && !state.run) {
             return;
         }
 
         const wasOverride = this.cons.isSwitchOverridden();
-
         this.cons.setSwitchOverride(true);
-        this.setSwitch('stop', true);
-        while (this.readConsoleState().lamps.run) {
-            await sleepMs(1);
+        const switches = this.cons.readSwitches();
+
+        if (this.io.readCPUCycles() == 0) {
+            const word0 = this.mem.peekWord(0);
+            this.mem.pokeWord(0, 0o7402);
+            this.cons.writeSwitches({ ...switches, dataField: 0, instField: 0, swr: 0 });
+            await this.pressKey('load');
+            await this.pressKey('start');
+            while (!this.io.isCPUStopped()) {
+                await sleepMs(1);
+            }
+            this.mem.pokeWord(0, word0);
+        } else {
+            await this.pressKey('exam');
+            while (!this.io.isCPUStopped()) {
+                await sleepMs(1);
+            }
+            this.io.loadCPUState(state);
         }
-        this.setSwitch('stop', false);
 
+        this.cons.writeSwitches(switches);
         this.cons.setSwitchOverride(wasOverride);
     }
 
+    // Waits until the console pressed and released the key
+    private async pressKey(key: string) {
+        const pulseKey = MOMENTARY_KEYS.get(key);
+        if (pulseKey === undefined) {
+            throw Error(`${key} is not a momentary key`);
+        }
+
+        this.cons.pulseKey(pulseKey);
+        do {
+            await sleepMs(this.PULSE_POLL_MS);
+        } while (this.cons.isPulseBusy());
+    }
+
     private createPeripheral(conf: PeripheralConfiguration, dir: string): Peripheral {
         switch (conf.id) {
             case DeviceID.DEV_ID_PT08:
@@ -159,21 +368,23 @@ export class SoCDP8 {
             case DeviceID.DEV_ID_TT2:
             case DeviceID.DEV_ID_TT3:
             case DeviceID.DEV_ID_TT4:
-                return new PT08(conf);
+                return new PT08(conf, dir);
             case DeviceID.DEV_ID_PC04:
-                return new PC04(conf);
+                return new PC04(conf, dir);
             case DeviceID.DEV_ID_TC08:
                 return new TC08(conf);
             case DeviceID.DEV_ID_DF32:
-                return new DF32(conf, dir);
+                return new DF32(conf, dir, this.images);
             case DeviceID.DEV_ID_RF08:
-                return new RF08(conf, dir);
+                return new RF08(conf, dir, this.images);
             case DeviceID.DEV_ID_RK08:
-                return new RK08(conf, dir);
+                return new RK08(conf, dir, this.images);
             case DeviceID.DEV_ID_KW8I:
                 return new KW8I(conf);
             case DeviceID.DEV_ID_RK8E:
-                throw Error("RK8E not supported");
+                return new RK8E(conf, dir, this.images);
+            case DeviceID.DEV_ID_LP08:
+                return new LP08(conf, dir);
         }
     }
 
@@ -192,8 +403,235 @@ export class SoCDP8 {
         this.mem.clear();
     }
 
-    public writeCoreMemory(addr: number, fragment: number[]) {
-        this.mem.writeData(addr, fragment);
+    public writeCoreMemory(segments: CoreSegment[]) {
+        for (const seg of segments) {
+            this.mem.writeData(seg.address, seg.data);
+        }
+    }
+
+    public readCoreMemory(ranges: CoreRange[]): CoreSegment[] {
+        return ranges.map(range => ({ address: range.address, data: this.mem.readData(range.address, range.length) }));
+    }
+
+    // Loads a RIM or BIN tape directly into core and sets PC and IF to the start address,
+    // the CPU is left halted so the program can be started with CONT
+    public async loadTape(req: TapeLoadRequest): Promise<TapeLoadResult> {
+        if (!this.currentConf) {
+            throw Error(`No system loaded`);
+        }
+        const maxField = this.currentConf.maxMemField;
+
+        const image = parseTape(req.data, req.format);
+        const startField = req.startField ?? 0;
+        const startAddress = req.startAddress ?? 0o200;
+
+        if (!Number.isInteger(startField) || startField < 0 || startField > maxField) {
+            throw Error(`Start field ${startField} is not installed`);
+        }
+        if (!Number.isInteger(startAddress) || startAddress < 0 || startAddress > 0o7777) {
+            throw Error(`Invalid start address ${startAddress}`);
+        }
+        for (const seg of image.segments) {
+            if (seg.field > maxField) {
+                throw Error(`Tape loads field ${seg.field} which is not installed`);
+            }
+        }
+
+        await this.stopCPU();
+        await this.haltAtCycleEnd();
+
+        for (const seg of image.segments) {
+            this.mem.writeData(seg.field * 4096 + seg.address, seg.data);
+        }
+
+        // the stopped instruction is abandoned, CONT starts with the fetch of the start address
+        const state = this.io.readCPUState();
+        this.io.loadCPUState({
+            ...state,
+            pc: startAddress,
+            instField: startField,
+            instBuffer: startField,
+            majorState: MAJOR_STATE_FETCH,
+            deferred: false,
+        });
+
+        return {
+            wordCount: image.wordCount,
+            checksum: image.checksum,
+            startField: startField,
+            startAddress: startAddress,
+        };
+    }
+
+    // Executes the steps with the key timing of the console. The switches are only set in the console
+    // while a key is pulsed, so the macro runs at the speed of the debounced manual timing and isn't
+    // slowed down by host round trips. Afterwards, the panel switches are left where the macro set them.
+    public async runPanelMacro(steps: PanelStep[]): Promise<PanelMacroResult> {
+        checkPanelSteps(steps);
+        if (this.macroRunning) {
+            throw Error('A panel macro is already running');
+        }
+
+        this.macroRunning = true;
+        try {
+            const switches = this.cons.readSwitches();
+            let keyCount = 0;
+            let setSwitches = false;
+
+            for (const step of steps) {
+                switch (step.op) {
+                    case 'swr': switches.swr = step.value; setSwitches = true; break;
+                    case 'df': switches.dataField = step.value; setSwitches = true; break;
+                    case 'if': switches.instField = step.value; setSwitches = true; break;
+                    case 'key':
+                        while (this.cons.getPulseQueueFill() >= KEY_PULSE_DEPTH) {
+                            await sleepMs(this.PULSE_POLL_MS);
+                        }
+                        this.cons.pulseKey(MOMENTARY_KEYS.get(step.key) as PulseKey, switches);
+                        keyCount++;
+                        break;
+                }
+            }
+
+            while (this.cons.isPulseBusy()) {
+                await sleepMs(this.PULSE_POLL_MS);
+            }
+
+            if (setSwitches) {
+                this.cons.setSwitchOverride(true);
+                this.cons.writeSwitches(switches);
+            }
+
+            return { keyCount, lamps: this.cons.readBrightness() };
+        } finally {
+            this.macroRunning = false;
+        }
+    }
+
+    public setBreakpoint(slot: number, bp: Breakpoint | null): BreakpointState {
+        checkBreakpoint(slot, bp);
+        this.io.setBreakpoint(slot, bp);
+        this.io.clearBreakpointHits([slot]);
+        return this.readBreakpoints();
+    }
+
+    public readBreakpoints(): BreakpointState {
+        const breakpoints: (Breakpoint | null)[] = [];
+        for (let i = 0; i < BREAKPOINT_COUNT; i++) {
+            breakpoints.push(this.io.getBreakpoint(i));
+        }
+        return { breakpoints, hits: this.io.readBreakpointHits() };
+    }
+
+    public clearBreakpointHits(): BreakpointState {
+        this.io.clearBreakpointHits([0, 1, 2, 3]);
+        return this.readBreakpoints();
+    }
+
+    // Executes a batch of debugger commands. Stepping and running use the continue request of the CPU
+    // instead of the console keys, so they're not limited by the debounce of the manual timing.
+    // The CPU is left halted after the first command that needs it halted.
+    public async runDebugCommands(cmds: DebugCommand[]): Promise<DebugReply> {
+        checkDebugCommands(cmds);
+
+        const results: DebugResult[] = [];
+        try {
+            for (const cmd of cmds) {
+                results.push(await this.runDebugCommand(cmd));
+            }
+        } catch (e) {
+            return { results, error: `${e}` };
+        }
+        return { results };
+    }
+
+    private async runDebugCommand(cmd: DebugCommand): Promise<DebugResult> {
+        switch (cmd.op) {
+            case 'regs':
+                return { op: 'regs', regs: this.readDebugRegisters() };
+            case 'halt':
+                await this.haltForDebug();
+                return { op: 'halt', regs: this.readDebugRegisters() };
+            case 'step':
+                await this.haltForDebug();
+                try {
+                    for (let i = 0; i < cmd.count; i++) {
+                        this.io.continueCPU(true);
+                        await this.waitCPUStopped(this.STEP_TIMEOUT_MS);
+                    }
+                } finally {
+                    this.io.clearHaltRequest();
+                }
+                return { op: 'step', regs: this.readDebugRegisters() };
+            case 'run-until':
+                return { op: 'run-until', ...await this.runUntil(cmd.address, cmd.timeoutMs ?? DEBUG_DEFAULT_TIMEOUT_MS) };
+            case 'read':
+                return { op: 'read', address: cmd.address, data: Array.from(this.mem.readData(cmd.address, cmd.length)) };
+            case 'write':
+                this.mem.writeData(cmd.address, cmd.data);
+                return { op: 'write', address: cmd.address, length: cmd.data.length };
+            case 'disasm':
+                return { op: 'disasm', lines: disassemble(cmd.address, this.mem.readData(cmd.address, cmd.length)) };
+        }
+    }
+
+    // Runs with a temporary PC breakpoint in a free slot, halts the CPU if the address isn't reached in time
+    private async runUntil(address: number, timeoutMs: number): Promise<{ reached: boolean, regs: DebugRegisters }> {
+        const slot = this.readBreakpoints().breakpoints.findIndex(bp => bp === null);
+        if (slot < 0) {
+            throw Error('Running until an address needs a free breakpoint');
+        }
+
+        await this.haltForDebug();
+        this.io.setBreakpoint(slot, { type: 'pc', field: address >> 12, value: address & 0o7777, halt: true, notify: false });
+        this.io.clearBreakpointHits([slot]);
+        try {
+            this.io.continueCPU(false);
+            const deadline = Date.now() + timeoutMs;
+            while (!this.io.isCPUStopped()) {
+                if (Date.now() >= deadline) {
+                    await this.stopCPU();
+                    break;
+                }
+                await sleepMs(1);
+            }
+            return { reached: this.io.readBreakpointHits()[slot], regs: this.readDebugRegisters() };
+        } finally {
+            this.io.setBreakpoint(slot, null);
+            this.io.clearBreakpointHits([slot]);
+        }
+    }
+
+    private async haltForDebug() {
+        await this.stopCPU();
+        await this.haltAtCycleEnd();
+    }
+
+    // A single instruction takes a few microseconds, so it's polled without yielding for long
+    private async waitCPUStopped(timeoutMs: number) {
+        const deadline = Date.now() + timeoutMs;
+        while (!this.io.isCPUStopped()) {
+            if (Date.now() >= deadline) {
+                throw Error('Timeout waiting for the CPU to stop');
+            }
+            await sleepUs(1);
+        }
+    }
+
+    private readDebugRegisters(): DebugRegisters {
+        const state = this.io.readCPUState();
+        return {
+            pc: (state.pc + (state.skip ? 1 : 0)) & 0o7777,
+            instField: state.instField,
+            dataField: state.dataField,
+            ac: state.ac,
+            link: state.link,
+            mq: state.mq,
+            ma: state.ma,
+            mb: state.mb,
+            ion: state.ion,
+            run: state.run,
+        };
     }
 
     public readConsoleState(): ConsoleState {
@@ -217,13 +655,30 @@ export class SoCDP8 {
 
     public requestDeviceAction(id: number, action: PeripheralOutAction) {
         const peripheral = this.findPeripheral(id);
+        metrics.peripheralOps.labels({ device: DeviceID[peripheral.getDeviceID()], op: 'action' }).inc();
         peripheral.requestAction(action);
     }
 
-    public readPeripheralBlock(id: number, block: number): Uint16Array {
+    public async readPeripheralBlock(id: number, block: number): Promise<Uint16Array> {
         const peripheral = this.findPeripheral(id);
         const disk = peripheral as unknown as Disk;
-        return disk.readBlock(block);
+        return await disk.readBlock(block);
+    }
+
+    public async readPeripheralImage(id: number, unit: number): Promise<Uint8Array> {
+        return await this.findImageDevice(id).readImage(unit);
+    }
+
+    public async writePeripheralImage(id: number, unit: number, data: Uint8Array): Promise<void> {
+        await this.findImageDevice(id).writeImage(unit, data);
+    }
+
+    private findImageDevice(id: number): ImageDevice {
+        const peripheral = this.findPeripheral(id);
+        if (!('readImage' in peripheral)) {
+            throw Error(`Peripheral ${id} has no image`);
+        }
+        return peripheral as unknown as ImageDevice;
     }
 
     public updatePeripheralConfig(id: number, config: PeripheralConfiguration) {
@@ -231,8 +686,19 @@ export class SoCDP8 {
         peripheral.reconfigure(config);
     }
 
+    // Momentary keys are pressed and released by the console when set, clearing them does nothing
     public setSwitch(sw: string, state: boolean): void {
-        this.cons.setSwitchOverride(true);
+        const pulseKey = MOMENTARY_KEYS.get(sw);
+        if (pulseKey !== undefined) {
+            if (state) {
+                this.cons.pulseKey(pulseKey);
+            }
+            return;
+        }
+
+        if (!this.cons.isSwitchOverridden()) {
+            this.cons.setSwitchOverride(true);
+        }
         const switches = this.cons.readSwitches();
         switch (sw) {
             case 'df0': switches.dataField = this.setBitValue(switches.dataField, 2, state); break;
@@ -256,12 +722,6 @@ export class SoCDP8 {
             case 'swr10': switches.swr = this.setBitValue(switches.swr, 1, state); break;
             case 'swr11': switches.swr = this.setBitValue(switches.swr, 0, state); break;
 
-            case 'start': switches.start = (state ? 1 : 0); break;
-            case 'load': switches.load = (state ? 1 : 0); break;
-            case 'dep': switches.dep = (state ? 1 : 0); break;
-            case 'exam': switches.exam = (state ? 1 : 0); break;
-            case 'cont': switches.cont = (state ? 1 : 0); break;
-            case 'stop': switches.stop = (state ? 1 : 0); break;
             case 'sing_step': switches.singStep = (state ? 1 : 0); break;
             case 'sing_inst': switches.singInst = (state ? 1 : 0); break;
         }
@@ -16,15 +16,16 @@
  *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
-import { mkdirSync, readdirSync, readFileSync, promises, rmdirSync } from 'fs';
+import { copyFileSync, mkdirSync, readdirSync, readFileSync, promises, rmdirSync, rmSync } from 'fs';
 import { SystemConfiguration, getDefaultSysConf } from '../types/SystemConfiguration';
 import { randomBytes } from 'crypto';
+import { ImageStore } from '../drivers/IO/ImageStore';
 
 export class SystemConfigurationList {
     private readonly sysDir: string;
     private systems: Map<string, SystemConfiguration> = new Map();
 
-    constructor(private readonly baseDir: string) {
+    constructor(private readonly baseDir: string, private readonly images: ImageStore) {
         this.sysDir = this.baseDir + '/systems/';
         mkdirSync(this.sysDir, {recursive: true});
 
@@ -96,8 +97,59 @@ export class SystemConfigurationList {
         this.systems.set(sys.id, sys);
     }
 
+    // Creates a system with the configuration and the saved state of another one,
+    // the disk images are shared through the image store instead of being copied
+    public copySystem(src: SystemConfiguration, name: string): SystemConfiguration {
+        const sys: SystemConfiguration = JSON.parse(JSON.stringify(src));
+        sys.name = name;
+        sys.id = this.generateSystemId();
+
+        // the system is only registered and the images referenced once everything was copied
+        const dir = this.getDirForSystem(sys);
+        const refs: string[] = [];
+        try {
+            mkdirSync(dir, {recursive: true});
+            this.copyDir(this.getDirForSystem(src), dir, refs);
+        } catch (e) {
+            rmSync(dir, {recursive: true, force: true});
+            throw e;
+        }
+
+        for (const hash of refs) {
+            this.images.ref(hash);
+        }
+        this.addSystem(sys, sys.id);
+
+        return sys;
+    }
+
+    private copyDir(srcDir: string, dir: string, refs: string[]) {
+        for (const entry of readdirSync(srcDir, {withFileTypes: true})) {
+            if (entry.name == 'system.json' || entry.name.endsWith('.tmp')) {
+                continue;
+            }
+
+            const srcPath = `${srcDir}/${entry.name}`;
+            const path = `${dir}/${entry.name}`;
+            if (entry.isDirectory()) {
+                mkdirSync(path);
+                this.copyDir(srcPath, path, refs);
+            } else {
+                copyFileSync(srcPath, path);
+                if (entry.name.endsWith('.ref')) {
+                    refs.push(readFileSync(path).toString().trim());
+                }
+            }
+        }
+    }
+
     public deleteSystem(sys: SystemConfiguration) {
         const dir = this.getDirForSystem(sys);
+        for (const file of readdirSync(dir)) {
+            if (file.endsWith('.ref')) {
+                this.images.unref(readFileSync(`${dir}/${file}`).toString().trim());
+            }
+        }
         rmdirSync(dir, {recursive: true});
         this.systems.delete(sys.id);
     }
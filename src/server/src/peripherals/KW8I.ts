@@ -16,7 +16,7 @@
  *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
-import { Peripheral, IOContext } from '../drivers/IO/Peripheral';
+import { Peripheral, DeviceRegister } from '../drivers/IO/Peripheral';
 import { KW8IConfiguration } from '../types/PeripheralTypes';
 
 export class KW8I extends Peripheral {
@@ -29,6 +29,10 @@ export class KW8I extends Peripheral {
     }
 
     public reconfigure(newConf: KW8IConfiguration) {
+        // without sync to the real clock, the ticks are derived from the CPU cycle counter
+        const regB = (newConf.use50Hz ? 1 : 0) | (newConf.useExternalClock ? 2 : 0);
+        this.io.writeRegister(DeviceRegister.REG_B, regB);
+
         Object.assign(this.conf, newConf);
     }
 
@@ -36,6 +40,11 @@ export class KW8I extends Peripheral {
         return [0o13];
     }
 
+    protected getStateRegisters(): DeviceRegister[] {
+        return [DeviceRegister.REG_A, DeviceRegister.REG_B];
+    }
+
     public async run(): Promise<void> {
+        this.reconfigure(this.conf);
     }
 }
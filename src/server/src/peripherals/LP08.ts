@@ -0,0 +1,289 @@
+/*
+ *   SoCDP8 - A PDP-8/I implementation on a SoC
+ *   Copyright (C) 2019 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+import { promises } from 'fs';
+import { Peripheral, IOContext, DeviceRegister, PeripheralSnapshot } from '../drivers/IO/Peripheral';
+import { ImageDevice } from '../drivers/IO/Disk';
+import { PeripheralOutAction, PrinterJob } from '../types/PeripheralAction';
+import { LP08Configuration } from '../types/PeripheralTypes';
+import { tracer } from '../Trace';
+
+// Line printer that spools each job to a text file. The hardware buffers the characters
+// in a FIFO, see lp08.vhd. A job ends when the program didn't print for a while and clients
+// are only notified at the end of a page or job, the spool can then be downloaded as image.
+export class LP08 extends Peripheral implements ImageDevice {
+    private readonly TRACE_PRINT = tracer.op('print');
+    private readonly JOB_IDLE_MS = 5000;
+    private readonly LINES_PER_PAGE = 66;
+    private readonly LF = 0o12;
+    private readonly FF = 0o14;
+    private readonly DEL = 0o177;
+
+    private readonly spoolDir: string;
+    private jobs: PrinterJob[] = [];
+    private job?: PrinterJob;
+    private lastJobId = 0;
+    private pageLines = 0;
+    private buffer: number[] = [];
+    private writing: Promise<void> = Promise.resolve();
+    private idleTimer?: NodeJS.Timeout;
+    private reopenJobId?: number;
+
+    constructor(private readonly conf: LP08Configuration, dir: string) {
+        super(conf.id);
+        this.spoolDir = dir + '/lp08';
+    }
+
+    public getConfiguration(): LP08Configuration {
+        return this.conf;
+    }
+
+    public reconfigure(newConf: LP08Configuration) {
+        Object.assign(this.conf, newConf);
+    }
+
+    public getBusConnections(): number[] {
+        return [0o65, 0o66];
+    }
+
+    // Register A is the head of the FIFO and writing register C removes it, so characters
+    // that are still in the FIFO are not part of a snapshot.
+    protected getStateRegisters(): DeviceRegister[] {
+        return [DeviceRegister.REG_B];
+    }
+
+    public saveSnapshot(): PeripheralSnapshot {
+        return { ...super.saveSnapshot(), driver: { openJob: this.job?.id } };
+    }
+
+    public restoreSnapshot(snapshot: PeripheralSnapshot): void {
+        super.restoreSnapshot(snapshot);
+        const driver = snapshot.driver as { openJob?: number } | undefined;
+        this.reopenJobId = driver?.openJob;
+    }
+
+    public requestAction(action: PeripheralOutAction): any {
+        switch (action.type) {
+            case 'printer-list':
+                this.sendJobs();
+                break;
+            case 'printer-clear':
+                this.clearJobs();
+                break;
+        }
+    }
+
+    public async run(): Promise<void> {
+        const io = this.io;
+
+        await this.loadJobs();
+        this.sendJobs();
+        if (this.job) {
+            this.idleTimer = setTimeout(() => this.finishJob(), this.JOB_IDLE_MS);
+        }
+
+        this.drain(io);
+        for await (const _ of io.watchRegisters([DeviceRegister.REG_A])) {
+            this.drain(io);
+        }
+
+        this.finishJob();
+        await this.writing;
+    }
+
+    public async readImage(unit: number): Promise<Uint8Array> {
+        const job = this.jobs.find(j => j.id == unit);
+        if (!job) {
+            throw Error(`Unknown print job ${unit}`);
+        }
+        await this.writing;
+        return await promises.readFile(this.jobFile(job.id));
+    }
+
+    public async writeImage(unit: number, data: Uint8Array): Promise<void> {
+        throw Error('Print jobs can only be downloaded');
+    }
+
+    // Takes all characters out of the FIFO, a character that arrives while we
+    // are draining causes another event so nothing is left behind
+    private drain(io: IOContext) {
+        while (true) {
+            const head = io.readRegister(DeviceRegister.REG_A);
+            if ((head & 0x8000) == 0) {
+                break;
+            }
+            io.writeRegister(DeviceRegister.REG_C, 1);
+            this.print(head & 0x7F);
+        }
+    }
+
+    private print(char: number) {
+        tracer.event(this.getDeviceID(), this.TRACE_PRINT, char);
+
+        if (this.idleTimer) {
+            clearTimeout(this.idleTimer);
+        }
+        this.idleTimer = setTimeout(() => this.finishJob(), this.JOB_IDLE_MS);
+
+        if (char == 0 || char == this.DEL) {
+            return;
+        }
+
+        if (!this.job) {
+            this.startJob();
+        }
+        const job = this.job!;
+
+        this.buffer.push(char);
+        job.size++;
+
+        if (char == this.LF) {
+            job.lines++;
+            this.pageLines++;
+            if (this.pageLines == this.LINES_PER_PAGE) {
+                this.endPage();
+            }
+        } else if (char == this.FF) {
+            this.endPage();
+        }
+    }
+
+    private startJob() {
+        this.job = { id: ++this.lastJobId, pages: 0, lines: 0, size: 0, done: false };
+        this.jobs.push(this.job);
+        this.pageLines = 0;
+        this.buffer = [];
+        this.queueWrite(this.job.id, true);
+    }
+
+    private endPage() {
+        if (!this.job) {
+            return;
+        }
+        this.job.pages++;
+        this.pageLines = 0;
+        this.queueWrite(this.job.id, false);
+        this.sendJobs();
+    }
+
+    private finishJob() {
+        if (this.idleTimer) {
+            clearTimeout(this.idleTimer);
+            this.idleTimer = undefined;
+        }
+
+        const job = this.job;
+        if (!job) {
+            return;
+        }
+
+        // a partial page still counts as page
+        if (this.pageLines > 0 || this.buffer.length > 0) {
+            job.pages++;
+        }
+        this.queueWrite(job.id, false);
+        job.done = true;
+        this.job = undefined;
+        this.sendJobs();
+    }
+
+    // Writes are chained so that the pages end up in order
+    private queueWrite(id: number, create: boolean) {
+        const data = Uint8Array.from(this.buffer);
+        this.buffer = [];
+
+        this.writing = this.writing.then(async () => {
+            try {
+                await promises.mkdir(this.spoolDir, { recursive: true });
+                if (create) {
+                    await promises.writeFile(this.jobFile(id), data);
+                } else {
+                    await promises.appendFile(this.jobFile(id), data);
+                }
+            } catch (e) {
+                // let the program see the error with PSKE
+                console.error(`LP08: Couldn't write job ${id}`, e);
+                const regB = this.io.readRegister(DeviceRegister.REG_B);
+                this.io.writeRegister(DeviceRegister.REG_B, regB | 2);
+            }
+        });
+    }
+
+    private clearJobs() {
+        const finished = this.jobs.filter(j => j.done);
+        this.jobs = this.jobs.filter(j => !j.done);
+
+        this.writing = this.writing.then(async () => {
+            for (const job of finished) {
+                await promises.rm(this.jobFile(job.id), { force: true });
+            }
+        });
+        this.sendJobs();
+    }
+
+    // Jobs from previous runs are kept until they are cleared
+    private async loadJobs(): Promise<void> {
+        let files: string[];
+        try {
+            files = await promises.readdir(this.spoolDir);
+        } catch (e) {
+            // nothing was printed yet
+            return;
+        }
+
+        for (const file of files) {
+            const match = file.match(/^job-(\d+)\.txt$/);
+            if (!match) {
+                continue;
+            }
+
+            const data = await promises.readFile(`${this.spoolDir}/${file}`);
+            const job: PrinterJob = { id: Number.parseInt(match[1]), pages: 0, lines: 0, size: data.length, done: true };
+            let pageLines = 0;
+            for (const c of data) {
+                if (c == this.LF) {
+                    job.lines++;
+                    pageLines++;
+                }
+                if (c == this.FF || pageLines == this.LINES_PER_PAGE) {
+                    job.pages++;
+                    pageLines = 0;
+                }
+            }
+            if (job.id == this.reopenJobId) {
+                // the job that was open when the snapshot was taken continues
+                job.done = false;
+                this.job = job;
+                this.pageLines = pageLines;
+            } else if (pageLines > 0) {
+                job.pages++;
+            }
+            this.jobs.push(job);
+        }
+        this.jobs.sort((a, b) => a.id - b.id);
+        this.lastJobId = this.jobs.reduce((max, j) => Math.max(max, j.id), 0);
+    }
+
+    private sendJobs() {
+        this.io.emitEvent({type: 'printer-jobs', jobs: this.jobs.map(j => ({...j}))});
+    }
+
+    private jobFile(id: number): string {
+        return `${this.spoolDir}/job-${id}.txt`;
+    }
+}
@@ -17,17 +17,24 @@
  */
 
 import { Peripheral, IOContext, DeviceRegister } from '../drivers/IO/Peripheral';
-import { sleepMs } from '../sleep';
+import { CharMeter, TapePunch, TapeReader } from '../drivers/IO/PaperTape';
 import { PeripheralOutAction } from '../types/PeripheralAction';
 import { PC04Configuration } from '../types/PeripheralTypes';
+import { tracer } from '../Trace';
 
 export class PC04 extends Peripheral {
+    private readonly TRACE_READ = tracer.op('tape-read');
+    private readonly TRACE_PUNCH = tracer.op('punch');
     private readerActive: boolean = false;
-    private readerTape: number[] = [];
-    private readerTapePos: number = 0;
+    private readonly reader: TapeReader;
+    private readonly punch: TapePunch;
+    private readerMeter?: CharMeter;
+    private punchMeter?: CharMeter;
 
-    constructor(private readonly conf: PC04Configuration) {
+    constructor(private readonly conf: PC04Configuration, dir: string) {
         super(conf.id);
+        this.reader = new TapeReader(pos => this.io.emitEvent({type: 'readerPos', pos: pos}));
+        this.punch = new TapePunch(dir + '/pc04-punch.bin', chars => this.io.emitEvent({type: 'punch', chars: chars}));
     }
 
     public getConfiguration(): PC04Configuration {
@@ -42,17 +49,24 @@ export class PC04 extends Peripheral {
         io.writeRegister(DeviceRegister.REG_B, (regB & 0o0777) | (baudSel << 9));
 
         Object.assign(this.conf, newConf);
+
+        const cps = this.baudRateToCPS(this.conf.baudRate);
+        this.readerMeter?.setRate(cps);
+        this.punchMeter?.setRate(cps);
     }
 
     public getBusConnections(): number[] {
         return [0o01, 0o02];
     }
 
+    protected getStateRegisters(): DeviceRegister[] {
+        return [DeviceRegister.REG_A, DeviceRegister.REG_B, DeviceRegister.REG_C, DeviceRegister.REG_D];
+    }
+
     public requestAction(action: PeripheralOutAction): any {
         switch (action.type) {
             case 'reader-tape-set':
-                this.readerTape = Array.from(action.tapeData as Buffer);
-                this.readerTapePos = 0;
+                this.reader.load(action.tapeData);
                 break;
             case 'reader-set-active':
                 this.readerActive = action.active;
@@ -61,19 +75,22 @@ export class PC04 extends Peripheral {
     }
 
     public async run(): Promise<void> {
+        const io = this.io;
+
+        this.readerMeter = new CharMeter(io.readCycleCounter);
+        this.punchMeter = new CharMeter(io.readCycleCounter);
         this.reconfigure(this.conf);
+        await this.punch.reset();
 
-        const io = this.io;
-        this.runReader(io);
-        this.runPunch(io);
+        this.runReader(io, this.readerMeter);
+        this.runPunch(io, this.punchMeter);
     }
 
-    public async runReader(io: IOContext): Promise<void> {
+    public async runReader(io: IOContext, meter: CharMeter): Promise<void> {
         while (this.keepAlive) {
-            const wantData =(io.readRegister(DeviceRegister.REG_B) & 1) != 0;
-            if (!wantData || !this.readerActive) {
-                // no data request
-                await sleepMs(1);
+            const wantData = (io.readRegister(DeviceRegister.REG_B) & 1) != 0;
+            if (!wantData || !this.readerActive || !meter.tryTake()) {
+                await meter.idle();
                 continue;
             }
 
@@ -84,44 +101,38 @@ export class PC04 extends Peripheral {
 
                 const regB = io.readRegister(DeviceRegister.REG_B);
                 io.writeRegister(DeviceRegister.REG_B, regB & 0o7000 | 2); // notify of new data
+            } else {
+                await meter.idle();
             }
-
-            await sleepMs(1000 / this.baudRateToCPS(this.conf.baudRate));
         }
     }
 
     private readNextFromTape(): number | null {
-        if (this.readerTapePos < this.readerTape.length) {
-            const data = this.readerTape[this.readerTapePos++];
-            console.log(`PC04: Read ${data.toString(16)}, ${this.readerTapePos} / ${this.readerTape.length}`);
-            this.io.emitEvent({type: 'readerPos', pos: this.readerTapePos});
-            return data;
-        } else {
-            return null;
+        const data = this.reader.next();
+        if (data !== null) {
+            tracer.event(this.getDeviceID(), this.TRACE_READ, data);
         }
+        return data;
     }
 
-
-    private async runPunch(io: IOContext) {
+    private async runPunch(io: IOContext, meter: CharMeter) {
         while (this.keepAlive) {
             let regD = io.readRegister(DeviceRegister.REG_D);
             const newData = (regD & 1) != 0;
 
-            if (!newData) {
-                await sleepMs(1);
+            if (!newData || !meter.tryTake()) {
+                await meter.idle();
                 continue;
             }
 
             io.writeRegister(DeviceRegister.REG_D, regD & ~1); // remove request
             const punchData = io.readRegister(DeviceRegister.REG_C) & 0xFF;
 
-            await sleepMs(1000 / this.baudRateToCPS(this.conf.baudRate));
-
             regD = io.readRegister(DeviceRegister.REG_D);
             io.writeRegister(DeviceRegister.REG_D, regD | 2); // ack data
 
-            console.log(`PC04: Punch ${punchData.toString(16)}`);
-            io.emitEvent({type: 'punch', char: punchData});
+            tracer.event(this.getDeviceID(), this.TRACE_PUNCH, punchData);
+            this.punch.punch(punchData);
         }
     }
 }
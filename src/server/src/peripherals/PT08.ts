@@ -16,19 +16,27 @@
  *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
-import { Peripheral, DeviceRegister, IOContext } from '../drivers/IO/Peripheral';
-import { sleepMs } from '../sleep';
+import { Peripheral, DeviceRegister, IOContext, PeripheralSnapshot } from '../drivers/IO/Peripheral';
+import { CharMeter, TapePunch, TapeReader } from '../drivers/IO/PaperTape';
 import { PeripheralOutAction } from '../types/PeripheralAction';
 import { PT08Configuration, DeviceID } from '../types/PeripheralTypes';
+import { tracer } from '../Trace';
 
 export class PT08 extends Peripheral {
+    private readonly TRACE_READ = tracer.op('tape-read');
+    private readonly TRACE_PUNCH = tracer.op('punch');
     private readerActive: boolean = false;
-    private readerTape: number[] = [];
-    private readerTapePos: number = 0;
+    private readonly reader: TapeReader;
+    private readonly punch: TapePunch;
+    private readerMeter?: CharMeter;
+    private punchMeter?: CharMeter;
     private keyBuffer: number[] = [];
 
-    constructor(private readonly conf: PT08Configuration) {
+    constructor(private readonly conf: PT08Configuration, dir: string) {
         super(conf.id);
+        this.reader = new TapeReader(pos => this.io.emitEvent({type: 'readerPos', pos: pos}));
+        const name = DeviceID[conf.id].replace('DEV_ID_', '').toLowerCase();
+        this.punch = new TapePunch(`${dir}/${name}-punch.bin`, chars => this.io.emitEvent({type: 'punch', chars: chars}));
     }
 
     public getBusConnections(): number[] {
@@ -43,6 +51,20 @@ export class PT08 extends Peripheral {
         throw Error(`Invalid PT08 id: ${this.id}`)
     }
 
+    protected getStateRegisters(): DeviceRegister[] {
+        return [DeviceRegister.REG_A, DeviceRegister.REG_B, DeviceRegister.REG_C, DeviceRegister.REG_D];
+    }
+
+    public saveSnapshot(): PeripheralSnapshot {
+        return { ...super.saveSnapshot(), driver: { keyBuffer: [...this.keyBuffer] } };
+    }
+
+    public restoreSnapshot(snapshot: PeripheralSnapshot): void {
+        super.restoreSnapshot(snapshot);
+        const driver = snapshot.driver as { keyBuffer?: number[] } | undefined;
+        this.keyBuffer = [...driver?.keyBuffer ?? []];
+    }
+
     public getConfiguration(): PT08Configuration {
         return this.conf;
     }
@@ -55,6 +77,10 @@ export class PT08 extends Peripheral {
         io.writeRegister(DeviceRegister.REG_B, (regB & 0o0777) | (baudSel << 9));
 
         Object.assign(this.conf, newConf);
+
+        const cps = this.baudRateToCPS(this.conf.baudRate);
+        this.readerMeter?.setRate(cps);
+        this.punchMeter?.setRate(cps);
     }
 
     public requestAction(action: PeripheralOutAction): void {
@@ -63,8 +89,7 @@ export class PT08 extends Peripheral {
                 this.onKey(action.key);
                 break;
             case 'reader-tape-set':
-                this.readerTape = Array.from(action.tapeData as Buffer);
-                this.readerTapePos = 0;
+                this.reader.load(action.tapeData);
                 break;
             case 'reader-set-active':
                 this.readerActive = action.active;
@@ -81,31 +106,35 @@ export class PT08 extends Peripheral {
     public async run(): Promise<void> {
         const io = this.io;
 
+        this.readerMeter = new CharMeter(io.readCycleCounter);
+        this.punchMeter = new CharMeter(io.readCycleCounter);
         this.reconfigure(this.conf);
+        await this.punch.reset();
 
-        this.runReader(io);
-        this.runPunch(io);
+        this.runReader(io, this.readerMeter);
+        this.runPunch(io, this.punchMeter);
     }
 
-    private async runReader(io: IOContext) {
+    private async runReader(io: IOContext, meter: CharMeter) {
         while (this.keepAlive) {
             let data: number | null = null;
             if (this.readerActive) {
                 const readerRun = (io.readRegister(DeviceRegister.REG_B) & 1) == 0;
-                if (readerRun) {
+                if (readerRun && meter.tryTake()) {
                     data = this.readNextFromTape();
                 }
-            } else {
+            } else if (this.keyBuffer.length > 0 && meter.tryTake()) {
                 data = this.readNextKey();
             }
 
-            await sleepMs(1000 / this.baudRateToCPS(this.conf.baudRate));
-
-            if (data !== null) {
-                const regB = io.readRegister(DeviceRegister.REG_B);
-                io.writeRegister(DeviceRegister.REG_A, data);
-                io.writeRegister(DeviceRegister.REG_B, regB & 0o7000 | 1);
+            if (data === null) {
+                await meter.idle();
+                continue;
             }
+
+            const regB = io.readRegister(DeviceRegister.REG_B);
+            io.writeRegister(DeviceRegister.REG_A, data);
+            io.writeRegister(DeviceRegister.REG_B, regB & 0o7000 | 1);
         }
     }
 
@@ -119,34 +148,30 @@ export class PT08 extends Peripheral {
     }
 
     private readNextFromTape(): number | null {
-        if (this.readerTapePos < this.readerTape.length) {
-            const data = this.readerTape[this.readerTapePos++];
-            console.log(`PT08: Read ${data.toString(16)}, ${this.readerTapePos} / ${this.readerTape.length}`);
-            this.io.emitEvent({type: 'readerPos', pos: this.readerTapePos});
-            return data;
-        } else {
-            return null;
+        const data = this.reader.next();
+        if (data !== null) {
+            tracer.event(this.getDeviceID(), this.TRACE_READ, data);
         }
+        return data;
     }
 
-    private async runPunch(io: IOContext) {
+    private async runPunch(io: IOContext, meter: CharMeter) {
         while (this.keepAlive) {
             let regD = io.readRegister(DeviceRegister.REG_D);
             const newData = (regD & 1) != 0;
 
-            if (!newData) {
-                await sleepMs(1);
+            if (!newData || !meter.tryTake()) {
+                await meter.idle();
                 continue;
             }
 
             io.writeRegister(DeviceRegister.REG_D, regD & ~1); // remove request
-            const punchData = io.readRegister(DeviceRegister.REG_C);
-
-            await sleepMs(1000 / this.baudRateToCPS(this.conf.baudRate));
+            const punchData = io.readRegister(DeviceRegister.REG_C) & 0xFF;
 
             regD = io.readRegister(DeviceRegister.REG_D);
             io.writeRegister(DeviceRegister.REG_D, regD | 2); // ack data
-            io.emitEvent({type: 'punch', char: punchData});
+            tracer.event(this.getDeviceID(), this.TRACE_PUNCH, punchData);
+            this.punch.punch(punchData);
         }
     }
 }
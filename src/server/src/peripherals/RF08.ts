@@ -16,27 +16,30 @@
  *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
-import { Peripheral, IOContext, DeviceRegister } from '../drivers/IO/Peripheral';
-import { existsSync, readFileSync, promises } from 'fs';
-import { sleepMs } from '../sleep';
+import { Peripheral, IOContext, DeviceRegister, PeripheralSnapshot } from '../drivers/IO/Peripheral';
 import { RF08Configuration } from '../types/PeripheralTypes';
 import { Disk } from '../drivers/IO/Disk';
+import { DiskImage } from '../drivers/IO/DiskImage';
+import { ImageStore } from '../drivers/IO/ImageStore';
+import { DiskRotation } from '../drivers/IO/DiskRotation';
+import { tracer } from '../Trace';
 
 export class RF08 extends Peripheral implements Disk {
-    private readonly DEBUG = true;
+    private readonly TRACE_READ = tracer.op('read');
+    private readonly TRACE_WRITE = tracer.op('write');
     private readonly BRK_ADDR = 0o7750;
-    private readonly DATA_FILE: string;
-    private data = Buffer.alloc(4 * 128 * 2048 * 2); // 4 disks, each with 128 tracks of 2048 words stored in 2 bytes
+    private readonly UNIT_SIZE = 128 * 2048 * 2;
+    private image: DiskImage;
+    private activeRequest = 0;
 
-    constructor(private readonly conf: RF08Configuration, dir: string) {
-        super(conf.id);
+    // 2048 words per track, 16 us per word
+    private rotation = new DiskRotation(2048, 16);
 
-        this.DATA_FILE = dir + '/rf08.dat';
+    constructor(private readonly conf: RF08Configuration, dir: string, images: ImageStore) {
+        super(conf.id);
 
-        if (existsSync(this.DATA_FILE)) {
-            const buf = readFileSync(this.DATA_FILE);
-            buf.copy(this.data);
-        }
+        // 4 disks, each with 128 tracks of 2048 words stored in 2 bytes
+        this.image = new DiskImage(dir + '/rf08.dat', 4 * this.UNIT_SIZE, images);
     }
 
     public getConfiguration(): RF08Configuration {
@@ -51,24 +54,49 @@ export class RF08 extends Peripheral implements Disk {
         return [0o60, 0o61, 0o62, 0o64];
     }
 
+    protected getStateRegisters(): DeviceRegister[] {
+        return [DeviceRegister.REG_A, DeviceRegister.REG_B, DeviceRegister.REG_C, DeviceRegister.REG_D];
+    }
+
+    // A transfer that was running is requested again. The disk address and the word count
+    // advance with each word, so it continues where it was.
+    public saveSnapshot(): PeripheralSnapshot {
+        const snapshot = super.saveSnapshot();
+        snapshot.regs = snapshot.regs.map(([reg, value]): [DeviceRegister, number] =>
+            [reg, reg == DeviceRegister.REG_A ? value | this.activeRequest : value]);
+        return snapshot;
+    }
+
     public async saveState() {
-        await promises.writeFile(this.DATA_FILE, this.data);
+        await this.image.save();
+    }
+
+    public async readImage(unit: number): Promise<Uint8Array> {
+        return await this.image.readUnit(unit, this.UNIT_SIZE);
+    }
+
+    public async writeImage(unit: number, data: Uint8Array): Promise<void> {
+        await this.image.writeUnit(unit, this.UNIT_SIZE, data);
     }
 
-    public readBlock(block: number): Uint16Array {
+    public async readBlock(block: number): Promise<Uint16Array> {
         const blockSize = 256;
         const start = block * blockSize * 2;
-        return new Uint16Array(this.data.buffer, start, blockSize);
+        const data = await this.image.get();
+        return new Uint16Array(data.buffer, data.byteOffset + start, blockSize);
     }
 
-    public writeBlock(block: number, data: Uint16Array): void {
-        const view = this.readBlock(block);
+    public async writeBlock(block: number, data: Uint16Array): Promise<void> {
+        const view = await this.readBlock(block);
         view.set(data);
     }
 
     public async run(): Promise<void> {
         const io = this.io;
 
+        // the IOTs that start a transfer set a request bit in register A
+        const events = io.watchRegisters([DeviceRegister.REG_A]);
+
         while (this.keepAlive) {
             const regA = io.readRegister(DeviceRegister.REG_A);
 
@@ -76,84 +104,68 @@ export class RF08 extends Peripheral implements Disk {
                 if (regA & (1 << 15)) {
                     // read
                     io.writeRegister(DeviceRegister.REG_A, regA & ~(1 << 15)); // remove request
-                    await this.doRead(io);
+                    this.activeRequest = 1 << 15;
+                    await this.doTransfer(io, false);
+                    this.activeRequest = 0;
                 } else if (regA & (1 << 14)) {
                     // write
                     io.writeRegister(DeviceRegister.REG_A, regA & ~(1 << 14)); // remove request
-                    await this.doWrite(io);
+                    this.activeRequest = 1 << 14;
+                    await this.doTransfer(io, true);
+                    this.activeRequest = 0;
                 } else {
-                    await sleepMs(1);
+                    await events.next();
                 }
             } catch (e) {
                 console.log(`RF08: Error ${e}`);
+                this.activeRequest = 0;
             }
         }
     }
 
-    private async doRead(io: IOContext) {
-        await sleepMs(20);
-
+    // Waits until the requested word reaches the heads and then streams the words
+    // at the disk's native rate. The image is staged while the disk rotates.
+    private async doTransfer(io: IOContext, toDisk: boolean) {
         let addr = this.readAddress(io);
 
-        if (this.DEBUG) {
-            console.log(`RF08: Read ${addr}`)
-        }
-
-        let overflow = false;
-        do {
-            const data = this.data.readUInt16LE(addr * 2);
-            const memField = this.readMemField(io);
-
-            const brkReply = await io.dataBreak({
-                threeCycle: true,
-                isWrite: true,
-                data: data,
-                address: this.BRK_ADDR,
-                field: memField,
-                incMB: false,
-                incCA: true
-            });
-
-            addr = (addr + 1) & 0o3777777;
-            this.writeAddress(io, addr);
+        const latency = this.rotation.latencyCycles(io.readCycleCounter(), addr);
+        const [words] = await Promise.all([this.image.getWords(), this.waitCycles(latency)]);
 
-            overflow = brkReply.wordCountOverflow;
-        } while (!overflow);
-
-        this.setDoneFlag(io);
-    }
-
-    private async doWrite(io: IOContext) {
-        await sleepMs(20);
-
-        let addr = this.readAddress(io);
-
-        if (this.DEBUG) {
-            console.log(`RF08: Write ${addr}`)
-        }
+        const start = tracer.now();
+        const firstAddr = addr;
+        const memField = this.readMemField(io);
+        const startCycle = io.readCycleCounter();
 
         let overflow = false;
+        let count = 0;
         do {
-            const memField = this.readMemField(io);
-
             const brkReply = await io.dataBreak({
                 threeCycle: true,
-                isWrite: false,
-                data: 0,
+                isWrite: !toDisk,
+                data: toDisk ? 0 : words[addr],
                 address: this.BRK_ADDR,
                 field: memField,
                 incMB: false,
                 incCA: true
             });
 
-            const data = brkReply.mb;
-            this.data.writeUInt16LE(data, addr * 2);
+            if (toDisk) {
+                words[addr] = brkReply.mb;
+            }
 
             addr = (addr + 1) & 0o3777777;
             this.writeAddress(io, addr);
             overflow = brkReply.wordCountOverflow;
+
+            // only wait if the data breaks were faster than the disk
+            count++;
+            const ahead = this.rotation.wordsToCycles(count) - ((io.readCycleCounter() - startCycle) >>> 0);
+            if (ahead > 0 && !overflow) {
+                await this.waitCycles(ahead);
+            }
         } while (!overflow);
 
+        tracer.complete(this.getDeviceID(), toDisk ? this.TRACE_WRITE : this.TRACE_READ, firstAddr, start);
         this.setDoneFlag(io);
     }
 
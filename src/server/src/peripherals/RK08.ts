@@ -17,27 +17,25 @@
  */
 
 import { Peripheral, IOContext, DeviceRegister } from '../drivers/IO/Peripheral';
-import { existsSync, readFileSync, promises } from 'fs';
-import { sleepMs, sleepUs } from '../sleep';
+import { sleepMs } from '../sleep';
+import { Disk } from '../drivers/IO/Disk';
+import { DiskImage } from '../drivers/IO/DiskImage';
+import { ImageStore } from '../drivers/IO/ImageStore';
+import { tracer } from '../Trace';
 import { RK08Configuration } from '../types/PeripheralTypes';
 
-export class RK08 extends Peripheral {
-    private readonly DEBUG = true;
-    private readonly DATA_FILE: string;
+export class RK08 extends Peripheral implements Disk {
+    private readonly TRACE_READ = tracer.op('read');
+    private readonly TRACE_WRITE = tracer.op('write');
     private readonly SECTORS_PER_DISK = 203 * 16;
     private readonly WORDS_PER_SECTOR = 256;
     private readonly NUM_DISKS = 4;
-    private data = Buffer.alloc(this.NUM_DISKS * this.SECTORS_PER_DISK * this.WORDS_PER_SECTOR * 2);
+    private image: DiskImage;
 
-    constructor(private readonly conf: RK08Configuration, dir: string) {
+    constructor(private readonly conf: RK08Configuration, dir: string, images: ImageStore) {
         super(conf.id);
 
-        this.DATA_FILE = dir + '/RK08.dat';
-
-        if (existsSync(this.DATA_FILE)) {
-            const buf = readFileSync(this.DATA_FILE);
-            buf.copy(this.data);
-        }
+        this.image = new DiskImage(dir + '/RK08.dat', this.NUM_DISKS * this.SECTORS_PER_DISK * this.WORDS_PER_SECTOR * 2, images);
     }
 
     public getConfiguration(): RK08Configuration {
@@ -52,8 +50,34 @@ export class RK08 extends Peripheral {
         return [0o73, 0o74, 0o75];
     }
 
+    // The requests in register A are only removed when a transfer starts. A transfer that was running
+    // when the snapshot was taken is lost because the position in the sector isn't kept in the registers.
+    protected getStateRegisters(): DeviceRegister[] {
+        return [DeviceRegister.REG_A, DeviceRegister.REG_B, DeviceRegister.REG_C, DeviceRegister.REG_D, DeviceRegister.REG_E];
+    }
+
     public async saveState() {
-        await promises.writeFile(this.DATA_FILE, this.data);
+        await this.image.save();
+    }
+
+    public async readBlock(block: number): Promise<Uint16Array> {
+        const blockSize = 256;
+        const start = block * blockSize * 2;
+        const data = await this.image.get();
+        return new Uint16Array(data.buffer, data.byteOffset + start, blockSize);
+    }
+
+    public async writeBlock(block: number, data: Uint16Array): Promise<void> {
+        const view = await this.readBlock(block);
+        view.set(data);
+    }
+
+    public async readImage(unit: number): Promise<Uint8Array> {
+        return await this.image.readUnit(unit, this.SECTORS_PER_DISK * this.WORDS_PER_SECTOR * 2);
+    }
+
+    public async writeImage(unit: number, data: Uint8Array): Promise<void> {
+        await this.image.writeUnit(unit, this.SECTORS_PER_DISK * this.WORDS_PER_SECTOR * 2, data);
     }
 
     public async run(): Promise<void> {
@@ -64,7 +88,7 @@ export class RK08 extends Peripheral {
 
             if (regA & (1 << 13)) {
                 // read
-                await sleepMs(134);
+                await this.waitMachineUs(134000);
                 io.writeRegister(DeviceRegister.REG_A, regA & ~(1 << 13)); // remove request
                 if (regA & (1 << 7)) {
                     console.log(`RK08: Surface-only read`);
@@ -78,7 +102,7 @@ export class RK08 extends Peripheral {
                 await this.doRead(io);
             } else if (regA & (1 << 14)) {
                 // write
-                await sleepMs(134);
+                await this.waitMachineUs(134000);
                 io.writeRegister(DeviceRegister.REG_A, regA & ~(1 << 14)); // remove request
                 if (regA & (1 << 7)) {
                     console.log(`RK08: Surface-only write`);
@@ -92,7 +116,7 @@ export class RK08 extends Peripheral {
                 await this.doWrite(io);
             } else if (regA & (1 << 15)) {
                 // parity
-                await sleepMs(134);
+                await this.waitMachineUs(134000);
                 io.writeRegister(DeviceRegister.REG_A, regA & ~(1 << 15)); // remove request
                 console.log(`RK08: Unsupported operation DCHP`);
             } else {
@@ -102,16 +126,16 @@ export class RK08 extends Peripheral {
     }
 
     private async doRead(io: IOContext) {
+        const image = await this.image.get();
         let sector = this.readSectorNum(io);
 
-        if (this.DEBUG) {
-            console.log(`RK08: Read sector ${sector}`)
-        }
+        const start = tracer.now();
+        const firstSector = sector;
 
         let overflow = false;
         let i = 0;
         do {
-            const data = this.data.readUInt16LE((sector * this.WORDS_PER_SECTOR + i) * 2);
+            const data = image.readUInt16LE((sector * this.WORDS_PER_SECTOR + i) * 2);
             const memField = this.readMemField(io);
             const wc = this.readAndIncWC(io);
             const ca = this.readAndIncCA(io);
@@ -138,18 +162,19 @@ export class RK08 extends Peripheral {
                 }
             }
 
-            await sleepUs(65);
+            await this.waitMachineUs(65);
         } while (!overflow);
 
+        tracer.complete(this.getDeviceID(), this.TRACE_READ, firstSector, start);
         this.setDoneFlag(io);
     }
 
     private async doWrite(io: IOContext) {
+        const image = await this.image.get();
         let sector = this.readSectorNum(io);
 
-        if (this.DEBUG) {
-            console.log(`RK08: Write sector ${sector}`)
-        }
+        const start = tracer.now();
+        const firstSector = sector;
 
         let overflow = false;
         let i = 0;
@@ -169,7 +194,7 @@ export class RK08 extends Peripheral {
             });
 
             const data = brkReply.mb;
-            this.data.writeUInt16LE(data, (sector * this.WORDS_PER_SECTOR + i) * 2);
+            image.writeUInt16LE(data, (sector * this.WORDS_PER_SECTOR + i) * 2);
 
             overflow = (wc == 0);
 
@@ -183,9 +208,10 @@ export class RK08 extends Peripheral {
                 }
             }
 
-            await sleepUs(65);
+            await this.waitMachineUs(65);
         } while (!overflow);
 
+        tracer.complete(this.getDeviceID(), this.TRACE_WRITE, firstSector, start);
         this.setDoneFlag(io);
     }
 
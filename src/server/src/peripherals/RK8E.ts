@@ -0,0 +1,284 @@
+/*
+ *   SoCDP8 - A PDP-8/I implementation on a SoC
+ *   Copyright (C) 2019 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+import { Peripheral, IOContext, DeviceRegister, PeripheralSnapshot } from '../drivers/IO/Peripheral';
+import { sleepMs } from '../sleep';
+import { RK8EConfiguration } from '../types/PeripheralTypes';
+import { Disk } from '../drivers/IO/Disk';
+import { DiskImage } from '../drivers/IO/DiskImage';
+import { ImageStore } from '../drivers/IO/ImageStore';
+import { tracer } from '../Trace';
+
+enum RK8EFunction {
+    READ        = 0,
+    READ_ALL    = 1,
+    WRITE_LOCK  = 2,
+    SEEK        = 3,
+    WRITE       = 4,
+    WRITE_ALL   = 5,
+}
+
+// see rk8e.vhd for the register layout
+export class RK8E extends Peripheral implements Disk {
+    private readonly TRACE_READ = tracer.op('read');
+    private readonly TRACE_WRITE = tracer.op('write');
+    private readonly TRACE_SEEK = tracer.op('seek');
+
+    private readonly NUM_DRIVES = 4;
+    private readonly CYLINDERS = 203;
+    private readonly BLOCKS_PER_CYLINDER = 32;
+    private readonly BLOCKS_PER_DRIVE = this.CYLINDERS * this.BLOCKS_PER_CYLINDER;
+    private readonly WORDS_PER_BLOCK = 256;
+
+    // RK05 timing
+    private readonly SEEK_SETTLE_US = 10000;
+    private readonly SEEK_PER_CYL_US = 370;
+    private readonly WORD_US = 11;
+
+    private readonly CTRL_GO = 1;
+    private readonly CTRL_RECAL = 2;
+    private readonly CTRL_BUSY = 4;
+
+    private readonly STATUS_DONE = 0o4000;
+    private readonly STATUS_WRITE_LOCK = 0o0020;
+    private readonly STATUS_CYL_ERROR = 0o0001;
+
+    private image: DiskImage;
+    private curCylinder: number[] = [];
+    private writeLocked: boolean[] = [];
+    private activeRequest = 0;
+
+    constructor(private readonly conf: RK8EConfiguration, dir: string, images: ImageStore) {
+        super(conf.id);
+
+        this.image = new DiskImage(dir + '/rk8e.dat', this.NUM_DRIVES * this.BLOCKS_PER_DRIVE * this.WORDS_PER_BLOCK * 2, images);
+        for (let i = 0; i < this.NUM_DRIVES; i++) {
+            this.curCylinder.push(0);
+            this.writeLocked.push(false);
+        }
+    }
+
+    public getConfiguration(): RK8EConfiguration {
+        return this.conf;
+    }
+
+    public reconfigure(newConf: RK8EConfiguration) {
+        Object.assign(this.conf, newConf);
+    }
+
+    public getBusConnections(): number[] {
+        return [0o74];
+    }
+
+    // register E holds the requests, see saveSnapshot
+    protected getStateRegisters(): DeviceRegister[] {
+        return [DeviceRegister.REG_A, DeviceRegister.REG_B, DeviceRegister.REG_C, DeviceRegister.REG_D];
+    }
+
+    // A function that didn't finish is requested again, it starts over with the same registers
+    // because they are only updated at its end.
+    public saveSnapshot(): PeripheralSnapshot {
+        const snapshot = super.saveSnapshot();
+        const ctrl = this.io.readRegister(DeviceRegister.REG_E) | this.activeRequest;
+        if (ctrl & (this.CTRL_GO | this.CTRL_RECAL)) {
+            snapshot.regs.push([DeviceRegister.REG_E, ctrl | this.CTRL_BUSY]);
+        }
+        snapshot.driver = { curCylinder: [...this.curCylinder], writeLocked: [...this.writeLocked] };
+        return snapshot;
+    }
+
+    public restoreSnapshot(snapshot: PeripheralSnapshot): void {
+        super.restoreSnapshot(snapshot);
+
+        const ctrl = snapshot.regs.find(([reg]) => reg == DeviceRegister.REG_E);
+        if (ctrl) {
+            this.io.writeRegister(DeviceRegister.REG_E, ctrl[1] & (this.CTRL_GO | this.CTRL_RECAL | this.CTRL_BUSY));
+        }
+
+        const driver = snapshot.driver as { curCylinder?: number[], writeLocked?: boolean[] } | undefined;
+        for (let i = 0; i < this.NUM_DRIVES; i++) {
+            this.curCylinder[i] = driver?.curCylinder?.[i] ?? 0;
+            this.writeLocked[i] = driver?.writeLocked?.[i] ?? false;
+        }
+    }
+
+    public async saveState() {
+        await this.image.save();
+    }
+
+    public async readImage(unit: number): Promise<Uint8Array> {
+        return await this.image.readUnit(unit, this.BLOCKS_PER_DRIVE * this.WORDS_PER_BLOCK * 2);
+    }
+
+    public async writeImage(unit: number, data: Uint8Array): Promise<void> {
+        await this.image.writeUnit(unit, this.BLOCKS_PER_DRIVE * this.WORDS_PER_BLOCK * 2, data);
+    }
+
+    public async readBlock(block: number): Promise<Uint16Array> {
+        const data = await this.image.get();
+        const start = block * this.WORDS_PER_BLOCK * 2;
+        return new Uint16Array(data.buffer, data.byteOffset + start, this.WORDS_PER_BLOCK);
+    }
+
+    public async writeBlock(block: number, data: Uint16Array): Promise<void> {
+        const view = await this.readBlock(block);
+        view.set(data);
+    }
+
+    public async run(): Promise<void> {
+        const io = this.io;
+
+        while (this.keepAlive) {
+            const ctrl = io.readRegister(DeviceRegister.REG_E);
+
+            try {
+                if (ctrl & this.CTRL_GO) {
+                    io.writeRegister(DeviceRegister.REG_E, ctrl & ~this.CTRL_GO); // remove request
+                    this.activeRequest = this.CTRL_GO;
+                    await this.doFunction(io);
+                } else if (ctrl & this.CTRL_RECAL) {
+                    io.writeRegister(DeviceRegister.REG_E, ctrl & ~this.CTRL_RECAL); // remove request
+                    this.activeRequest = this.CTRL_RECAL;
+                    await this.doRecalibrate(io);
+                } else {
+                    await sleepMs(1);
+                }
+            } catch (e) {
+                console.log(`RK8E: Error ${e}`);
+                this.finish(io, 0);
+            }
+        }
+    }
+
+    private async doFunction(io: IOContext) {
+        const cmd = io.readRegister(DeviceRegister.REG_A);
+        const diskAddr = io.readRegister(DeviceRegister.REG_B);
+
+        const func: RK8EFunction = (cmd >> 9) & 7;
+        const drive = (cmd >> 1) & 3;
+        const block = ((cmd & 1) << 12) | diskAddr;
+        const cylinder = block >> 5;
+
+        if (cylinder >= this.CYLINDERS) {
+            this.finish(io, this.STATUS_DONE | this.STATUS_CYL_ERROR);
+            return;
+        }
+
+        switch (func) {
+            case RK8EFunction.READ:
+            case RK8EFunction.READ_ALL:
+                await this.seek(drive, cylinder);
+                await this.doTransfer(io, cmd, drive * this.BLOCKS_PER_DRIVE + block, false);
+                break;
+            case RK8EFunction.WRITE:
+            case RK8EFunction.WRITE_ALL:
+                if (this.writeLocked[drive]) {
+                    this.finish(io, this.STATUS_DONE | this.STATUS_WRITE_LOCK);
+                    return;
+                }
+                await this.seek(drive, cylinder);
+                await this.doTransfer(io, cmd, drive * this.BLOCKS_PER_DRIVE + block, true);
+                break;
+            case RK8EFunction.WRITE_LOCK:
+                this.writeLocked[drive] = true;
+                this.finish(io, this.STATUS_DONE);
+                break;
+            case RK8EFunction.SEEK:
+                // the controller is free while the drive is seeking, done is optional
+                this.finish(io, 0);
+                await this.seek(drive, cylinder);
+                if (cmd & 0o200) {
+                    this.setStatus(io, this.STATUS_DONE);
+                }
+                break;
+            default:
+                console.log(`RK8E: Function ${func} not supported`);
+                this.finish(io, this.STATUS_DONE);
+        }
+    }
+
+    private async doRecalibrate(io: IOContext) {
+        const cmd = io.readRegister(DeviceRegister.REG_A);
+        const drive = (cmd >> 1) & 3;
+
+        this.finish(io, 0);
+        await this.seek(drive, 0);
+        if (cmd & 0o200) {
+            this.setStatus(io, this.STATUS_DONE);
+        }
+    }
+
+    private async seek(drive: number, cylinder: number) {
+        const distance = Math.abs(cylinder - this.curCylinder[drive]);
+        if (distance == 0) {
+            return;
+        }
+
+        const start = tracer.now();
+        this.curCylinder[drive] = cylinder;
+        await this.waitMachineUs(this.SEEK_SETTLE_US + distance * this.SEEK_PER_CYL_US);
+        tracer.complete(this.getDeviceID(), this.TRACE_SEEK, cylinder, start);
+    }
+
+    // The block is passed to the I/O controller as one data break burst and the remaining
+    // transfer time is waited at the end so that a block costs one wait instead of one per word.
+    private async doTransfer(io: IOContext, cmd: number, block: number, toDisk: boolean) {
+        const start = tracer.now();
+        const data = await this.readBlock(block);
+        const wordCount = (cmd & 0o100) ? this.WORDS_PER_BLOCK / 2 : this.WORDS_PER_BLOCK;
+        const field = (cmd >> 3) & 7;
+        const curAddr = io.readRegister(DeviceRegister.REG_D);
+
+        // reads from memory go directly into the image
+        await io.dataBreakBurst({
+            threeCycle: false,
+            isWrite: !toDisk,
+            data: 0,
+            address: curAddr,
+            field: field,
+            incMB: false,
+            incCA: false,
+        }, data.subarray(0, wordCount));
+
+        if (toDisk && wordCount < this.WORDS_PER_BLOCK) {
+            // half blocks are padded with zeros
+            data.fill(0, wordCount);
+        }
+
+        // the current address only advances at the end so that a snapshot can repeat the function
+        await this.waitMachineUs(this.WORDS_PER_BLOCK * this.WORD_US);
+        io.writeRegister(DeviceRegister.REG_D, (curAddr + wordCount) & 0o7777);
+
+        tracer.complete(this.getDeviceID(), toDisk ? this.TRACE_WRITE : this.TRACE_READ, block, start);
+        this.finish(io, this.STATUS_DONE);
+    }
+
+    private finish(io: IOContext, status: number) {
+        // clear busy before setting the flags so that the CPU can start the next function immediately
+        io.writeRegister(DeviceRegister.REG_E, 0);
+        this.activeRequest = 0;
+        if (status) {
+            this.setStatus(io, status);
+        }
+    }
+
+    private setStatus(io: IOContext, status: number) {
+        const regC = io.readRegister(DeviceRegister.REG_C);
+        io.writeRegister(DeviceRegister.REG_C, regC | status);
+    }
+}
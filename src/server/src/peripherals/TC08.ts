@@ -16,11 +16,13 @@
  *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
-import { Peripheral, DeviceRegister, IOContext } from '../drivers/IO/Peripheral';
-import { sleepMs, sleepUs } from '../sleep';
+import { Peripheral, DeviceRegister, IOContext, PeripheralSnapshot } from '../drivers/IO/Peripheral';
+import { sleepMs } from '../sleep';
 import { TC08Configuration } from '../types/PeripheralTypes';
 import { isDeepStrictEqual } from 'util';
 import { PeripheralOutAction, TapeState as TapeStateEx } from '../types/PeripheralAction';
+import { tracer } from '../Trace';
+import { ImageDevice } from '../drivers/IO/Disk';
 
 enum TapeDirection {
     FORWARD = 0,
@@ -53,8 +55,14 @@ interface TapeState {
     curLine: number;
 }
 
-export class TC08 extends Peripheral {
-    private readonly DEBUG = false;
+export class TC08 extends Peripheral implements ImageDevice {
+    // block events carry (unit << 12) | block as argument
+    private readonly TRACE_DTXA = tracer.op('dtxa');
+    private readonly TRACE_FUNC = tracer.op('function');
+    private readonly TRACE_MOVE = tracer.op('move');
+    private readonly TRACE_SEARCH = tracer.op('search');
+    private readonly TRACE_READ = tracer.op('read');
+    private readonly TRACE_WRITE = tracer.op('write');
 
     private ZONE_WORDS = 8192;          // number of words in start / end zone
     private ZONE_WSIZE = 6;             // number of lines per zone word
@@ -91,6 +99,9 @@ export class TC08 extends Peripheral {
     private tapes: TapeState[] = [];
     private lastRegA: number = 0;
 
+    // positions from a snapshot, applied when the tape is loaded again
+    private restoredLines = new Map<number, number>();
+
     constructor(private readonly conf: TC08Configuration) {
         super(conf.id);
     }
@@ -107,6 +118,23 @@ export class TC08 extends Peripheral {
         return [0o76, 0o77];
     }
 
+    // register C only notifies the driver, a function that was running is found with register A in run()
+    protected getStateRegisters(): DeviceRegister[] {
+        return [DeviceRegister.REG_A, DeviceRegister.REG_B];
+    }
+
+    public saveSnapshot(): PeripheralSnapshot {
+        const lines: [number, number][] = [];
+        this.tapes.forEach(tape => lines.push([tape.unit, tape.curLine]));
+        return { ...super.saveSnapshot(), driver: { lines: lines } };
+    }
+
+    public restoreSnapshot(snapshot: PeripheralSnapshot): void {
+        super.restoreSnapshot(snapshot);
+        const driver = snapshot.driver as { lines?: [number, number][] } | undefined;
+        this.restoredLines = new Map(driver?.lines ?? []);
+    }
+
     public requestAction(action: PeripheralOutAction): void {
         switch (action.type) {
             case 'upload-disk':
@@ -115,6 +143,18 @@ export class TC08 extends Peripheral {
         }
     }
 
+    public async readImage(unit: number): Promise<Uint8Array> {
+        const tape = this.tapes[unit];
+        if (!tape) {
+            throw Error(`No tape in unit ${unit}`);
+        }
+        return Buffer.from(tape.data);
+    }
+
+    public async writeImage(unit: number, data: Uint8Array): Promise<void> {
+        this.loadTape(unit, Buffer.from(data));
+    }
+
     private async runStatusReport() {
         let lastStatus: Object[] = [];
 
@@ -167,8 +207,9 @@ export class TC08 extends Peripheral {
         this.tapes[unit] = {
             unit: unit,
             data: data,
-            curLine: 1000,
+            curLine: this.restoredLines.get(unit) ?? 1000,
         }
+        this.restoredLines.delete(unit);
     }
 
     public async run(): Promise<void> {
@@ -176,29 +217,41 @@ export class TC08 extends Peripheral {
 
         this.runStatusReport();
 
-        while (this.keepAlive) {
-            const regA = io.readRegister(DeviceRegister.REG_A);
+        // DTXA and DTCA change register A, so each event starts or stops a function
+        const events = io.watchRegisters([DeviceRegister.REG_A]);
 
-            if (regA == this.lastRegA) {
-                await sleepMs(1);
+        // a restored snapshot can contain a running function
+        const initial = io.readRegister(DeviceRegister.REG_A);
+        if (initial != this.lastRegA) {
+            await this.onRegAChange(io, initial);
+        }
+
+        for await (const event of events) {
+            if (!this.keepAlive) {
+                break;
+            }
+
+            // functions that were replaced before we saw them are skipped
+            if (events.pending > 0) {
                 continue;
             }
 
-            this.lastRegA = regA;
-            const state = this.decodeRegA(regA);
+            await this.onRegAChange(io, event.value);
+        }
+    }
 
-            if (this.DEBUG) {
-                console.log(`TC08: DTXA ${regA.toString(8)}`);
-            }
+    private async onRegAChange(io: IOContext, regA: number) {
+        this.lastRegA = regA;
+        const state = this.decodeRegA(regA);
 
-            if (state.run) {
-                try {
-                    await this.performFunction(io, state);
-                } catch (e) {
-                    console.log(`TC08: Error ${e}`);
-                    this.setTimingError(io);
-                    continue;
-                }
+        tracer.event(this.getDeviceID(), this.TRACE_DTXA, regA);
+
+        if (state.run) {
+            try {
+                await this.performFunction(io, state);
+            } catch (e) {
+                console.log(`TC08: Error ${e}`);
+                this.setTimingError(io);
             }
         }
     }
@@ -216,9 +269,7 @@ export class TC08 extends Peripheral {
             return;
         }
 
-        if (this.DEBUG) {
-            console.log(`TC08: Func ${TapeFunction[state.func]}, dir ${TapeDirection[state.direction]}, run ${state.run}, cont ${state.contMode}`);
-        }
+        tracer.event(this.getDeviceID(), this.TRACE_FUNC, state.func);
 
         switch (state.func) {
             case TapeFunction.MOVE:
@@ -264,7 +315,7 @@ export class TC08 extends Peripheral {
             }
         } while (!stop);
 
-        console.log(`TC08: Move done, now ${tape.curLine}`);
+        tracer.event(this.getDeviceID(), this.TRACE_MOVE, tape.curLine);
         this.setEndOfTapeError(io, false);
     }
 
@@ -316,7 +367,7 @@ export class TC08 extends Peripheral {
                 }
             }
 
-            console.log(`TC08: Search -> ${tape.unit}.${curBlock}`);
+            tracer.event(this.getDeviceID(), this.TRACE_SEARCH, (tape.unit << 12) | curBlock);
 
             const memField = this.readMemField(io);
             const reply = await io.dataBreak({
@@ -371,7 +422,7 @@ export class TC08 extends Peripheral {
                 continue;
             }
 
-            console.log(`TC08: Read ${tape.unit}.${curBlock}`);
+            const start = tracer.now();
             let overflow = false;
             for (let i = 0; i < this.DATA_WORDS; i++) {
                 const memField = this.readMemField(io);
@@ -399,6 +450,8 @@ export class TC08 extends Peripheral {
                 }
             }
 
+            tracer.complete(this.getDeviceID(), this.TRACE_READ, (tape.unit << 12) | curBlock, start);
+
             if (!contMode || overflow) {
                 this.setDECTapeFlag(io);
             }
@@ -438,7 +491,7 @@ export class TC08 extends Peripheral {
                 continue;
             }
 
-            console.log(`TC08: Write ${tape.unit}.${curBlock}`);
+            const start = tracer.now();
             let overflow = false;
             for (let i = 0; i < this.DATA_WORDS; i++) {
                 const memField = this.readMemField(io);
@@ -467,6 +520,8 @@ export class TC08 extends Peripheral {
                 }
             }
 
+            tracer.complete(this.getDeviceID(), this.TRACE_WRITE, (tape.unit << 12) | curBlock, start);
+
             if (!contMode || overflow) {
                 this.setDECTapeFlag(io);
             }
@@ -480,7 +535,7 @@ export class TC08 extends Peripheral {
             tape.curLine -= lines;
         }
 
-        await sleepUs(lines * this.US_PER_LINE);
+        await this.waitMachineUs(lines * this.US_PER_LINE);
     }
 
     private calcBlockAddr(line: number): [number, number] {
@@ -26,8 +26,9 @@ export async function sleepMs(ms: number): Promise<void> {
 // Node has no way to sleep less than a millisecond - however, we sometimes need a way to sleep
 // a short duration less than a millisecond. The actual delay is not important, but it has to be
 // less than a milli so this is some hackery that achieves this.
+// Fractional durations are rounded up to whole nanoseconds since BigInt only takes integers.
 export async function sleepUs(us: number): Promise<void> {
-    const endAt = process.hrtime.bigint() + BigInt(us) * 1000n;
+    const endAt = process.hrtime.bigint() + BigInt(Math.ceil(us * 1000));
 
     // sleep away all milliseconds, if any
     if (us > 1000) {
@@ -0,0 +1,156 @@
+/*
+ *   SoCDP8 - A PDP-8/I implementation on a SoC
+ *   Copyright (C) 2019 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+import { LampBrightness } from './ConsoleTypes';
+
+// Front panel macros: scripts of switch settings and key presses that are executed
+// like an operator would do it, keep in sync with the client.
+
+export type PanelKey = 'start' | 'load' | 'dep' | 'exam' | 'cont' | 'stop';
+
+export type PanelStep =
+    { op: 'swr', value: number } |
+    { op: 'df', value: number } |
+    { op: 'if', value: number } |
+    { op: 'key', key: PanelKey };
+
+export interface PanelMacroResult {
+    // number of keys that were pressed
+    keyCount: number;
+
+    lamps: LampBrightness;
+}
+
+export const PANEL_MACRO_MAX_STEPS = 16384;
+
+const PANEL_KEYS: PanelKey[] = ['start', 'load', 'dep', 'exam', 'cont', 'stop'];
+
+// Steps to toggle words into consecutive addresses, starting with LOAD ADD
+export function depositSteps(field: number, address: number, words: number[]): PanelStep[] {
+    const steps: PanelStep[] = [
+        { op: 'if', value: field },
+        { op: 'df', value: field },
+        { op: 'swr', value: address },
+        { op: 'key', key: 'load' },
+    ];
+
+    for (const word of words) {
+        steps.push({ op: 'swr', value: word });
+        steps.push({ op: 'key', key: 'dep' });
+    }
+    return steps;
+}
+
+// Parses a textual macro, numbers are octal:
+//   sr 7756     set the switch register
+//   df 1, if 1  set the field switches
+//   load, dep, exam, start, cont, stop
+//   dep 6014 6011 5357 ...   set SR and deposit for each word
+// Commands are separated by whitespace, newlines or semicolons, comments start with / as in PAL.
+export function parsePanelScript(script: string): PanelStep[] {
+    const steps: PanelStep[] = [];
+    const tokens = script
+        .split('\n')
+        .map(line => line.replace(/\/.*$/, ''))
+        .join(' ')
+        .split(/[\s;,]+/)
+        .filter(tok => tok.length > 0)
+        .map(tok => tok.toLowerCase());
+
+    const isNumber = (tok: string | undefined) => tok !== undefined && /^[0-7]+$/.test(tok);
+    const number = (tok: string | undefined, max: number) => {
+        if (!isNumber(tok)) {
+            throw Error(`Expected an octal number instead of ${tok ?? 'end of script'}`);
+        }
+        const val = parseInt(tok as string, 8);
+        if (val > max) {
+            throw Error(`${String(tok)} is out of range`);
+        }
+        return val;
+    };
+
+    for (let i = 0; i < tokens.length; i++) {
+        const tok = tokens[i];
+        switch (tok) {
+            case 'sr':
+            case 'swr':
+                steps.push({ op: 'swr', value: number(tokens[++i], 0o7777) });
+                break;
+            case 'df':
+            case 'if':
+                steps.push({ op: tok, value: number(tokens[++i], 0o7) });
+                break;
+            case 'dep':
+                if (!isNumber(tokens[i + 1])) {
+                    steps.push({ op: 'key', key: 'dep' });
+                }
+                while (isNumber(tokens[i + 1])) {
+                    steps.push({ op: 'swr', value: number(tokens[++i], 0o7777) });
+                    steps.push({ op: 'key', key: 'dep' });
+                }
+                break;
+            case 'la':
+                steps.push({ op: 'key', key: 'load' });
+                break;
+            default:
+                if (!PANEL_KEYS.includes(tok as PanelKey)) {
+                    throw Error(`Unknown panel command ${tok}`);
+                }
+                steps.push({ op: 'key', key: tok as PanelKey });
+        }
+    }
+
+    checkPanelSteps(steps);
+    return steps;
+}
+
+// Converts a row of lamp brightnesses, most significant lamp first, into a word
+export function lampWord(row: number[]): number {
+    return row.reduce((word, brightness) => (word << 1) | (brightness > 7 ? 1 : 0), 0);
+}
+
+export function checkPanelSteps(steps: PanelStep[]) {
+    if (steps.length > PANEL_MACRO_MAX_STEPS) {
+        throw Error(`Panel macros are limited to ${PANEL_MACRO_MAX_STEPS.toString()} steps`);
+    }
+
+    for (const step of steps) {
+        switch (step.op) {
+            case 'swr':
+                checkRange(step.value, 0o7777);
+                break;
+            case 'df':
+            case 'if':
+                checkRange(step.value, 0o7);
+                break;
+            case 'key':
+                if (!PANEL_KEYS.includes(step.key)) {
+                    throw Error(`Unknown panel key ${String(step.key)}`);
+                }
+                break;
+            default:
+                throw Error(`Unknown panel step ${JSON.stringify(step)}`);
+        }
+    }
+}
+
+function checkRange(value: number, max: number) {
+    if (!Number.isInteger(value) || value < 0 || value > max) {
+        throw Error(`Switch value ${String(value)} out of range`);
+    }
+}